@@ -0,0 +1,200 @@
+/*
+ *  bloomFilter.cpp
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  Contains an implementation of the bloomFilter class.   
+ *
+*/
+
+#include "bloomFilter.h"
+#include "stringProcessing.h"
+#include <algorithm>
+
+const size_t bloomFilter::BITS_PER_WORD;
+
+//odd constants that spread the hash over the bits of each lane 
+static const uint32_t SALTS[8] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 
+                                  0xa2b7289dU, 0x705495c7U, 0x2df1424bU, 
+                                  0x9efc4947U, 0x5c6bfb31U};
+
+/*
+ * name:      bloomFilter constructor 
+ * purpose:   creates a filter that is not built yet 
+ * arguments: none
+ * returns:   none 
+ * effects:   starts with no blocks 
+*/
+bloomFilter::bloomFilter() {
+    view = nullptr;
+    numBlocks = 0;
+}
+
+/*
+ * name:      reset 
+ * purpose:   makes an empty filter with room for a number of words 
+ * arguments: a size_t with the number of words (keys and case sensitive 
+ *            words together) that will be added 
+ * returns:   none 
+ * effects:   allocates BITS_PER_WORD bits for each word, in whole blocks, 
+ *            and clears them 
+*/
+void bloomFilter::reset(size_t numWords) {
+    size_t bits = max(numWords, (size_t) 1) * BITS_PER_WORD;
+    numBlocks = (bits + 8 * sizeof(Block) - 1) / (8 * sizeof(Block));
+
+    blocks.assign(numBlocks, Block());
+    view = blocks.data();
+}
+
+/*
+ * name:      add 
+ * purpose:   adds a word to the filter 
+ * arguments: a pointer to the characters of the word, its length, and 
+ *            whether it is a lowercase key (true) or a case sensitive word 
+ * returns:   none 
+ * effects:   sets the word's eight bits in its block. reset must be called 
+ *            first. 
+*/
+void bloomFilter::add(const char *word, size_t length, bool insensitive) {
+    uint64_t hash = hashWord(word, length, insensitive);
+    uint32_t mask[8];
+    maskOf(hash, mask);
+
+    Block &block = blocks[blockOf(hash)];
+    for (int i = 0; i < 8; i++) {
+        block.lanes[i] |= mask[i];
+    }
+}
+
+/*
+ * name:      mayContain 
+ * purpose:   checks whether a word might be in the index 
+ * arguments: a string with a word and whether to look for it regardless of
+ *            case (as a lowercase key) or exactly 
+ * returns:   returns false if the word is certainly not in the index, true 
+ *            if it might be (or the filter was never built) 
+ * effects:   the word is lowercased while it is hashed, without copying it
+*/
+bool bloomFilter::mayContain(const string &word, bool insensitive) const {
+    if (numBlocks == 0) {
+        return true;
+    }
+
+    uint64_t hash = hashWord(word.data(), word.length(), insensitive);
+    uint32_t mask[8];
+    maskOf(hash, mask);
+
+    //every one of the word's bits has to be set 
+    const Block &block = view[blockOf(hash)];
+    for (int i = 0; i < 8; i++) {
+        if ((block.lanes[i] & mask[i]) != mask[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * name:      isBuilt 
+ * purpose:   checks whether the filter has been built 
+ * arguments: none
+ * returns:   returns true if reset has been called, false otherwise 
+ * effects:   none 
+*/
+bool bloomFilter::isBuilt() const {
+    return numBlocks > 0;
+}
+
+/*
+ * name:      bytes 
+ * purpose:   gets the memory used by the filter's bits 
+ * arguments: none
+ * returns:   a size_t with the number of bytes, mapped or not 
+ * effects:   none 
+*/
+size_t bloomFilter::bytes() const {
+    return numBlocks * sizeof(Block);
+}
+
+/*
+ * name:      writeImage 
+ * purpose:   writes the filter out so it can be mapped later 
+ * arguments: a reference to the ostream to write to 
+ * returns:   none 
+ * effects:   writes the blocks one after another 
+*/
+void bloomFilter::writeImage(ostream &out) const {
+    out.write((const char *) view, numBlocks * sizeof(Block));
+}
+
+/*
+ * name:      attach 
+ * purpose:   reads the filter from an image written by writeImage 
+ * arguments: a pointer to the image (aligned to a block) and its length 
+ * returns:   none 
+ * effects:   points the filter at the image without copying it and frees 
+ *            its own blocks. The image must stay mapped while the filter 
+ *            uses it. 
+*/
+void bloomFilter::attach(const char *image, size_t length) {
+    vector<Block>().swap(blocks);
+    view = (const Block *) image;
+    numBlocks = length / sizeof(Block);
+}
+
+/*
+ * name:      hashWord 
+ * purpose:   hashes a word 
+ * arguments: a pointer to the characters of the word, its length, and 
+ *            whether to hash it lowercased as a key 
+ * returns:   a uint64_t with the hash 
+ * effects:   FNV-1a over the (lowercased) characters, with a different 
+ *            starting value for keys and words, then mixed so every bit of 
+ *            the result depends on every character 
+*/
+uint64_t bloomFilter::hashWord(const char *word, size_t length, 
+                               bool insensitive) {
+    uint64_t hash = insensitive ? 0xcbf29ce484222325ULL : 
+                                  0x84222325cbf29ce4ULL;
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = insensitive ? lowerChar(word[i]) : word[i];
+        hash = (hash ^ c) * 0x100000001b3ULL;
+    }
+
+    //finish with the splitmix64 mixer 
+    hash ^= hash >> 30;
+    hash *= 0xbf58476d1ce4e5b9ULL;
+    hash ^= hash >> 27;
+    hash *= 0x94d049bb133111ebULL;
+    hash ^= hash >> 31;
+    return hash;
+}
+
+/*
+ * name:      blockOf 
+ * purpose:   finds the block of a hash 
+ * arguments: a uint64_t with a word's hash 
+ * returns:   a size_t with the number of the block 
+ * effects:   maps the high 32 bits of the hash onto the blocks with a 
+ *            multiply instead of a division 
+*/
+size_t bloomFilter::blockOf(uint64_t hash) const {
+    return ((hash >> 32) * numBlocks) >> 32;
+}
+
+/*
+ * name:      maskOf 
+ * purpose:   finds the bits of a hash in its block 
+ * arguments: a uint64_t with a word's hash and an array of eight lanes to 
+ *            store the bits in 
+ * returns:   none 
+ * effects:   picks one bit in each lane from the top five bits of the low 
+ *            32 bits of the hash times that lane's salt 
+*/
+void bloomFilter::maskOf(uint64_t hash, uint32_t mask[8]) {
+    uint32_t low = (uint32_t) hash;
+    for (int i = 0; i < 8; i++) {
+        mask[i] = (uint32_t) 1 << ((low * SALTS[i]) >> 27);
+    }
+}
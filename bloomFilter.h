@@ -0,0 +1,76 @@
+/*
+ *  bloomFilter.h
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  bloomFilter is a class that answers whether a word might be in the index 
+ *  without looking at the index itself. It is a split block Bloom filter: 
+ *  the bits are grouped into 32 byte blocks, a word's hash picks one block,
+ *  and eight bits are set in it, one in each 32 bit lane. A lookup therefore
+ *  reads a single cache line, and with BITS_PER_WORD bits for each word it 
+ *  wrongly answers "maybe" for about one word in a hundred that is not 
+ *  there, but never answers "no" for a word that is. Case sensitive words 
+ *  and lowercase keys are hashed with different seeds, so each kind of 
+ *  query only matches its own kind of entry. The filter is built once, after
+ *  the index is, and never changes, so any number of threads can read it. 
+ *  The blocks can also be written to a file and read from a mapping of it. 
+ *
+*/
+
+#ifndef BLOOMFILTER_H
+#define BLOOMFILTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class bloomFilter {
+//public functions available to the client 
+public:
+    bloomFilter();
+
+    //functions for building the filter 
+    void reset(size_t numWords);
+    void add(const char *word, size_t length, bool insensitive);
+
+    //function for checking a word 
+    bool mayContain(const string &word, bool insensitive) const;
+
+    //functions for the size of the filter 
+    bool isBuilt() const;
+    size_t bytes() const;
+
+    //functions for writing the blocks out and reading them from a mapping 
+    void writeImage(ostream &out) const;
+    void attach(const char *image, size_t length);
+
+    //bits used for each word added 
+    static const size_t BITS_PER_WORD = 10;
+
+private:
+    // 
+    //  Block struct, used to store the 256 bits a word can set, aligned so 
+    //  that a block never crosses a cache line 
+    // 
+    struct alignas(32) Block {
+        uint32_t lanes[8];
+    };
+
+    //the filter's own blocks, and the blocks it reads from (its own, or 
+    //a mapped image) 
+    vector<Block> blocks;
+    const Block *view;
+    size_t numBlocks;
+
+    //helper functions for hashing a word and finding its bits 
+    static uint64_t hashWord(const char *word, size_t length, 
+                             bool insensitive);
+    size_t blockOf(uint64_t hash) const;
+    static void maskOf(uint64_t hash, uint32_t mask[8]);
+};
+
+#endif
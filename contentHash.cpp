@@ -0,0 +1,103 @@
+/*
+ *  contentHash.cpp
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  Contains an implementation of the contentHash class.   
+ *
+*/
+
+#include "contentHash.h"
+#include <cstring>
+
+//odd constants for spreading the bits of each word over the hash 
+static const uint64_t PRIME_1 = 0x9e3779b185ebca87ULL;
+static const uint64_t PRIME_2 = 0xc2b2ae3d27d4eb4fULL;
+
+/*
+ * name:      contentHash constructor 
+ * purpose:   starts a new hash 
+ * arguments: none
+ * returns:   none 
+ * effects:   sets the hash to its starting value with nothing hashed 
+*/
+contentHash::contentHash() {
+    state = PRIME_1;
+    total = 0;
+    pending = 0;
+    pendingBytes = 0;
+}
+
+/*
+ * name:      update 
+ * purpose:   hashes the next chunk of the contents 
+ * arguments: a pointer to the chunk and its length 
+ * returns:   none 
+ * effects:   mixes in each complete eight byte word, carrying the bytes of 
+ *            an incomplete word over to the next chunk 
+*/
+void contentHash::update(const char *data, size_t length) {
+    total += length;
+
+    //finish the word left over from the last chunk 
+    while (pendingBytes > 0 and pendingBytes < 8 and length > 0) {
+        pending |= (uint64_t) (unsigned char) *data << (8 * pendingBytes);
+        pendingBytes++;
+        data++;
+        length--;
+    }
+    if (pendingBytes == 8) {
+        state = mix(state, pending);
+        pending = 0;
+        pendingBytes = 0;
+    }
+
+    //mix in whole words 
+    while (length >= 8) {
+        uint64_t word;
+        memcpy(&word, data, 8);
+        state = mix(state, word);
+        data += 8;
+        length -= 8;
+    }
+
+    //keep the rest for the next chunk 
+    for (size_t i = 0; i < length; i++) {
+        pending |= (uint64_t) (unsigned char) data[i] << (8 * pendingBytes);
+        pendingBytes++;
+    }
+}
+
+/*
+ * name:      finish 
+ * purpose:   gets the hash of everything hashed so far 
+ * arguments: none
+ * returns:   a uint64_t with the hash 
+ * effects:   mixes in the incomplete last word and the length, then spreads
+ *            every bit over the result. Does not change the hash, so more 
+ *            chunks can still be added. 
+*/
+uint64_t contentHash::finish() const {
+    uint64_t result = mix(state, pending ^ ((uint64_t) pendingBytes << 59));
+    result = mix(result, total);
+
+    result ^= result >> 33;
+    result *= PRIME_2;
+    result ^= result >> 29;
+    result *= PRIME_1;
+    result ^= result >> 32;
+    return result;
+}
+
+/*
+ * name:      mix 
+ * purpose:   mixes one word into the hash 
+ * arguments: a uint64_t with the hash so far and a uint64_t with the word 
+ * returns:   a uint64_t with the new hash 
+ * effects:   none 
+*/
+uint64_t contentHash::mix(uint64_t hash, uint64_t word) {
+    hash ^= word * PRIME_2;
+    hash = (hash << 31) | (hash >> 33);
+    return hash * PRIME_1;
+}
@@ -0,0 +1,44 @@
+/*
+ *  contentHash.h
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  contentHash is a class that hashes the contents of a file as it is read, 
+ *  a chunk at a time, so files with the same contents can be found without 
+ *  comparing them. It is a fast 64 bit hash (not a cryptographic one) that 
+ *  mixes in eight bytes at a time, and gives the same hash however the 
+ *  contents are split into chunks. The length of the contents is mixed in 
+ *  at the end, so contents of different lengths rarely share a hash. 
+ *
+*/
+
+#ifndef CONTENTHASH_H
+#define CONTENTHASH_H
+
+#include <cstddef>
+#include <cstdint>
+
+using namespace std;
+
+class contentHash {
+//public functions available to the client 
+public:
+    contentHash();
+
+    //functions for hashing contents a chunk at a time 
+    void update(const char *data, size_t length);
+    uint64_t finish() const;
+
+private:
+    //hash so far, number of bytes hashed, and the bytes of the last 
+    //incomplete eight byte word 
+    uint64_t state;
+    uint64_t total;
+    uint64_t pending;
+    size_t pendingBytes;
+
+    //helper function for mixing in one word 
+    static uint64_t mix(uint64_t hash, uint64_t word);
+};
+
+#endif
@@ -0,0 +1,357 @@
+/*
+ *  corpusWatcher.cpp
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  Contains an implementation of the corpusWatcher class.   
+ *
+*/
+
+#include "corpusWatcher.h"
+#include <chrono>
+#include <stdexcept>
+#include <unordered_set>
+#include <dirent.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const int corpusWatcher::BATCH_MILLISECONDS;
+
+//events that change what is indexed 
+static const uint32_t WATCH_EVENTS = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE |
+                                     IN_MOVED_FROM | IN_MOVED_TO | 
+                                     IN_MOVE_SELF;
+
+/*
+ * name:      corpusWatcher constructor 
+ * purpose:   creates a watcher that is not watching anything 
+ * arguments: none
+ * returns:   none 
+ * effects:   none 
+*/
+corpusWatcher::corpusWatcher() : stopping(false), batches(0) {
+    inotifyFd = -1;
+}
+
+/*
+ * name:      corpusWatcher destructor 
+ * purpose:   stops watching 
+ * arguments: none
+ * returns:   none 
+ * effects:   calls stop 
+*/
+corpusWatcher::~corpusWatcher() {
+    stop();
+}
+
+/*
+ * name:      start 
+ * purpose:   starts watching directories 
+ * arguments: a vector with the paths of the directories to watch and the 
+ *            function to call with each batch of changes 
+ * returns:   none 
+ * effects:   adds an inotify watch for each directory and starts the thread
+ *            that reads events. Throws a runtime_error if inotify cannot be
+ *            used. Directories that cannot be watched are skipped. 
+*/
+void corpusWatcher::start(const vector<string> &directories, 
+                          Callback callback) {
+    stop();
+
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd < 0) {
+        throw runtime_error("Unable to watch directories");
+    }
+
+    for (size_t i = 0; i < directories.size(); i++) {
+        addWatch(directories[i]);
+    }
+
+    apply = callback;
+    stopping = false;
+    worker = thread(&corpusWatcher::watchLoop, this);
+}
+
+/*
+ * name:      stop 
+ * purpose:   stops watching 
+ * arguments: none
+ * returns:   none 
+ * effects:   tells the thread to stop, waits for it (a batch being applied 
+ *            finishes first), and closes the inotify descriptor 
+*/
+void corpusWatcher::stop() {
+    stopping = true;
+    if (worker.joinable()) {
+        worker.join();
+    }
+    if (inotifyFd >= 0) {
+        close(inotifyFd);
+    }
+    inotifyFd = -1;
+    watches.clear();
+}
+
+/*
+ * name:      numBatches 
+ * purpose:   gets the number of batches reported so far 
+ * arguments: none
+ * returns:   a size_t with the number of batches 
+ * effects:   none 
+*/
+size_t corpusWatcher::numBatches() const {
+    return batches;
+}
+
+/*
+ * name:      addWatch 
+ * purpose:   watches one directory 
+ * arguments: a string with the path of the directory 
+ * returns:   returns true if the directory is being watched, false otherwise
+ * effects:   adds an inotify watch and remembers the directory's path for 
+ *            the events that come from it 
+*/
+bool corpusWatcher::addWatch(const string &directory) {
+    int wd = inotify_add_watch(inotifyFd, directory.c_str(), 
+                               WATCH_EVENTS | IN_ONLYDIR);
+    if (wd < 0) {
+        return false;
+    }
+    watches[wd] = directory;
+    return true;
+}
+
+/*
+ * name:      watchTree 
+ * purpose:   watches a new directory and everything under it 
+ * arguments: a string with the path of the directory and the map of pending
+ *            changes 
+ * returns:   none 
+ * effects:   watches the directory first (so files created meanwhile are 
+ *            not missed), then marks each regular file in it as changed and
+ *            does the same for each subdirectory. Symbolic links are not 
+ *            followed, the same as when the directory was indexed. 
+*/
+void corpusWatcher::watchTree(const string &directory, 
+                              map<string, bool> &pending) {
+    if (not addWatch(directory)) {
+        return;
+    }
+
+    DIR *dir = opendir(directory.c_str());
+    if (dir == nullptr) {
+        return;
+    }
+
+    vector<string> subdirectories;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        string name = entry->d_name;
+        if (name == "." or name == "..") {
+            continue;
+        }
+
+        string path = directory + "/" + name;
+        struct stat info;
+        if (lstat(path.c_str(), &info) != 0) {
+            continue;
+        }
+        if (S_ISDIR(info.st_mode)) {
+            subdirectories.push_back(path);
+        } else if (S_ISREG(info.st_mode)) {
+            pending[path] = false;
+        }
+    }
+    closedir(dir);
+
+    for (size_t i = 0; i < subdirectories.size(); i++) {
+        watchTree(subdirectories[i], pending);
+    }
+}
+
+/*
+ * name:      removeTree 
+ * purpose:   stops watching a directory and everything under it 
+ * arguments: a string with the path the directory was watched under 
+ * returns:   none 
+ * effects:   removes the inotify watch of the directory and of each watched 
+ *            directory under it, and forgets their paths, so a directory 
+ *            moved out of the tree is not reported under its old path 
+*/
+void corpusWatcher::removeTree(const string &directory) {
+    string prefix = directory + "/";
+    for (unordered_map<int, string>::iterator it = watches.begin(); 
+         it != watches.end(); ) {
+        if (it->second == directory or 
+            it->second.compare(0, prefix.length(), prefix) == 0) {
+            inotify_rm_watch(inotifyFd, it->first);
+            it = watches.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+/*
+ * name:      rescan 
+ * purpose:   catches up after events were lost 
+ * arguments: the map of pending changes 
+ * returns:   none 
+ * effects:   marks each watched directory whose parent is not watched (the 
+ *            top of each watched tree) as deleted, then watches it again 
+ *            with watchTree, which marks every file under it as changed. 
+ *            Files deleted while events were lost are then gone from the 
+ *            index, and every other file is read again. 
+*/
+void corpusWatcher::rescan(map<string, bool> &pending) {
+    unordered_set<string> watched;
+    for (unordered_map<int, string>::iterator it = watches.begin(); 
+         it != watches.end(); ++it) {
+        watched.insert(it->second);
+    }
+
+    //find the top of each tree 
+    vector<string> tops;
+    for (unordered_set<string>::iterator it = watched.begin(); 
+         it != watched.end(); ++it) {
+        size_t slash = it->rfind('/');
+        if (slash == string::npos or slash == 0 or 
+            watched.count(it->substr(0, slash)) == 0) {
+            tops.push_back(*it);
+        }
+    }
+
+    for (size_t i = 0; i < tops.size(); i++) {
+        pending[tops[i]] = true;
+        watchTree(tops[i], pending);
+    }
+}
+
+/*
+ * name:      readEvents 
+ * purpose:   reads every event that is waiting 
+ * arguments: the map of pending changes, from path to whether it was 
+ *            deleted 
+ * returns:   none 
+ * effects:   marks written and moved in files as changed, and deleted and 
+ *            moved out files and directories as deleted. New directories are
+ *            watched with watchTree, and directories moved out stop being 
+ *            watched. Forgets directories whose watch was removed. Rescans 
+ *            every watched tree if the queue of events overflowed. 
+*/
+void corpusWatcher::readEvents(map<string, bool> &pending) {
+    alignas(struct inotify_event) char buffer[65536];
+
+    while (true) {
+        ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            return;
+        }
+
+        //go through each event in what was read 
+        for (ssize_t offset = 0; offset < length; ) {
+            const struct inotify_event *event = 
+                (const struct inotify_event *) (buffer + offset);
+            offset += sizeof(struct inotify_event) + event->len;
+
+            //events were lost, so read every watched tree again 
+            if (event->mask & IN_Q_OVERFLOW) {
+                rescan(pending);
+                continue;
+            }
+
+            unordered_map<int, string>::iterator found = 
+                watches.find(event->wd);
+            if (found == watches.end()) {
+                continue;
+            }
+            if (event->mask & IN_IGNORED) {
+                watches.erase(found);
+                continue;
+            }
+
+            //a watched directory was moved (out of the tree, or to where 
+            //its new parent's event watches it again) 
+            if (event->mask & IN_MOVE_SELF) {
+                string moved = found->second;
+                pending[moved] = true;
+                removeTree(moved);
+                continue;
+            }
+            if (event->len == 0) {
+                continue;
+            }
+
+            string path = found->second + "/" + event->name;
+            bool isDirectory = event->mask & IN_ISDIR;
+            if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                pending[path] = true;
+                if (isDirectory and (event->mask & IN_MOVED_FROM)) {
+                    removeTree(path);
+                }
+            } else if (isDirectory and 
+                       (event->mask & (IN_CREATE | IN_MOVED_TO))) {
+                watchTree(path, pending);
+            } else if (not isDirectory and 
+                       (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))) {
+                pending[path] = false;
+            }
+        }
+    }
+}
+
+/*
+ * name:      watchLoop 
+ * purpose:   reads events and reports them in batches until told to stop 
+ * arguments: none
+ * returns:   none 
+ * effects:   waits for events (checking whether to stop every few 
+ *            milliseconds), collects them until BATCH_MILLISECONDS have 
+ *            passed since the first one, then calls the callback with the 
+ *            changed and deleted paths. Errors from the callback are 
+ *            dropped so one bad batch does not stop the watching. 
+*/
+void corpusWatcher::watchLoop() {
+    map<string, bool> pending;
+    chrono::steady_clock::time_point batchStart;
+
+    while (not stopping) {
+        struct pollfd waiting = {inotifyFd, POLLIN, 0};
+        int ready = poll(&waiting, 1, BATCH_MILLISECONDS / 4);
+
+        //collect whatever events arrived 
+        if (ready > 0) {
+            bool wasEmpty = pending.empty();
+            readEvents(pending);
+            if (wasEmpty and not pending.empty()) {
+                batchStart = chrono::steady_clock::now();
+            }
+        }
+
+        //report the batch once it is old enough 
+        if (pending.empty() or chrono::steady_clock::now() - batchStart < 
+                               chrono::milliseconds(BATCH_MILLISECONDS)) {
+            continue;
+        }
+
+        vector<string> changed, deleted;
+        for (map<string, bool>::iterator it = pending.begin(); 
+             it != pending.end(); ++it) {
+            if (it->second) {
+                deleted.push_back(it->first);
+            } else {
+                changed.push_back(it->first);
+            }
+        }
+        pending.clear();
+
+        try {
+            apply(changed, deleted);
+        } catch (const exception &e) {
+            //the next batch will try again with whatever is on disk 
+        }
+        batches++;
+    }
+}
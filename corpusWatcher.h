@@ -0,0 +1,75 @@
+/*
+ *  corpusWatcher.h
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  corpusWatcher is a class that watches the indexed directories for files 
+ *  that are written, created, moved, or deleted (with Linux's inotify) and 
+ *  reports them in batches on a background thread. Events are collected for
+ *  at most BATCH_MILLISECONDS after the first one, and only the last event 
+ *  for each path is kept, so a file written many times in a row is only 
+ *  reported once. Directories created (or moved in) while watching are 
+ *  watched too, and every file already in them is reported as changed. A 
+ *  directory moved out is reported as deleted, and its watches (and those 
+ *  under it) are removed; the client removes the files under it. If the 
+ *  kernel's queue of events overflows, events have been lost, so every 
+ *  watched tree is reported as deleted and every file in it as changed, 
+ *  which makes the client index it again from what is on disk. 
+ *
+*/
+
+#ifndef CORPUSWATCHER_H
+#define CORPUSWATCHER_H
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+class corpusWatcher {
+//public functions available to the client 
+public:
+    //function called with each batch of changed and deleted paths 
+    typedef function<void(const vector<string> &changed, 
+                          const vector<string> &deleted)> Callback;
+
+    corpusWatcher();
+    ~corpusWatcher();
+
+    //functions for starting and stopping 
+    void start(const vector<string> &directories, Callback callback);
+    void stop();
+
+    //number of batches reported so far 
+    size_t numBatches() const;
+
+    //longest time events are collected before they are reported 
+    static const int BATCH_MILLISECONDS = 100;
+
+private:
+    //inotify descriptor, the path of each watched directory, and the 
+    //function to report batches to 
+    int inotifyFd;
+    unordered_map<int, string> watches;
+    Callback apply;
+
+    //thread reading events, whether it should stop, and number of batches 
+    thread worker;
+    atomic<bool> stopping;
+    atomic<size_t> batches;
+
+    //helper functions for watching and reading events 
+    void watchLoop();
+    bool addWatch(const string &directory);
+    void watchTree(const string &directory, map<string, bool> &pending);
+    void removeTree(const string &directory);
+    void rescan(map<string, bool> &pending);
+    void readEvents(map<string, bool> &pending);
+};
+
+#endif
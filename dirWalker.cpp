@@ -0,0 +1,385 @@
+/*
+ *  dirWalker.cpp
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  Contains an implementation of the dirWalker class.   
+ *
+*/
+
+#include "dirWalker.h"
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <dirent.h>
+
+// 
+//  linux_dirent64 struct, the layout of each entry returned by getdents64 
+// 
+struct linux_dirent64 {
+    ino64_t d_ino;
+    off64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[1];
+};
+
+//size of the buffer used to read directory entries 
+static const size_t DIRENT_BUFFER_SIZE = 32768;
+
+//number of directories on the path that keep their file descriptors open, 
+//so a deep tree cannot use up the process's descriptors 
+static const size_t MAX_OPEN_DEPTH = 32;
+
+/*
+ * name:      dirWalker constructor 
+ * purpose:   opens the directory to walk 
+ * arguments: a string with the path of a directory and the pathTable to add
+ *            the directories of the walk to 
+ * returns:   none 
+ * effects:   opens the directory, adds it to the table and reads its 
+ *            entries. Throws a runtime_error if the directory cannot be 
+ *            opened. 
+*/
+dirWalker::dirWalker(const string &directory, pathTable &table) 
+    : paths(table) {
+    currentDir = -1;
+    filter = nullptr;
+    deferRange = false;
+    int fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        throw runtime_error("Unable to open directory " + directory);
+    }
+
+    currentPath = directory;
+    push(fd, directory);
+}
+
+/*
+ * name:      destructor 
+ * purpose:   closes any directories that are still open 
+ * arguments: none
+ * returns:   none 
+ * effects:   closes the file descriptor of each directory on the stack 
+ *            that still has one open, and the released ones the client did 
+ *            not take 
+*/
+dirWalker::~dirWalker() {
+    for (size_t i = 0; i < stack.size(); i++) {
+        if (stack[i].fd >= 0) {
+            close(stack[i].fd);
+        }
+    }
+    for (size_t i = 0; i < released.size(); i++) {
+        close(released[i]);
+    }
+}
+
+/*
+ * name:      push 
+ * purpose:   starts visiting a directory 
+ * arguments: an int with the directory's open file descriptor and a string
+ *            with its name 
+ * returns:   none 
+ * effects:   adds the directory to the path table under the directory on top
+ *            of the stack, adds a frame for it (its path is currently in the
+ *            path buffer) and reads its entries 
+*/
+void dirWalker::push(int fd, const string &dirName) {
+    Frame frame;
+    frame.fd = fd;
+    frame.id = paths.addDirectory(stack.empty() ? pathTable::NO_PARENT : 
+                                                  stack.back().id, dirName);
+    if (deferRange) {
+        started.push_back(frame.id);
+    }
+    frame.pathLength = currentPath.length();
+    frame.nextFile = frame.nextSubdir = 0;
+
+    readEntries(frame);
+    stack.push_back(std::move(frame));
+}
+
+/*
+ * name:      release 
+ * purpose:   gives up the descriptor of a directory the walk is done with 
+ * arguments: an int with the directory's open file descriptor 
+ * returns:   none 
+ * effects:   closes the descriptor, or keeps it for the client to close if 
+ *            the ranges are deferred 
+*/
+void dirWalker::release(int fd) {
+    if (deferRange) {
+        released.push_back(fd);
+    } else {
+        close(fd);
+    }
+}
+
+/*
+ * name:      readEntries 
+ * purpose:   reads the files and subdirectories of a directory 
+ * arguments: a reference to the frame of an open directory 
+ * returns:   none 
+ * effects:   reads the entries with getdents64 in the order the file system
+ *            returns them, sorting them into regular files and directories.
+ *            Entries whose type is not known (or that are symbolic links) 
+ *            are checked with fstatat. Other kinds of files are skipped. 
+*/
+void dirWalker::readEntries(Frame &frame) {
+    vector<char> buffer(DIRENT_BUFFER_SIZE);
+
+    while (true) {
+        long bytes = syscall(SYS_getdents64, frame.fd, buffer.data(), 
+                             buffer.size());
+        if (bytes <= 0) {
+            return;
+        }
+
+        //go through each entry in the buffer 
+        for (long offset = 0; offset < bytes; ) {
+            linux_dirent64 *entry = (linux_dirent64 *) (buffer.data() + 
+                                                        offset);
+            offset += entry->d_reclen;
+
+            string entryName = entry->d_name;
+            if (entryName == "." or entryName == "..") {
+                continue;
+            }
+
+            unsigned char type = entry->d_type;
+
+            //find out what unknown entries and links point at 
+            if (type == DT_UNKNOWN or type == DT_LNK) {
+                struct stat info;
+                if (fstatat(frame.fd, entry->d_name, &info, 0) != 0) {
+                    continue;
+                }
+
+                //a link to a directory is not followed 
+                if (S_ISDIR(info.st_mode) and type == DT_LNK) {
+                    continue;
+                }
+                type = S_ISDIR(info.st_mode) ? DT_DIR : 
+                       S_ISREG(info.st_mode) ? DT_REG : DT_UNKNOWN;
+            }
+
+            if (type == DT_DIR) {
+                frame.subdirs.push_back(entryName);
+            } else if (type == DT_REG) {
+                frame.files.push_back(entryName);
+            }
+        }
+    }
+}
+
+/*
+ * name:      setFilter 
+ * purpose:   sets the rules for which files and directories to visit 
+ * arguments: a pointer to a fileFilter, or nullptr to visit everything 
+ * returns:   none 
+ * effects:   files and subdirectories reached after this are checked 
+ *            against the filter's patterns. The filter must outlive the 
+ *            walk. 
+*/
+void dirWalker::setFilter(fileFilter *rules) {
+    filter = rules;
+}
+
+/*
+ * name:      deferRanges 
+ * purpose:   sets whether the walker marks where the files under each 
+ *            directory start and end in the path table 
+ * arguments: a bool, true to leave the ranges to the client 
+ * returns:   none 
+ * effects:   when true, directories that next() enters and finishes are 
+ *            collected in startedDirectories() and finishedDirectories(), 
+ *            for the client to start and finish in the path table 
+*/
+void dirWalker::deferRanges(bool defer) {
+    deferRange = defer;
+}
+
+/*
+ * name:      next 
+ * purpose:   moves to the next file in the walk 
+ * arguments: none
+ * returns:   returns true if the walk stopped at a file, false once every 
+ *            file has been visited 
+ * effects:   visits the files of the current directory first, then opens its
+ *            next subdirectory relative to it, and closes directories once 
+ *            they are finished. Below MAX_OPEN_DEPTH directories, a 
+ *            directory's descriptor is closed as the walk goes into one of 
+ *            its subdirectories (its files have all been visited by then), 
+ *            and its other subdirectories are opened by path. Subdirectories
+ *            that cannot be opened are skipped, as are files and 
+ *            subdirectories the filter (if any) does not want. 
+*/
+bool dirWalker::next() {
+    started.clear();
+    finished.clear();
+    while (not stack.empty()) {
+        Frame &top = stack.back();
+        currentPath.resize(top.pathLength);
+
+        //next file in this directory 
+        if (top.nextFile < top.files.size()) {
+            currentName = top.files[top.nextFile++];
+            currentDir = top.fd;
+            currentPath += '/';
+            currentPath += currentName;
+            if (filter != nullptr and 
+                not filter->wantsFile(currentPath, currentName)) {
+                continue;
+            }
+            return true;
+        }
+
+        //next subdirectory of this directory 
+        if (top.nextSubdir < top.subdirs.size()) {
+            string subdir = top.subdirs[top.nextSubdir++];
+            currentPath += '/';
+            currentPath += subdir;
+            if (filter != nullptr and 
+                not filter->wantsDirectory(currentPath, subdir)) {
+                continue;
+            }
+            int fd = top.fd >= 0 ? 
+                     openat(top.fd, subdir.c_str(), 
+                            O_RDONLY | O_DIRECTORY | O_CLOEXEC) : 
+                     open(currentPath.c_str(), 
+                          O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            if (fd >= 0) {
+                //a deep walk gives up the parent's descriptor 
+                if (stack.size() >= MAX_OPEN_DEPTH and top.fd >= 0) {
+                    release(top.fd);
+                    top.fd = -1;
+                }
+                push(fd, subdir);
+            }
+            continue;
+        }
+
+        //this directory is finished 
+        if (deferRange) {
+            finished.push_back(top.id);
+        } else {
+            paths.finishDirectory(top.id);
+        }
+        if (top.fd >= 0) {
+            release(top.fd);
+        }
+        stack.pop_back();
+    }
+
+    currentDir = -1;
+    return false;
+}
+
+/*
+ * name:      startedDirectories 
+ * purpose:   gets the directories entered by the last call to next 
+ * arguments: none
+ * returns:   a reference to a vector of directory numbers, outermost first, 
+ *            that the client may take. No file under them was handed out 
+ *            before the file next() stopped at. 
+ * effects:   none. Only filled when the ranges are deferred, and cleared by 
+ *            the next call to next. 
+*/
+vector<size_t> &dirWalker::startedDirectories() {
+    return started;
+}
+
+/*
+ * name:      finishedDirectories 
+ * purpose:   gets the directories finished by the last call to next 
+ * arguments: none
+ * returns:   a reference to a vector of directory numbers, innermost first,
+ *            that the client may take. Every file under them was handed out 
+ *            before the file next() stopped at. 
+ * effects:   none. Only filled when the ranges are deferred, and cleared by
+ *            the next call to next. 
+*/
+vector<size_t> &dirWalker::finishedDirectories() {
+    return finished;
+}
+
+/*
+ * name:      releasedDescriptors 
+ * purpose:   gets the descriptors of the directories the walk is done with 
+ * arguments: none
+ * returns:   a reference to a vector of open directory descriptors that the
+ *            client may take and must then close. No file handed out after 
+ *            the last call to next is in these directories. 
+ * effects:   none. Only filled when the ranges are deferred; the walker 
+ *            closes the ones left in it when it is destroyed. 
+*/
+vector<int> &dirWalker::releasedDescriptors() {
+    return released;
+}
+
+/*
+ * name:      path 
+ * purpose:   gets the path of the current file 
+ * arguments: none
+ * returns:   a reference to the path, the given directory followed by each 
+ *            directory name and the file name separated by '/' 
+ * effects:   none. The reference changes when next is called. 
+*/
+const string &dirWalker::path() {
+    return currentPath;
+}
+
+/*
+ * name:      name 
+ * purpose:   gets the name of the current file 
+ * arguments: none
+ * returns:   a reference to the file's name within its directory 
+ * effects:   none. The reference changes when next is called. 
+*/
+const string &dirWalker::name() {
+    return currentName;
+}
+
+/*
+ * name:      directory 
+ * purpose:   gets the path table number of the current file's directory 
+ * arguments: none
+ * returns:   a size_t with the directory's number in the pathTable 
+ * effects:   none 
+*/
+size_t dirWalker::directory() {
+    return stack.back().id;
+}
+
+/*
+ * name:      directoryFd 
+ * purpose:   gets the file descriptor of the current file's directory 
+ * arguments: none
+ * returns:   an int with the open descriptor, to open the file's name 
+ *            relative to 
+ * effects:   none. The descriptor stays open while the walk is in the 
+ *            directory, or until the client closes it if it takes it from 
+ *            releasedDescriptors. 
+*/
+int dirWalker::directoryFd() {
+    return currentDir;
+}
+
+/*
+ * name:      openFile 
+ * purpose:   opens the current file for reading 
+ * arguments: none
+ * returns:   an int with the open file descriptor, or -1 if it could not be 
+ *            opened 
+ * effects:   opens the file relative to its directory's file descriptor 
+*/
+int dirWalker::openFile() {
+    if (currentDir < 0) {
+        return -1;
+    }
+
+    return openat(currentDir, currentName.c_str(), O_RDONLY | O_CLOEXEC);
+}
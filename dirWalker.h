@@ -0,0 +1,103 @@
+/*
+ *  dirWalker.h
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  dirWalker is a class that walks a directory and hands back its files one
+ *  at a time, in the same depth first order the FSTree traversal used: the
+ *  files of a directory first, then each of its subdirectories in turn. It 
+ *  reads directories with getdents64 and keeps an open file descriptor for 
+ *  each directory on the current path (up to a fixed depth, below which 
+ *  subdirectories are opened by path), so files and subdirectories are 
+ *  opened relative to their parent (openat) instead of by full path. The 
+ *  path of each file is kept in one buffer that grows and shrinks as the 
+ *  walk goes up and down the tree, and each directory is added to a 
+ *  pathTable as it is entered so files can be stored by directory number. 
+ *  Only regular files (including symbolic links to regular files) are 
+ *  returned, and symbolic links to directories are not followed so the walk
+ *  cannot loop. Files and directories can be left out by name with a 
+ *  fileFilter. A client that adds files to the pathTable later than the walk
+ *  hands them out (such as while they are read ahead) can ask the walker to
+ *  hold on to the directories it enters and finishes, and start and finish
+ *  their ranges of files itself once the files before them have been 
+ *  added. Such a client also gets the descriptors of the directories the 
+ *  walk is done with to close itself, so it can keep opening files 
+ *  relative to their directories until it has read them. 
+ *
+*/
+
+#ifndef DIRWALKER_H
+#define DIRWALKER_H
+
+#include "pathTable.h"
+#include "fileFilter.h"
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class dirWalker {
+//public functions available to the client 
+public:
+    dirWalker(const string &directory, pathTable &table);
+    ~dirWalker();
+
+    void setFilter(fileFilter *rules);
+    void deferRanges(bool defer);
+    bool next();
+    vector<size_t> &startedDirectories();
+    vector<size_t> &finishedDirectories();
+    vector<int> &releasedDescriptors();
+
+    //functions for the file next() stopped at 
+    const string &path();
+    const string &name();
+    size_t directory();
+    int directoryFd();
+    int openFile();
+
+private:
+    // 
+    //  Frame struct, used to store a directory on the current path: its 
+    //  file descriptor (-1 once it is closed for a deep walk), its number in
+    //  the path table, where its name ends in the path buffer, and the files
+    //  and subdirectories in it that have not been visited yet 
+    // 
+    struct Frame {
+        int fd;
+        size_t id;
+        size_t pathLength;
+        vector<string> files;
+        vector<string> subdirs;
+        size_t nextFile;
+        size_t nextSubdir;
+    };
+
+    //directories on the current path, deepest last 
+    vector<Frame> stack;
+
+    //table that each directory visited is added to, and the rules for 
+    //which files and directories to visit (nullptr for all of them) 
+    pathTable &paths;
+    fileFilter *filter;
+
+    //whether the ranges of files under directories are left for the 
+    //client, the directories entered and finished during the last call to 
+    //next, and the descriptors of directories left for the client to close
+    bool deferRange;
+    vector<size_t> started;
+    vector<size_t> finished;
+    vector<int> released;
+
+    //path and name of the current file, and the directory it is in 
+    string currentPath;
+    string currentName;
+    int currentDir;
+
+    //helper functions for walking 
+    void push(int fd, const string &dirName);
+    void release(int fd);
+    void readEntries(Frame &frame);
+};
+
+#endif
@@ -0,0 +1,526 @@
+/*
+ *  diskIndex.cpp
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  Contains an implementation of the diskIndex class.   
+ *
+*/
+
+#include "diskIndex.h"
+#include "stringProcessing.h"
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//locations are used straight from the file, so they must be plain integers
+static_assert(sizeof(Instance) == sizeof(PackedLocation), 
+              "Instance must be a single packed location");
+
+const char diskIndex::MAGIC[8] = {'G', 'E', 'R', 'P', 'I', 'X', '2', 
+                                  (char) ('0' + sizeof(PackedLocation))};
+const size_t diskIndex::KEY_STRIDE;
+const size_t diskIndex::HOT_KEYS;
+const size_t diskIndex::PREFETCH_BYTES;
+
+/*
+ * name:      diskIndex constructor 
+ * purpose:   creates an index with no file mapped 
+ * arguments: none
+ * returns:   none 
+ * effects:   none 
+*/
+diskIndex::diskIndex() {
+    base = nullptr;
+    length = 0;
+    ownsMapping = false;
+    header = nullptr;
+    locationArray = nullptr;
+    keys = nullptr;
+    wordTable = nullptr;
+    names = nullptr;
+    directory = nullptr;
+    directoryNames = nullptr;
+    hotKeys = nullptr;
+}
+
+/*
+ * name:      diskIndex destructor 
+ * purpose:   unmaps the index file 
+ * arguments: none
+ * returns:   none 
+ * effects:   calls close 
+*/
+diskIndex::~diskIndex() {
+    close();
+}
+
+/*
+ * name:      open 
+ * purpose:   maps an index file for lookups 
+ * arguments: a string with the path of an index file written by spimiBuilder
+ * returns:   none 
+ * effects:   maps the whole file read only and finds each of its parts from 
+ *            the header. Throws a runtime_error if the file cannot be mapped
+ *            or is not an index file (or was written with a different 
+ *            location width). 
+*/
+void diskIndex::open(const string &path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw runtime_error("Unable to open index " + path);
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 or (size_t) info.st_size < sizeof(Header)) {
+        ::close(fd);
+        throw runtime_error("Not an index file " + path);
+    }
+
+    //map the file, the mapping stays valid after the descriptor is closed 
+    void *mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        throw runtime_error("Unable to map index " + path);
+    }
+
+    try {
+        attach((const char *) mapped, info.st_size);
+    } catch (const runtime_error &e) {
+        munmap(mapped, info.st_size);
+        throw runtime_error(string(e.what()) + " file " + path);
+    }
+    ownsMapping = true;
+}
+
+/*
+ * name:      attach 
+ * purpose:   answers lookups from an index that is already in memory 
+ * arguments: a pointer to the bytes of an index file written by 
+ *            spimiBuilder (8 byte aligned, such as part of a larger mapped 
+ *            file) and their number 
+ * returns:   none 
+ * effects:   checks the index with validate, then finds each part of it 
+ *            from the header, without copying it, starts reading the key 
+ *            directory in, and marks the tables for random access. The 
+ *            bytes must stay mapped while the index uses them. Throws a 
+ *            runtime_error if they are not an index or are damaged. 
+*/
+void diskIndex::attach(const char *image, size_t imageLength) {
+    close();
+    validate(image, imageLength);
+
+    //find each part of the file from the header 
+    const Header *found = (const Header *) image;
+    base = image;
+    length = imageLength;
+    header = found;
+    locationArray = (const Instance *) (base + header->locationsOffset);
+    keys = (const KeyEntry *) (base + header->keysOffset);
+    wordTable = (const WordEntry *) (base + header->wordsOffset);
+    names = base + header->namesOffset;
+    directory = (const DirectoryEntry *) (base + header->directoryOffset);
+    directoryNames = base + header->directoryNamesOffset;
+    hotKeys = (const uint64_t *) (base + header->hotOffset);
+
+    //the directory is needed by the first lookup, and the tables are only 
+    //ever read a few entries at a time 
+    advise(directory, header->directoryNamesOffset + 
+                      header->directoryNamesBytes - header->directoryOffset, 
+           MADV_WILLNEED);
+    advise(keys, header->namesOffset + header->namesBytes - 
+                 header->keysOffset, MADV_RANDOM);
+}
+
+/*
+ * name:      fits 
+ * purpose:   checks that a part of an image lies inside it 
+ * arguments: the offset of the part, its number of items, the size and 
+ *            alignment of an item, and the number of bytes in the image 
+ * returns:   returns true if the part is aligned and ends inside the image,
+ *            false otherwise 
+ * effects:   none, and does no arithmetic that could wrap around 
+*/
+bool diskIndex::fits(uint64_t offset, uint64_t count, size_t size, 
+                     size_t align, size_t bytes) {
+    return offset <= bytes and offset % align == 0 and 
+           count <= (bytes - offset) / size;
+}
+
+/*
+ * name:      validate 
+ * purpose:   checks that an image is an undamaged index before it is used 
+ * arguments: a pointer to the bytes of the image and their number 
+ * returns:   none 
+ * effects:   checks the magic, that every part named by the header lies 
+ *            inside the image, that there is one directory entry for each 
+ *            KEY_STRIDE keys, and that the name, words and locations of 
+ *            every directory entry, key, word and hot key lie inside their 
+ *            parts, so no lookup can read outside the image. Reads each 
+ *            table once. Throws a runtime_error naming the first part that
+ *            is wrong. 
+*/
+void diskIndex::validate(const char *image, size_t imageLength) {
+    if (imageLength < sizeof(Header) or 
+        memcmp(((const Header *) image)->magic, MAGIC, sizeof(MAGIC)) != 0) {
+        throw runtime_error("Not an index");
+    }
+    const Header &found = *(const Header *) image;
+
+    //every part must lie inside the image 
+    if (not fits(found.locationsOffset, found.numLocations, 
+                 sizeof(Instance), alignof(Instance), imageLength) or 
+        not fits(found.keysOffset, found.numKeys, sizeof(KeyEntry), 
+                 alignof(KeyEntry), imageLength) or 
+        not fits(found.wordsOffset, found.numWords, sizeof(WordEntry), 
+                 alignof(WordEntry), imageLength) or 
+        not fits(found.namesOffset, found.namesBytes, 1, 1, imageLength) or
+        not fits(found.directoryOffset, found.numDirectory, 
+                 sizeof(DirectoryEntry), alignof(DirectoryEntry), 
+                 imageLength) or 
+        not fits(found.directoryNamesOffset, found.directoryNamesBytes, 1, 
+                 1, imageLength) or 
+        not fits(found.hotOffset, found.numHot, sizeof(uint64_t), 
+                 alignof(uint64_t), imageLength)) {
+        throw runtime_error("Damaged index: a part is outside the file");
+    }
+    if (found.numDirectory != (found.numKeys + KEY_STRIDE - 1) / KEY_STRIDE) {
+        throw runtime_error("Damaged index: wrong size of key directory");
+    }
+
+    //every entry must point inside its parts 
+    const DirectoryEntry *entries = 
+        (const DirectoryEntry *) (image + found.directoryOffset);
+    for (uint64_t i = 0; i < found.numDirectory; i++) {
+        if (not fits(entries[i].nameOffset, entries[i].nameLength, 1, 1, 
+                     found.directoryNamesBytes)) {
+            throw runtime_error("Damaged index: bad key directory entry");
+        }
+    }
+    const KeyEntry *keyTable = (const KeyEntry *) (image + found.keysOffset);
+    for (uint64_t i = 0; i < found.numKeys; i++) {
+        if (not fits(keyTable[i].nameOffset, keyTable[i].nameLength, 1, 1, 
+                     found.namesBytes) or 
+            not fits(keyTable[i].firstWord, keyTable[i].numWords, 1, 1, 
+                     found.numWords)) {
+            throw runtime_error("Damaged index: bad key " + to_string(i));
+        }
+    }
+    const WordEntry *wordEntries = 
+        (const WordEntry *) (image + found.wordsOffset);
+    for (uint64_t i = 0; i < found.numWords; i++) {
+        if (not fits(wordEntries[i].nameOffset, wordEntries[i].nameLength, 
+                     1, 1, found.namesBytes) or 
+            not fits(wordEntries[i].firstLocation, 
+                     wordEntries[i].numLocations, 1, 1, 
+                     found.numLocations)) {
+            throw runtime_error("Damaged index: bad word " + to_string(i));
+        }
+    }
+    const uint64_t *hot = (const uint64_t *) (image + found.hotOffset);
+    for (uint64_t i = 0; i < found.numHot; i++) {
+        if (hot[i] >= found.numKeys) {
+            throw runtime_error("Damaged index: bad hot key");
+        }
+    }
+}
+
+/*
+ * name:      close 
+ * purpose:   unmaps the index file, if one is mapped 
+ * arguments: none
+ * returns:   none 
+ * effects:   any pointers or LocationLists from the index become invalid 
+*/
+void diskIndex::close() {
+    if (base != nullptr and ownsMapping) {
+        munmap((void *) base, length);
+    }
+    ownsMapping = false;
+    base = nullptr;
+    length = 0;
+    header = nullptr;
+    locationArray = nullptr;
+    keys = nullptr;
+    wordTable = nullptr;
+    names = nullptr;
+    directory = nullptr;
+    directoryNames = nullptr;
+    hotKeys = nullptr;
+}
+
+/*
+ * name:      isOpen 
+ * purpose:   checks whether an index file is mapped 
+ * arguments: none
+ * returns:   returns true if a file is mapped, false otherwise 
+ * effects:   none 
+*/
+bool diskIndex::isOpen() const {
+    return base != nullptr;
+}
+
+/*
+ * name:      compareName 
+ * purpose:   compares the text of a key or word in the file to a string 
+ * arguments: a pointer to the text in the file and its length, and a 
+ *            string to compare it to 
+ * returns:   an int less than, equal to, or greater than 0 if the text sorts
+ *            before, the same as, or after the string (byte by byte) 
+ * effects:   none 
+*/
+int diskIndex::compareName(const char *name, uint32_t nameLength, 
+                           const string &text) {
+    size_t shorter = min((size_t) nameLength, text.length());
+    int result = memcmp(name, text.data(), shorter);
+    if (result != 0) {
+        return result;
+    }
+    if (nameLength == text.length()) {
+        return 0;
+    }
+    return nameLength < text.length() ? -1 : 1;
+}
+
+/*
+ * name:      findKey 
+ * purpose:   finds the lowercase key of a word 
+ * arguments: a string with a word in any case 
+ * returns:   returns a pointer to the key's entry in the mapped file, or 
+ *            nullptr if no case of the word is in the index 
+ * effects:   binary searches the key directory for the stride of keys 
+ *            the word would be in, then binary searches that stride (the 
+ *            keys are sorted by their text) 
+*/
+const diskIndex::KeyEntry *diskIndex::findKey(const string &word) const {
+    if (not isOpen()) {
+        return nullptr;
+    }
+
+    //keys are stored in lowercase 
+    string lower = word;
+    for (size_t i = 0; i < lower.length(); i++) {
+        lower[i] = lowerChar(lower[i]);
+    }
+
+    //find the last stride whose first key is not after the word 
+    size_t low = 0, high = header->numDirectory;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (compareName(directoryNames + directory[middle].nameOffset, 
+                        directory[middle].nameLength, lower) <= 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    if (low == 0) {
+        return nullptr;
+    }
+
+    //search the keys of that stride 
+    low = (low - 1) * KEY_STRIDE;
+    high = min(low + KEY_STRIDE, (size_t) header->numKeys);
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        int order = compareName(names + keys[middle].nameOffset, 
+                                keys[middle].nameLength, lower);
+        if (order == 0) {
+            return &keys[middle];
+        } else if (order < 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return nullptr;
+}
+
+/*
+ * name:      findWord 
+ * purpose:   finds a case sensitive word 
+ * arguments: a string with the word 
+ * returns:   returns a pointer to the word's entry in the mapped file, or 
+ *            nullptr if the word is not in the index with that case 
+ * effects:   finds the word's key and searches its words 
+*/
+const diskIndex::WordEntry *diskIndex::findWord(const string &word) const {
+    const KeyEntry *key = findKey(word);
+    if (key == nullptr) {
+        return nullptr;
+    }
+
+    const WordEntry *entries = words(*key);
+    for (uint32_t i = 0; i < key->numWords; i++) {
+        if (compareName(names + entries[i].nameOffset, 
+                        entries[i].nameLength, word) == 0) {
+            return &entries[i];
+        }
+    }
+
+    return nullptr;
+}
+
+/*
+ * name:      words 
+ * purpose:   gets the case sensitive words of a key 
+ * arguments: a reference to a key's entry 
+ * returns:   a pointer to the first of the key's numWords word entries 
+ * effects:   none 
+*/
+const diskIndex::WordEntry *diskIndex::words(const KeyEntry &key) const {
+    return wordTable + key.firstWord;
+}
+
+/*
+ * name:      locations 
+ * purpose:   gets the sorted locations of a case sensitive word 
+ * arguments: a reference to a word's entry 
+ * returns:   a LocationList pointing into the mapped file 
+ * effects:   none, the list is only valid while the file is mapped 
+*/
+LocationList diskIndex::locations(const WordEntry &word) const {
+    LocationList list = {locationArray + word.firstLocation, 
+                         (size_t) word.numLocations};
+    return list;
+}
+
+/*
+ * name:      keyAt 
+ * purpose:   gets a key by its place in the sorted keys 
+ * arguments: a size_t with the number of the key, less than numKeys() 
+ * returns:   a pointer to the key's entry 
+ * effects:   none 
+*/
+const diskIndex::KeyEntry *diskIndex::keyAt(size_t index) const {
+    return keys + index;
+}
+
+/*
+ * name:      name 
+ * purpose:   gets the text of a key or word 
+ * arguments: the nameOffset of a key's or word's entry 
+ * returns:   a pointer to the text, which is nameLength characters long and
+ *            not null terminated 
+ * effects:   none 
+*/
+const char *diskIndex::name(uint64_t nameOffset) const {
+    return names + nameOffset;
+}
+
+/*
+ * name:      prefetch 
+ * purpose:   starts reading a list of locations before it is used 
+ * arguments: a reference to a LocationList from locations 
+ * returns:   none 
+ * effects:   asks the kernel to read the first PREFETCH_BYTES of the list 
+ *            in the background, so the lists of several words are read at 
+ *            once instead of one page fault at a time. The rest of a longer
+ *            list is read ahead as it is walked. Lists that are not in the 
+ *            index file are left alone. 
+*/
+void diskIndex::prefetch(const LocationList &list) const {
+    if (isOpen() and list.size > 0 and list.data >= locationArray and 
+        list.data < locationArray + header->numLocations) {
+        advise(list.data, min(list.size * sizeof(Instance), PREFETCH_BYTES), 
+               MADV_WILLNEED);
+    }
+}
+
+/*
+ * name:      prefetchHot 
+ * purpose:   starts reading the locations of the most common keys 
+ * arguments: none
+ * returns:   none 
+ * effects:   prefetches the key, word entries and locations of each of the
+ *            HOT_KEYS keys with the most lines when the index was built, so
+ *            the first queries of common words do not wait for the disk. 
+ *            Returns at once; the reading happens in the background. 
+*/
+void diskIndex::prefetchHot() const {
+    if (not isOpen()) {
+        return;
+    }
+
+    for (uint64_t i = 0; i < header->numHot; i++) {
+        if (hotKeys[i] >= header->numKeys) {
+            continue;
+        }
+        const KeyEntry &key = keys[hotKeys[i]];
+        const WordEntry *entries = words(key);
+        advise(&key, sizeof(KeyEntry), MADV_WILLNEED);
+        advise(entries, key.numWords * sizeof(WordEntry), MADV_WILLNEED);
+        for (uint32_t j = 0; j < key.numWords; j++) {
+            prefetch(locations(entries[j]));
+        }
+    }
+}
+
+/*
+ * name:      advise 
+ * purpose:   tells the kernel how part of the mapped file will be used 
+ * arguments: a pointer to the start of the part, its length in bytes, and 
+ *            the madvise advice 
+ * returns:   none 
+ * effects:   calls madvise on the whole pages holding the part. The advice 
+ *            is only a hint, so failures are ignored. 
+*/
+void diskIndex::advise(const void *start, size_t bytes, int advice) const {
+    static const size_t pageSize = sysconf(_SC_PAGESIZE);
+    if (bytes == 0) {
+        return;
+    }
+    uintptr_t first = (uintptr_t) start / pageSize * pageSize;
+    uintptr_t end = (uintptr_t) start + bytes;
+    madvise((void *) first, end - first, advice);
+}
+
+/*
+ * name:      numKeys 
+ * purpose:   gets the number of lowercase keys in the index 
+ * arguments: none
+ * returns:   a size_t with the number of keys, 0 if no file is mapped 
+ * effects:   none 
+*/
+size_t diskIndex::numKeys() const {
+    return isOpen() ? header->numKeys : 0;
+}
+
+/*
+ * name:      numWords 
+ * purpose:   gets the number of case sensitive words in the index 
+ * arguments: none
+ * returns:   a size_t with the number of words, 0 if no file is mapped 
+ * effects:   none 
+*/
+size_t diskIndex::numWords() const {
+    return isOpen() ? header->numWords : 0;
+}
+
+/*
+ * name:      numLocations 
+ * purpose:   gets the number of locations stored in the index 
+ * arguments: none
+ * returns:   a size_t with the number of locations, 0 if no file is mapped 
+ * effects:   none 
+*/
+size_t diskIndex::numLocations() const {
+    return isOpen() ? header->numLocations : 0;
+}
+
+/*
+ * name:      bytes 
+ * purpose:   gets the size of the mapped index file 
+ * arguments: none
+ * returns:   a size_t with the length of the file in bytes 
+ * effects:   none 
+*/
+size_t diskIndex::bytes() const {
+    return length;
+}
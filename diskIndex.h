@@ -0,0 +1,162 @@
+/*
+ *  diskIndex.h
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  diskIndex is a class that answers lookups from an index file written by 
+ *  spimiBuilder, mapped into memory with mmap instead of read in. The file 
+ *  holds no pointers, only offsets from the start of the file, so it can be 
+ *  mapped at any address. It is laid out as a header, every word's 
+ *  locations (one sorted array per case sensitive word), a table of the 
+ *  lowercase keys sorted by their text, a table of the case sensitive words 
+ *  (the words of each key next to each other), and the text of the keys and 
+ *  words, followed by a small key directory: the text of every KEY_STRIDE-th
+ *  key, and the keys with the most lines. A key is found with a binary 
+ *  search of the directory, which is read in as soon as the file is 
+ *  mapped, and then of the one stride of keys it points to, so a lookup 
+ *  touches a page or two of the tables however big the index is. The 
+ *  tables are marked for random access, so a lookup does not read the 
+ *  pages around the ones it needs, and the locations are used straight 
+ *  from the mapping, so only the pages that a query touches are ever read 
+ *  from disk. The start of a list of locations (or the lists of the 
+ *  hottest keys) can be requested ahead of use with prefetch. An index can 
+ *  also be read from part of a larger mapped file. 
+ *
+*/
+
+#ifndef DISKINDEX_H
+#define DISKINDEX_H
+
+#include "packedLocation.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class diskIndex {
+//public functions available to the client 
+public:
+    // 
+    //  Header struct, used to find each part of the index file 
+    // 
+    struct Header {
+        char magic[8];
+        uint64_t numKeys;
+        uint64_t numWords;
+        uint64_t numLocations;
+        uint64_t locationsOffset;
+        uint64_t keysOffset;
+        uint64_t wordsOffset;
+        uint64_t namesOffset;
+        uint64_t namesBytes;
+        uint64_t directoryOffset;
+        uint64_t numDirectory;
+        uint64_t directoryNamesOffset;
+        uint64_t directoryNamesBytes;
+        uint64_t hotOffset;
+        uint64_t numHot;
+    };
+
+    // 
+    //  KeyEntry struct, used to store a lowercase key, its range of case 
+    //  sensitive words, and the number of distinct lines and files with any 
+    //  of them 
+    // 
+    struct KeyEntry {
+        uint64_t nameOffset;
+        uint32_t nameLength;
+        uint32_t numWords;
+        uint64_t firstWord;
+        uint64_t numLines;
+        uint64_t numFiles;
+    };
+
+    // 
+    //  WordEntry struct, used to store a case sensitive word and where its 
+    //  sorted locations are in the index file 
+    // 
+    struct WordEntry {
+        uint64_t nameOffset;
+        uint32_t nameLength;
+        uint32_t numFiles;
+        uint64_t firstLocation;
+        uint64_t numLocations;
+    };
+
+    // 
+    //  DirectoryEntry struct, used to store the text of every KEY_STRIDE-th
+    //  key in the key directory (in the directory's own names) 
+    // 
+    struct DirectoryEntry {
+        uint64_t nameOffset;
+        uint32_t nameLength;
+        uint32_t padding;
+    };
+
+    static const char MAGIC[8];
+
+    //keys per entry of the key directory, number of hot keys stored, and 
+    //the most bytes of a list of locations requested by one prefetch 
+    static const size_t KEY_STRIDE = 64;
+    static const size_t HOT_KEYS = 64;
+    static const size_t PREFETCH_BYTES = 256 << 10;
+
+    diskIndex();
+    ~diskIndex();
+
+    //functions for mapping an index file 
+    void open(const string &path);
+    void attach(const char *image, size_t imageLength);
+    void close();
+    bool isOpen() const;
+
+    //functions for looking up words 
+    const KeyEntry *findKey(const string &word) const;
+    const WordEntry *findWord(const string &word) const;
+    const WordEntry *words(const KeyEntry &key) const;
+    LocationList locations(const WordEntry &word) const;
+
+    //functions for going through every key and the text of each entry 
+    const KeyEntry *keyAt(size_t index) const;
+    const char *name(uint64_t nameOffset) const;
+
+    //functions for reading parts of the index ahead of their use 
+    void prefetch(const LocationList &list) const;
+    void prefetchHot() const;
+
+    //functions for the size of the index 
+    size_t numKeys() const;
+    size_t numWords() const;
+    size_t numLocations() const;
+    size_t bytes() const;
+
+private:
+    //the mapped file and its length, and whether we mapped it (rather than
+    //being given it by attach) 
+    const char *base;
+    size_t length;
+    bool ownsMapping;
+
+    //each part of the mapped file 
+    const Header *header;
+    const Instance *locationArray;
+    const KeyEntry *keys;
+    const WordEntry *wordTable;
+    const char *names;
+    const DirectoryEntry *directory;
+    const char *directoryNames;
+    const uint64_t *hotKeys;
+
+    //helper functions for comparing the text of a key or word to a string,
+    //for advising the kernel how a part of the mapping will be used, and 
+    //for checking the parts of an image before trusting them 
+    static int compareName(const char *name, uint32_t nameLength, 
+                           const string &text);
+    void advise(const void *start, size_t bytes, int advice) const;
+    static bool fits(uint64_t offset, uint64_t count, size_t size, 
+                     size_t align, size_t bytes);
+    static void validate(const char *image, size_t imageLength);
+};
+
+#endif
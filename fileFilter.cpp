@@ -0,0 +1,371 @@
+/*
+ *  fileFilter.cpp
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  Contains an implementation of the fileFilter class.   
+ *
+*/
+
+#include "fileFilter.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fnmatch.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const size_t fileFilter::SNIFF_BYTES;
+const size_t fileFilter::MAX_INVALID_FRACTION;
+
+//a byte of ones in every byte of a word, and the top bit of every byte 
+static const uint64_t ONES = 0x0101010101010101ULL;
+static const uint64_t HIGH_BITS = 0x8080808080808080ULL;
+
+/*
+ * name:      fileFilter constructor 
+ * purpose:   creates a filter that skips only binary files 
+ * arguments: none
+ * returns:   none 
+ * effects:   sets no patterns and no size limit 
+*/
+fileFilter::fileFilter() {
+    maxBytes = 0;
+    skipBinary = true;
+    numByName = numDirectories = numBySize = numBinary = numBytes = 0;
+}
+
+/*
+ * name:      include 
+ * purpose:   adds a pattern that files must match 
+ * arguments: a string with a glob pattern 
+ * returns:   none 
+ * effects:   once there is any include pattern, only files matching one of 
+ *            them are indexed. Directories are not limited by it. 
+*/
+void fileFilter::include(const string &pattern) {
+    includes.push_back(pattern);
+}
+
+/*
+ * name:      exclude 
+ * purpose:   adds a pattern for files and directories to skip 
+ * arguments: a string with a glob pattern 
+ * returns:   none 
+ * effects:   files and directories matching it are skipped, even if they 
+ *            match an include pattern. Nothing under a skipped directory is
+ *            visited. 
+*/
+void fileFilter::exclude(const string &pattern) {
+    excludes.push_back(pattern);
+}
+
+/*
+ * name:      setMaxBytes 
+ * purpose:   sets the largest file to index 
+ * arguments: a size_t with the most bytes a file may have, 0 for no limit 
+ * returns:   none 
+ * effects:   none 
+*/
+void fileFilter::setMaxBytes(size_t bytes) {
+    maxBytes = bytes;
+}
+
+/*
+ * name:      setSkipBinary 
+ * purpose:   sets whether binary files are skipped 
+ * arguments: a bool, true to skip binary files 
+ * returns:   none 
+ * effects:   none 
+*/
+void fileFilter::setSkipBinary(bool skip) {
+    skipBinary = skip;
+}
+
+/*
+ * name:      matches 
+ * purpose:   matches a glob pattern against a file or directory 
+ * arguments: a string with the pattern, and the path and name of the file 
+ *            or directory 
+ * returns:   returns true if the pattern matches, false otherwise 
+ * effects:   a pattern with a '/' is matched against the whole path, and 
+ *            one without against the name 
+*/
+bool fileFilter::matches(const string &pattern, const string &path, 
+                         const string &name) {
+    const string &text = pattern.find('/') == string::npos ? name : path;
+    return fnmatch(pattern.c_str(), text.c_str(), 0) == 0;
+}
+
+/*
+ * name:      wantsFile 
+ * purpose:   checks a file's name against the patterns 
+ * arguments: a string with the path of a file and a string with its name 
+ * returns:   returns true if the file should be indexed, false otherwise 
+ * effects:   counts the file as skipped by name if it is not wanted 
+*/
+bool fileFilter::wantsFile(const string &path, const string &name) {
+    bool wanted = checkName(path, name);
+    if (not wanted) {
+        numByName++;
+    }
+    return wanted;
+}
+
+/*
+ * name:      checkName 
+ * purpose:   checks a file's name against the patterns 
+ * arguments: a string with the path of a file and a string with its name 
+ * returns:   returns true if the file should be indexed, false otherwise 
+ * effects:   none. Does not count the file, so it can be called from any 
+ *            thread. 
+*/
+bool fileFilter::checkName(const string &path, const string &name) const {
+    bool wanted = includes.empty();
+    for (size_t i = 0; i < includes.size() and not wanted; i++) {
+        wanted = matches(includes[i], path, name);
+    }
+    for (size_t i = 0; i < excludes.size() and wanted; i++) {
+        wanted = not matches(excludes[i], path, name);
+    }
+    return wanted;
+}
+
+/*
+ * name:      wantsDirectory 
+ * purpose:   checks a directory's name against the exclude patterns 
+ * arguments: a string with the path of a directory and a string with its 
+ *            name 
+ * returns:   returns true if the directory should be walked, false otherwise
+ * effects:   counts the directory as skipped if it is not wanted 
+*/
+bool fileFilter::wantsDirectory(const string &path, const string &name) {
+    for (size_t i = 0; i < excludes.size(); i++) {
+        if (matches(excludes[i], path, name)) {
+            numDirectories++;
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * name:      wantsContents 
+ * purpose:   checks an open file's size and first block 
+ * arguments: an int with the file descriptor of an open file 
+ * returns:   returns true if the file should be indexed, false otherwise 
+ * effects:   checks the size with fstat and reads the first SNIFF_BYTES with
+ *            pread, so the file is still at its start afterwards. Counts the
+ *            file and its bytes as skipped if it is not wanted. 
+*/
+bool fileFilter::wantsContents(int fd) {
+    size_t fileBytes = 0;
+    Verdict verdict = checkContents(fd, fileBytes);
+    return record(verdict, fileBytes);
+}
+
+/*
+ * name:      checkContents 
+ * purpose:   checks an open file's size and first block 
+ * arguments: an int with the file descriptor of an open file and a 
+ *            reference to a size_t to store its number of bytes in 
+ * returns:   the Verdict on the file, WANTED if it cannot be checked 
+ * effects:   checks the size with fstat and reads the first SNIFF_BYTES with
+ *            pread, so the file is still at its start afterwards. Does not 
+ *            count the file, so it can be called from any thread. 
+*/
+fileFilter::Verdict fileFilter::checkContents(int fd, 
+                                              size_t &fileBytes) const {
+    struct stat info;
+    fileBytes = 0;
+    if (fstat(fd, &info) != 0) {
+        return WANTED;
+    }
+    fileBytes = info.st_size;
+
+    //files over the size limit 
+    Verdict verdict = checkSize(fileBytes);
+
+    //binary files 
+    if (verdict == WANTED and skipBinary) {
+        char block[SNIFF_BYTES];
+        ssize_t length = pread(fd, block, sizeof(block), 0);
+        if (length > 0) {
+            verdict = checkStart(block, length);
+        }
+    }
+    return verdict;
+}
+
+/*
+ * name:      checkSize 
+ * purpose:   checks a file's size against the limit 
+ * arguments: a size_t with the number of bytes in the file 
+ * returns:   TOO_BIG if the file is over the limit, WANTED otherwise 
+ * effects:   none. Does not count the file, so it can be called from any 
+ *            thread. 
+*/
+fileFilter::Verdict fileFilter::checkSize(size_t fileBytes) const {
+    if (maxBytes > 0 and fileBytes > maxBytes) {
+        return TOO_BIG;
+    }
+    return WANTED;
+}
+
+/*
+ * name:      checkStart 
+ * purpose:   checks the first bytes of a file for binary contents 
+ * arguments: a pointer to the first bytes of a file and how many there are
+ *            (only the first SNIFF_BYTES are looked at) 
+ * returns:   BINARY if binary files are skipped and these bytes look binary,
+ *            WANTED otherwise 
+ * effects:   none. Does not count the file, so it can be called from any 
+ *            thread. 
+*/
+fileFilter::Verdict fileFilter::checkStart(const char *start, 
+                                           size_t length) const {
+    if (skipBinary and looksBinary(start, min(length, SNIFF_BYTES))) {
+        return BINARY;
+    }
+    return WANTED;
+}
+
+/*
+ * name:      record 
+ * purpose:   counts a file that checkSize or checkStart turned away 
+ * arguments: the Verdict on a file and a size_t with its number of bytes 
+ * returns:   returns true if the file should be indexed, false otherwise 
+ * effects:   adds the file and its bytes to the count for its reason 
+*/
+bool fileFilter::record(Verdict verdict, size_t fileBytes) {
+    if (verdict == TOO_BIG) {
+        numBySize++;
+    } else if (verdict == BINARY) {
+        numBinary++;
+    } else {
+        return true;
+    }
+
+    numBytes += fileBytes;
+    return false;
+}
+
+/*
+ * name:      looksBinary 
+ * purpose:   checks whether the start of a file is binary 
+ * arguments: a pointer to the first bytes of a file and how many there are
+ * returns:   returns true if there is a NUL byte or too many bytes in 
+ *            invalid UTF-8 sequences, false otherwise 
+ * effects:   skips over eight bytes at a time while they are all ASCII and 
+ *            not NUL, and decodes UTF-8 sequences byte by byte otherwise. A 
+ *            sequence cut off by the end of the block is not counted. 
+*/
+bool fileFilter::looksBinary(const char *data, size_t length) {
+    const unsigned char *bytes = (const unsigned char *) data;
+    size_t invalid = 0, i = 0;
+
+    while (i < length) {
+        //eight plain ASCII bytes with no NUL among them are skipped at once
+        if (i + 8 <= length) {
+            uint64_t word;
+            memcpy(&word, bytes + i, 8);
+            uint64_t hasZero = (word - ONES) & ~word & HIGH_BITS;
+            if (hasZero == 0 and (word & HIGH_BITS) == 0) {
+                i += 8;
+                continue;
+            }
+        }
+
+        unsigned char c = bytes[i];
+        if (c == 0) {
+            return true;
+        }
+        if (c < 0x80) {
+            i++;
+            continue;
+        }
+
+        //find the length of the sequence from its first byte 
+        size_t size = (c >= 0xc2 and c <= 0xdf) ? 2 : 
+                      (c >= 0xe0 and c <= 0xef) ? 3 : 
+                      (c >= 0xf0 and c <= 0xf4) ? 4 : 0;
+        if (size == 0) {
+            invalid++;
+            i++;
+            continue;
+        }
+        if (i + size > length) {
+            break;
+        }
+
+        //every following byte must be a continuation byte 
+        bool valid = true;
+        for (size_t j = 1; j < size and valid; j++) {
+            valid = (bytes[i + j] & 0xc0) == 0x80;
+        }
+        if (valid) {
+            i += size;
+        } else {
+            invalid++;
+            i++;
+        }
+    }
+
+    return invalid * MAX_INVALID_FRACTION > length;
+}
+
+/*
+ * name:      skippedByName 
+ * purpose:   gets the number of files skipped by the patterns 
+ * arguments: none
+ * returns:   a size_t with the number of files 
+ * effects:   none 
+*/
+size_t fileFilter::skippedByName() const {
+    return numByName;
+}
+
+/*
+ * name:      skippedDirectories 
+ * purpose:   gets the number of directories skipped by the patterns 
+ * arguments: none
+ * returns:   a size_t with the number of directories 
+ * effects:   none 
+*/
+size_t fileFilter::skippedDirectories() const {
+    return numDirectories;
+}
+
+/*
+ * name:      skippedBySize 
+ * purpose:   gets the number of files skipped for being too big 
+ * arguments: none
+ * returns:   a size_t with the number of files 
+ * effects:   none 
+*/
+size_t fileFilter::skippedBySize() const {
+    return numBySize;
+}
+
+/*
+ * name:      skippedBinary 
+ * purpose:   gets the number of files skipped for being binary 
+ * arguments: none
+ * returns:   a size_t with the number of files 
+ * effects:   none 
+*/
+size_t fileFilter::skippedBinary() const {
+    return numBinary;
+}
+
+/*
+ * name:      skippedBytes 
+ * purpose:   gets the number of bytes in files skipped for their size or 
+ *            contents 
+ * arguments: none
+ * returns:   a size_t with the number of bytes 
+ * effects:   none 
+*/
+size_t fileFilter::skippedBytes() const {
+    return numBytes;
+}
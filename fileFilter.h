@@ -0,0 +1,85 @@
+/*
+ *  fileFilter.h
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  fileFilter is a class that decides which files are worth indexing. Files
+ *  and directories can be left out by name with include and exclude glob 
+ *  patterns (a pattern without a '/' is matched against the name, one with 
+ *  a '/' against the whole path), files can be left out by size, and the 
+ *  first SNIFF_BYTES of each file are checked so binary files (images, 
+ *  archives, object files) are not split into garbage words. A file is 
+ *  binary if its first block has a NUL byte, or if more than one byte in 
+ *  MAX_INVALID_FRACTION is part of a sequence that is not valid UTF-8 (so a 
+ *  text file with a few Latin-1 characters is still indexed). The check 
+ *  looks at eight bytes at a time and only decodes the words that have a 
+ *  byte outside of ASCII. The number of files and bytes skipped for each 
+ *  reason are counted for the build statistics. 
+ *
+*/
+
+#ifndef FILEFILTER_H
+#define FILEFILTER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class fileFilter {
+//public functions available to the client 
+public:
+    fileFilter();
+
+    //functions for setting the rules 
+    void include(const string &pattern);
+    void exclude(const string &pattern);
+    void setMaxBytes(size_t bytes);
+    void setSkipBinary(bool skip);
+
+    //functions for applying the rules 
+    bool wantsFile(const string &path, const string &name);
+    bool wantsDirectory(const string &path, const string &name);
+    bool wantsContents(int fd);
+    static bool looksBinary(const char *data, size_t length);
+
+    //the rules split up for files that are read some other way or checked
+    //again (such as by the watcher): the checks do not change the filter, 
+    //and the verdict is counted with record 
+    enum Verdict { WANTED, TOO_BIG, BINARY };
+    bool checkName(const string &path, const string &name) const;
+    Verdict checkContents(int fd, size_t &fileBytes) const;
+    Verdict checkSize(size_t fileBytes) const;
+    Verdict checkStart(const char *start, size_t length) const;
+    bool record(Verdict verdict, size_t fileBytes);
+
+    //functions for the number of files skipped for each reason 
+    size_t skippedByName() const;
+    size_t skippedDirectories() const;
+    size_t skippedBySize() const;
+    size_t skippedBinary() const;
+    size_t skippedBytes() const;
+
+    //bytes at the start of a file checked for binary contents, and the 
+    //fraction of them that may be in invalid UTF-8 sequences (1 / this) 
+    static const size_t SNIFF_BYTES = 4096;
+    static const size_t MAX_INVALID_FRACTION = 32;
+
+private:
+    //glob patterns, the largest file to index (0 for no limit), and whether
+    //binary files are skipped 
+    vector<string> includes;
+    vector<string> excludes;
+    size_t maxBytes;
+    bool skipBinary;
+
+    //number of files, directories, and bytes skipped 
+    size_t numByName, numDirectories, numBySize, numBinary, numBytes;
+
+    //helper function for matching a pattern 
+    static bool matches(const string &pattern, const string &path, 
+                        const string &name);
+};
+
+#endif
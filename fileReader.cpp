@@ -0,0 +1,751 @@
+/*
+ *  fileReader.cpp
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  Contains an implementation of the fileReader class. 
+ *
+*/
+
+#include "fileReader.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/sysmacros.h>
+
+const size_t fileReader::DEFAULT_DEPTH;
+const size_t fileReader::DEFAULT_BYTES;
+const size_t fileReader::FIRST_READ;
+const size_t fileReader::MAX_READ;
+const size_t fileReader::POOL_THREADS;
+
+//kinds of operation, kept in the low bits of each operation's tag with the 
+//number of its slot above them 
+enum { OP_STAT, OP_OPEN, OP_READ, OP_CLOSE, OP_BITS = 2 };
+
+/*
+ * name:      fileReader constructor 
+ * purpose:   sets up the ring, or the pool of threads if there is no ring 
+ * arguments: a size_t with the most files to keep in flight at once, a 
+ *            pointer to the fileFilter whose size and binary rules are 
+ *            applied (nullptr for none), a size_t with the most bytes to 
+ *            hold for their contents, and a bool, false to use the pool 
+ *            even if io_uring is available 
+ * returns:   none 
+ * effects:   sets up a ring with room for the operations of every file in 
+ *            flight, or starts POOL_THREADS threads if that fails. The 
+ *            filter must outlive the reader. 
+*/
+fileReader::fileReader(size_t depth, const fileFilter *rules, 
+                       size_t bytes, bool tryRing) : heldBytes(0) {
+    slots.resize(max(depth, (size_t) 1));
+    for (size_t i = 0; i < slots.size(); i++) {
+        slots[i].fd = -1;
+        slots[i].done = true;
+    }
+    head = tail = 0;
+    filter = rules;
+    maxBytes = bytes;
+
+    ringFd = -1;
+    sqMap = cqMap = nullptr;
+    sqes = nullptr;
+    toSubmit = 0;
+    inFlight = 0;
+    started = 0;
+    stopping = false;
+
+    //each file has at most its stat and open, or a read, on the ring, plus 
+    //the close of the file that had its slot before it 
+    if (tryRing and setupRing(slots.size() * 4)) {
+        return;
+    }
+
+    for (size_t i = 0; i < POOL_THREADS; i++) {
+        workers.push_back(thread(&fileReader::work, this));
+    }
+}
+
+/*
+ * name:      destructor 
+ * purpose:   stops reading 
+ * arguments: none 
+ * returns:   none 
+ * effects:   waits for every operation on the ring (or every file a thread 
+ *            has started) to finish, closes the files still open, and 
+ *            unmaps and closes the ring or stops the threads 
+*/
+fileReader::~fileReader() {
+    //the kernel may still write into the slots until their operations end 
+    if (ringFd >= 0) {
+        stopping = true;
+        while (inFlight > 0) {
+            enter(1);
+            reap();
+        }
+        for (size_t i = 0; i < slots.size(); i++) {
+            if (slots[i].fd >= 0) {
+                close(slots[i].fd);
+            }
+        }
+        munmap(sqes, sqesSize);
+        if (cqMap != sqMap) {
+            munmap(cqMap, cqMapSize);
+        }
+        munmap(sqMap, sqMapSize);
+        close(ringFd);
+        return;
+    }
+
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    room.notify_all();
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+}
+
+/*
+ * name:      full 
+ * purpose:   checks whether another file can be submitted 
+ * arguments: none 
+ * returns:   returns true if the depth's worth of files are in flight (or 
+ *            waiting to be handed back), false otherwise 
+ * effects:   none 
+*/
+bool fileReader::full() {
+    return tail - head == slots.size();
+}
+
+/*
+ * name:      submit 
+ * purpose:   starts reading a file given by its path 
+ * arguments: a string with the path of the file 
+ * returns:   none 
+ * effects:   submits the path relative to the working directory 
+*/
+void fileReader::submit(const string &path) {
+    submit(AT_FDCWD, path, path);
+}
+
+/*
+ * name:      submit 
+ * purpose:   starts reading a file given by its directory and name 
+ * arguments: an int with an open descriptor of the file's directory, a 
+ *            string with its name in that directory, and a string with its 
+ *            path (handed back with it) 
+ * returns:   none 
+ * effects:   queues the file's statx and openat, relative to the directory,
+ *            on the ring (they are sent to the kernel by the next call to 
+ *            next) or hands it to the pool. The directory must stay open 
+ *            until the file is handed back. Throws a runtime_error if the 
+ *            reader is full. 
+*/
+void fileReader::submit(int dirFd, const string &name, const string &path) {
+    if (full()) {
+        throw runtime_error("fileReader is full");
+    }
+
+    Slot &slot = slots[tail % slots.size()];
+    slot.dirFd = dirFd;
+    slot.name = name;
+    slot.file.path = path;
+    slot.file.contents.clear();
+    slot.file.size = 0;
+    slot.file.device = 0;
+    slot.file.inode = 0;
+    slot.file.opened = true;
+    slot.file.verdict = fileFilter::WANTED;
+    slot.fd = -1;
+    slot.sized = false;
+    slot.offset = 0;
+    slot.sniffed = false;
+    slot.reserved = 0;
+    slot.parked = false;
+    slot.done = false;
+
+    //the stat and open go on the ring together 
+    if (ringFd >= 0) {
+        uint64_t tag = (tail % slots.size()) << OP_BITS;
+        slot.waiting = 2;
+        queue(IORING_OP_STATX, dirFd, slot.name.c_str(), 
+              STATX_SIZE | STATX_INO, (uint64_t) (uintptr_t) &slot.info, 0,
+              tag | OP_STAT);
+        queue(IORING_OP_OPENAT, dirFd, slot.name.c_str(), 0, 0,
+              O_RDONLY | O_CLOEXEC, tag | OP_OPEN);
+        tail++;
+        return;
+    }
+
+    //or to the next free thread 
+    {
+        lock_guard<mutex> guard(lock);
+        tail++;
+    }
+    wake.notify_one();
+}
+
+/*
+ * name:      next 
+ * purpose:   gets the next file in the order they were submitted 
+ * arguments: a reference to a File to store it in 
+ * returns:   returns true if a file was stored, false if none are left 
+ * effects:   waits for the file to be read, sending queued operations to 
+ *            the kernel and handling completions (which starts the reads 
+ *            of the files behind it) in the meantime. Moves the contents 
+ *            out of the reader, and lets the files waiting for the room it 
+ *            held be read. 
+*/
+bool fileReader::next(File &file) {
+    if (head == tail) {
+        return false;
+    }
+    Slot &slot = slots[head % slots.size()];
+
+    //with a ring, handle completions until this file is done 
+    if (ringFd >= 0) {
+        while (not slot.done) {
+            enter(1);
+            reap();
+        }
+        reap();
+    }
+    //with the pool, wait for its thread 
+    else {
+        unique_lock<mutex> held(lock);
+        finished.wait(held, [&slot] { return slot.done; });
+    }
+
+    //the contents the client had are freed rather than kept by the slot 
+    file.path.swap(slot.file.path);
+    file.contents.swap(slot.file.contents);
+    string().swap(slot.file.contents);
+    file.size = slot.file.size;
+    file.device = slot.file.device;
+    file.inode = slot.file.inode;
+    file.opened = slot.file.opened;
+    file.verdict = slot.file.verdict;
+
+    //give back the file's room to the files behind it, and send the reads 
+    //queued so far so they go on while the file is used 
+    if (ringFd >= 0) {
+        release(slot);
+        head++;
+        resumeParked();
+        if (toSubmit > 0) {
+            enter(0);
+        }
+    } else {
+        {
+            lock_guard<mutex> guard(lock);
+            release(slot);
+            head++;
+        }
+        room.notify_all();
+    }
+    return true;
+}
+
+/*
+ * name:      usesRing 
+ * purpose:   checks which way files are read 
+ * arguments: none 
+ * returns:   returns true if files are read with io_uring, false if they 
+ *            are read by the pool of threads 
+ * effects:   none 
+*/
+bool fileReader::usesRing() {
+    return ringFd >= 0;
+}
+
+/*
+ * name:      beginReading 
+ * purpose:   starts reading a file that was opened 
+ * arguments: a reference to the slot of the file 
+ * returns:   returns true if the file should be read, false if it could 
+ *            not be opened or the filter does not want it 
+ * effects:   checks the size against the filter and hands back the 
+ *            device and inode with the file (if the stat worked) 
+*/
+bool fileReader::beginReading(Slot &slot) {
+    if (slot.fd < 0) {
+        slot.file.opened = false;
+        return false;
+    }
+
+    if (slot.sized) {
+        slot.file.size = slot.info.stx_size;
+        slot.file.device = makedev(slot.info.stx_dev_major, 
+                                   slot.info.stx_dev_minor);
+        slot.file.inode = slot.info.stx_ino;
+        if (filter != nullptr) {
+            slot.file.verdict = filter->checkSize(slot.file.size);
+        }
+        if (slot.file.verdict != fileFilter::WANTED) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * name:      reserve 
+ * purpose:   holds room for the contents of a file about to be read 
+ * arguments: a reference to the slot of the file 
+ * returns:   returns true if the room was held, false if the file has to 
+ *            wait for the files ahead of it to be handed back 
+ * effects:   makes room for the contents (the whole file if the size is 
+ *            known, FIRST_READ bytes otherwise) if they fit under maxBytes 
+ *            with the files already held, or if the file is the next one to 
+ *            hand back. Called with the lock held when the pool is used. 
+*/
+bool fileReader::reserve(Slot &slot) {
+    size_t bytes = slot.sized ? slot.file.size : FIRST_READ;
+    if (&slot != &slots[head % slots.size()] and 
+        heldBytes + bytes > maxBytes) {
+        return false;
+    }
+
+    heldBytes += bytes;
+    slot.reserved = bytes;
+    slot.file.contents.resize(bytes);
+    return true;
+}
+
+/*
+ * name:      release 
+ * purpose:   gives back the room held for a file's contents 
+ * arguments: a reference to the slot of the file 
+ * returns:   none 
+ * effects:   takes the slot's bytes off the bytes held. Called with the 
+ *            lock held when the pool is used. 
+*/
+void fileReader::release(Slot &slot) {
+    heldBytes -= slot.reserved;
+    slot.reserved = 0;
+}
+
+/*
+ * name:      nextReadLength 
+ * purpose:   finds how much of a file to read next 
+ * arguments: a reference to the slot of the file 
+ * returns:   a size_t with the number of bytes to read at the slot's 
+ *            offset, or 0 if the whole file has been read 
+ * effects:   the first read is at most FIRST_READ bytes, so a binary file 
+ *            is turned away before the rest of it is read, and no read is 
+ *            over MAX_READ bytes, since a read returns its length in an int.
+ *            Doubles the room for the contents of a file whose size is not 
+ *            known when it is full, adding to the bytes held. 
+*/
+size_t fileReader::nextReadLength(Slot &slot) {
+    string &contents = slot.file.contents;
+    if (slot.sized and slot.offset >= slot.file.size) {
+        return 0;
+    }
+    if (slot.offset == contents.size()) {
+        size_t grown = max(contents.size() * 2, FIRST_READ);
+        heldBytes += grown - slot.reserved;
+        slot.reserved = grown;
+        contents.resize(grown);
+    }
+
+    size_t length = min(contents.size() - slot.offset, MAX_READ);
+    if (not slot.sniffed) {
+        length = min(length, FIRST_READ);
+    }
+    return length;
+}
+
+/*
+ * name:      afterRead 
+ * purpose:   records the result of a read 
+ * arguments: a reference to the slot of the file and an ssize_t with the 
+ *            number of bytes read (0 at the end of the file, negative for 
+ *            an error) 
+ * returns:   returns true if there may be more of the file to read, false 
+ *            otherwise 
+ * effects:   moves the offset past the bytes read, and checks the first 
+ *            block of the file against the filter. An error ends the file 
+ *            where it is, like the end of the file. 
+*/
+bool fileReader::afterRead(Slot &slot, ssize_t bytes) {
+    if (bytes <= 0) {
+        return false;
+    }
+    slot.offset += bytes;
+
+    //check the first block for binary contents 
+    if (not slot.sniffed) {
+        slot.sniffed = true;
+        if (filter != nullptr) {
+            slot.file.verdict = filter->checkStart(slot.file.contents.data(),
+                                                   slot.offset);
+        }
+        if (slot.file.verdict != fileFilter::WANTED) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * name:      finishReading 
+ * purpose:   ends the reading of a file 
+ * arguments: a reference to the slot of the file 
+ * returns:   none 
+ * effects:   cuts the contents to the bytes read (or empties them if the 
+ *            file is not wanted), and records the size of a file whose size 
+ *            was not known. Does not close the file. 
+*/
+void fileReader::finishReading(Slot &slot) {
+    if (slot.file.verdict != fileFilter::WANTED or not slot.file.opened) {
+        string().swap(slot.file.contents);
+    } else {
+        slot.file.contents.resize(slot.offset);
+    }
+    if (not slot.sized) {
+        slot.file.size = slot.offset;
+    }
+}
+
+/*
+ * name:      setupRing 
+ * purpose:   sets up an io_uring instance 
+ * arguments: an unsigned with the number of entries to ask for 
+ * returns:   returns true if the ring is ready, false if io_uring is not 
+ *            available or the kernel is too old for the operations used 
+ * effects:   calls io_uring_setup and maps the submission queue, the 
+ *            completion queue, and the submission entries 
+*/
+bool fileReader::setupRing(unsigned entries) {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int fd = syscall(__NR_io_uring_setup, entries, &params);
+    if (fd < 0) {
+        return false;
+    }
+
+    //statx, openat and read on the ring came with 5.6, as did this feature 
+    if (not (params.features & IORING_FEAT_RW_CUR_POS) or
+        not (params.features & IORING_FEAT_NODROP)) {
+        close(fd);
+        return false;
+    }
+
+    //the two queues share one mapping on newer kernels 
+    sqMapSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqMapSize = params.cq_off.cqes +
+                params.cq_entries * sizeof(io_uring_cqe);
+    bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single) {
+        sqMapSize = cqMapSize = max(sqMapSize, cqMapSize);
+    }
+
+    sqMap = mmap(nullptr, sqMapSize, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    cqMap = single ? sqMap :
+            mmap(nullptr, cqMapSize, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    void *sqeMap = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+
+    //give up on the ring if any of it could not be mapped 
+    if (sqMap == MAP_FAILED or cqMap == MAP_FAILED or sqeMap == MAP_FAILED) {
+        if (sqeMap != MAP_FAILED) {
+            munmap(sqeMap, sqesSize);
+        }
+        if (cqMap != MAP_FAILED and cqMap != sqMap) {
+            munmap(cqMap, cqMapSize);
+        }
+        if (sqMap != MAP_FAILED) {
+            munmap(sqMap, sqMapSize);
+        }
+        sqMap = cqMap = nullptr;
+        close(fd);
+        return false;
+    }
+
+    //find the parts of the queues 
+    char *sq = (char *) sqMap, *cq = (char *) cqMap;
+    sqHead = (unsigned *) (sq + params.sq_off.head);
+    sqTail = (unsigned *) (sq + params.sq_off.tail);
+    sqMask = *(unsigned *) (sq + params.sq_off.ring_mask);
+    sqArray = (unsigned *) (sq + params.sq_off.array);
+    sqEntries = params.sq_entries;
+    cqHead = (unsigned *) (cq + params.cq_off.head);
+    cqTail = (unsigned *) (cq + params.cq_off.tail);
+    cqMask = *(unsigned *) (cq + params.cq_off.ring_mask);
+    cqes = (io_uring_cqe *) (cq + params.cq_off.cqes);
+    sqes = (io_uring_sqe *) sqeMap;
+
+    ringFd = fd;
+    return true;
+}
+
+/*
+ * name:      queue 
+ * purpose:   adds an operation to the submission queue 
+ * arguments: the operation's opcode, file descriptor, address, length, 
+ *            offset and flags (the meaning of each depends on the opcode), 
+ *            and a tag with its slot and kind for its completion 
+ * returns:   none 
+ * effects:   fills the next submission entry and publishes it to the 
+ *            kernel, sending the queue first if it is full. The operation 
+ *            is sent by the next call to enter. 
+*/
+void fileReader::queue(uint8_t opcode, int fd, const void *addr,
+                       size_t length, uint64_t offset, uint32_t flags,
+                       uint64_t tag) {
+    unsigned sqTailValue = *sqTail;
+    if (sqTailValue - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) ==
+        sqEntries) {
+        enter(0);
+    }
+
+    unsigned index = sqTailValue & sqMask;
+    io_uring_sqe &entry = sqes[index];
+    memset(&entry, 0, sizeof(entry));
+    entry.opcode = opcode;
+    entry.fd = fd;
+    entry.addr = (uint64_t) (uintptr_t) addr;
+    entry.len = length;
+    entry.off = offset;
+    entry.open_flags = flags;
+    entry.user_data = tag;
+    sqArray[index] = index;
+
+    //the entry must be written before the kernel can see the new tail 
+    __atomic_store_n(sqTail, sqTailValue + 1, __ATOMIC_RELEASE);
+    toSubmit++;
+    inFlight++;
+}
+
+/*
+ * name:      enter 
+ * purpose:   sends the queued operations and waits for completions 
+ * arguments: an unsigned with the number of completions to wait for 
+ * returns:   none 
+ * effects:   calls io_uring_enter until every queued operation was taken by 
+ *            the kernel. Throws a runtime_error if the call fails. 
+*/
+void fileReader::enter(unsigned minComplete) {
+    do {
+        unsigned flags = minComplete > 0 ? IORING_ENTER_GETEVENTS : 0;
+        int sent = syscall(__NR_io_uring_enter, ringFd, toSubmit,
+                           minComplete, flags, nullptr, 0);
+        if (sent < 0) {
+            if (errno == EINTR or errno == EAGAIN or errno == EBUSY) {
+                continue;
+            }
+            throw runtime_error(string("io_uring_enter: ") +
+                                strerror(errno));
+        }
+        toSubmit -= sent;
+        minComplete = 0;
+    } while (toSubmit > 0);
+}
+
+/*
+ * name:      reap 
+ * purpose:   handles the completions the kernel has posted 
+ * arguments: none 
+ * returns:   none 
+ * effects:   calls complete for each new entry of the completion queue and 
+ *            then hands the entries back to the kernel 
+*/
+void fileReader::reap() {
+    unsigned cqHeadValue = *cqHead;
+    unsigned cqTailValue = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+
+    while (cqHeadValue != cqTailValue) {
+        const io_uring_cqe &entry = cqes[cqHeadValue & cqMask];
+        cqHeadValue++;
+        inFlight--;
+        complete(entry.user_data, entry.res);
+    }
+    __atomic_store_n(cqHead, cqHeadValue, __ATOMIC_RELEASE);
+}
+
+/*
+ * name:      complete 
+ * purpose:   moves a file on once one of its operations is done 
+ * arguments: a uint64_t with the operation's tag and an int with its result 
+ *            (a negative errno on failure) 
+ * returns:   none 
+ * effects:   records the stat and the open, and once both are done starts 
+ *            the reads (or parks the file if there is no room for it yet); 
+ *            queues the next read after each one, or ends the file once it 
+ *            has all been read (or the reader is being destroyed) 
+*/
+void fileReader::complete(uint64_t tag, int result) {
+    int kind = tag & ((1 << OP_BITS) - 1);
+    if (kind == OP_CLOSE) {
+        return;
+    }
+    Slot &slot = slots[tag >> OP_BITS];
+
+    //the stat and open may come back in either order 
+    if (kind == OP_STAT or kind == OP_OPEN) {
+        if (kind == OP_STAT) {
+            slot.sized = result >= 0;
+        } else {
+            slot.fd = result;
+        }
+        if (--slot.waiting > 0) {
+            return;
+        }
+        if (beginReading(slot)) {
+            if (not reserve(slot)) {
+                slot.parked = true;
+                return;
+            }
+            if (queueRead(slot)) {
+                return;
+            }
+        }
+    }
+    //the next read, unless the file is finished 
+    else if (afterRead(slot, result) and queueRead(slot)) {
+        return;
+    }
+
+    endFile(slot);
+}
+
+/*
+ * name:      queueRead 
+ * purpose:   queues the next read of a file 
+ * arguments: a reference to the slot of the file 
+ * returns:   returns true if a read was queued, false if the file has all 
+ *            been read or the reader is being destroyed 
+ * effects:   queues a read into the contents at the slot's offset 
+*/
+bool fileReader::queueRead(Slot &slot) {
+    size_t length = nextReadLength(slot);
+    if (length == 0 or stopping) {
+        return false;
+    }
+
+    uint64_t tag = (&slot - slots.data()) << OP_BITS;
+    queue(IORING_OP_READ, slot.fd, &slot.file.contents[slot.offset], length,
+          slot.offset, 0, tag | OP_READ);
+    return true;
+}
+
+/*
+ * name:      endFile 
+ * purpose:   finishes a file read with the ring 
+ * arguments: a reference to the slot of the file 
+ * returns:   none 
+ * effects:   cuts the contents to the bytes read, queues the file's close, 
+ *            and marks it done 
+*/
+void fileReader::endFile(Slot &slot) {
+    finishReading(slot);
+    if (slot.fd >= 0) {
+        uint64_t tag = (&slot - slots.data()) << OP_BITS;
+        queue(IORING_OP_CLOSE, slot.fd, nullptr, 0, 0, 0, tag | OP_CLOSE);
+        slot.fd = -1;
+    }
+    slot.done = true;
+}
+
+/*
+ * name:      resumeParked 
+ * purpose:   starts reading the files that were waiting for room 
+ * arguments: none 
+ * returns:   none 
+ * effects:   goes through the files in flight in order, queueing the first 
+ *            read of each parked file that now fits, and stops at the first 
+ *            one that does not, so the files are read in order 
+*/
+void fileReader::resumeParked() {
+    for (size_t i = head; i < tail; i++) {
+        Slot &slot = slots[i % slots.size()];
+        if (not slot.parked) {
+            continue;
+        }
+        if (not reserve(slot)) {
+            return;
+        }
+        slot.parked = false;
+        if (not queueRead(slot)) {
+            endFile(slot);
+        }
+    }
+}
+
+/*
+ * name:      work 
+ * purpose:   reads files on a thread of the pool 
+ * arguments: none 
+ * returns:   none 
+ * effects:   waits for a submitted file that no thread has started, reads 
+ *            it, and signals that it is done, until the reader is destroyed 
+*/
+void fileReader::work() {
+    unique_lock<mutex> held(lock);
+    while (true) {
+        wake.wait(held, [this] { return stopping or started < tail; });
+        if (stopping) {
+            return;
+        }
+
+        Slot &slot = slots[started++ % slots.size()];
+        held.unlock();
+        readBlocking(slot);
+        held.lock();
+        slot.done = true;
+        finished.notify_all();
+    }
+}
+
+/*
+ * name:      readBlocking 
+ * purpose:   reads a file with blocking calls 
+ * arguments: a reference to the slot of the file 
+ * returns:   none 
+ * effects:   opens the file relative to its directory, finds its size, 
+ *            device and inode with fstat, waits for room for it, reads it 
+ *            with pread the same way the ring would, and closes it 
+*/
+void fileReader::readBlocking(Slot &slot) {
+    slot.fd = openat(slot.dirFd, slot.name.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat info;
+    if (slot.fd >= 0 and fstat(slot.fd, &info) == 0) {
+        slot.sized = true;
+        slot.info.stx_size = info.st_size;
+        slot.info.stx_dev_major = major(info.st_dev);
+        slot.info.stx_dev_minor = minor(info.st_dev);
+        slot.info.stx_ino = info.st_ino;
+    }
+
+    bool reading = beginReading(slot);
+    if (reading) {
+        unique_lock<mutex> held(lock);
+        room.wait(held, [this, &slot] { return stopping or reserve(slot); });
+        reading = not stopping;
+    }
+    if (reading) {
+        size_t length;
+        while ((length = nextReadLength(slot)) > 0 and
+               afterRead(slot, pread(slot.fd, &slot.file.contents[slot.offset],
+                                     length, slot.offset))) {
+        }
+    }
+
+    finishReading(slot);
+    if (slot.fd >= 0) {
+        close(slot.fd);
+        slot.fd = -1;
+    }
+}
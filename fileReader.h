@@ -0,0 +1,163 @@
+/*
+ *  fileReader.h
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  fileReader is a class that reads whole files ahead of the code that uses 
+ *  them. The client submits files (by path, or by an open descriptor of 
+ *  their directory and their name), up to a fixed depth of them at a time, 
+ *  and gets the files back whole in the order they were submitted, while 
+ *  the files behind them are still being opened and read. On Linux kernels 
+ *  with io_uring (5.6 or later), each file's statx and openat are queued on 
+ *  a ring together, followed by its reads and close, so many files are in 
+ *  flight with a single system call per batch and no extra threads of our 
+ *  own. The ring is set up with the raw system calls, so no library is 
+ *  needed. Where io_uring is not available (or not allowed), a small pool 
+ *  of threads reads the files with ordinary blocking calls instead. Either 
+ *  way, the size limit and binary check of a fileFilter are applied as each 
+ *  file is read: a file over the limit is never read, and a binary file is 
+ *  not read past its first block. The files in flight are also kept under 
+ *  a number of bytes: a file that does not fit waits, once its size is 
+ *  known, until the files ahead of it are handed back (the next file to 
+ *  hand back is always read, however big it is). 
+ *
+*/
+
+#ifndef FILEREADER_H
+#define FILEREADER_H
+
+#include "fileFilter.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/stat.h>
+#include <linux/io_uring.h>
+
+using namespace std;
+
+class fileReader {
+//public functions available to the client 
+public:
+    // 
+    //  File struct, used to hand back a file that was read: its path, its 
+    //  contents, its size in bytes, its device and inode (0 if they are not 
+    //  known), whether it could be opened, and the filter's verdict on it 
+    //  (the contents are empty unless it is WANTED) 
+    // 
+    struct File {
+        string path;
+        string contents;
+        size_t size;
+        dev_t device;
+        ino_t inode;
+        bool opened;
+        fileFilter::Verdict verdict;
+    };
+
+    fileReader(size_t depth, const fileFilter *rules, 
+               size_t maxBytes = DEFAULT_BYTES, bool tryRing = true);
+    ~fileReader();
+
+    bool full();
+    void submit(const string &path);
+    void submit(int dirFd, const string &name, const string &path);
+    bool next(File &file);
+    bool usesRing();
+
+    //number of files and bytes kept in flight by default, bytes read from 
+    //a file before its contents are checked, the most bytes one read asks 
+    //for, and threads in the fallback pool 
+    static const size_t DEFAULT_DEPTH = 64;
+    static const size_t DEFAULT_BYTES = 64 << 20;
+    static const size_t FIRST_READ = 65536;
+    static const size_t MAX_READ = 1 << 30;
+    static const size_t POOL_THREADS = 8;
+
+private:
+    // 
+    //  Slot struct, used to store a file being read: its directory's file 
+    //  descriptor and its name to open it by, the file handed back, its 
+    //  file descriptor, its statx results, whether its size is known, 
+    //  how many bytes have been read, whether its first block has been 
+    //  checked, how many of its open and stat operations are still on the 
+    //  ring, the bytes held for its contents, whether it is waiting for 
+    //  room to be read, and whether it is ready to be handed back 
+    // 
+    struct Slot {
+        int dirFd;
+        string name;
+        File file;
+        int fd;
+        struct statx info;
+        bool sized;
+        size_t offset;
+        bool sniffed;
+        int waiting;
+        size_t reserved;
+        bool parked;
+        bool done;
+    };
+
+    //files being read, used as a circle: head is the number of the next 
+    //file to hand back and tail the number of the next file submitted 
+    vector<Slot> slots;
+    size_t head, tail;
+    const fileFilter *filter;
+
+    //the most bytes held for the contents of the files in flight, and the 
+    //bytes held now (added to by the pool's threads as files grow) 
+    size_t maxBytes;
+    atomic<size_t> heldBytes;
+
+    //the ring: its file descriptor, its mapped memory and the parts of it 
+    //that are used, the operations queued but not yet submitted, and the 
+    //operations submitted but not yet completed 
+    int ringFd;
+    void *sqMap, *cqMap;
+    size_t sqMapSize, cqMapSize, sqesSize;
+    io_uring_sqe *sqes;
+    io_uring_cqe *cqes;
+    unsigned *sqHead, *sqTail, *sqArray, *cqHead, *cqTail;
+    unsigned sqMask, cqMask, sqEntries;
+    unsigned toSubmit;
+    size_t inFlight;
+
+    //the fallback pool: its threads, the number of the next file for a 
+    //thread to start, and the lock and signals for handing out files 
+    vector<thread> workers;
+    size_t started;
+    bool stopping;
+    mutex lock;
+    condition_variable wake;
+    condition_variable finished;
+    condition_variable room;
+
+    //helper functions for reading a file, used by both ways of reading 
+    bool beginReading(Slot &slot);
+    bool reserve(Slot &slot);
+    void release(Slot &slot);
+    size_t nextReadLength(Slot &slot);
+    bool afterRead(Slot &slot, ssize_t bytes);
+    void finishReading(Slot &slot);
+
+    //helper functions for the ring 
+    bool setupRing(unsigned entries);
+    void queue(uint8_t opcode, int fd, const void *addr, size_t length,
+               uint64_t offset, uint32_t flags, uint64_t tag);
+    void enter(unsigned minComplete);
+    void reap();
+    void complete(uint64_t tag, int result);
+    bool queueRead(Slot &slot);
+    void endFile(Slot &slot);
+    void resumeParked();
+
+    //helper functions for the pool 
+    void work();
+    void readBlocking(Slot &slot);
+};
+
+#endif
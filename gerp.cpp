@@ -12,29 +12,77 @@
 /*
  * name:      gerp constructor 
  * purpose:   initializes variables for the gerp class 
- * arguments: a string with the name of a directory to index and a string with
- *            the name of the initial output file 
+ * arguments: a string with the name of a directory to index, a string with
+ *            the name of the initial output file, and the optional parts of
+ *            the index to build 
  * returns:   none 
  * effects:   opens the output file and stores initial information about that
- *            file (it's name and line we are at in the file, 0) in correspond-
- *            ing variables. Builds a file tree with the given input directory
- *            and calls treeTraversal to build the index of words in that 
- *            directory. 
+ *            file (it's name) in corresponding variables. Calls buildIndex 
+ *            to build the index of words in the given input directory. 
+ *            Starts one thread per core for rendering query results. 
 */
-gerp::gerp(string directory, string outputFile) {
+gerp::gerp(string directory, string outputFile, gerpOptions indexOptions) 
+    : options(indexOptions), pool(thread::hardware_concurrency()) {
     //open the given output file and update output file information variables 
     open_or_die(output, outputFile);
     curr_output = outputFile;
-    outputLine = 0;
+    writer = resultWriter(options.format);
 
-    //build the file tree using the given input directory
-    FSTree tree(directory);
+    //set which files are indexed 
+    for (size_t i = 0; i < options.includes.size(); i++) {
+        fileRules.include(options.includes[i]);
+    }
+    for (size_t i = 0; i < options.excludes.size(); i++) {
+        fileRules.exclude(options.excludes[i]);
+    }
+    fileRules.setMaxBytes(options.maxFileBytes);
+    fileRules.setSkipBinary(not options.indexBinary);
+
+    //substring searches read their candidate lines through the line offsets
+    if (options.trigrams) {
+        options.lineOffsets = true;
+    }
+
+    //print every result of a query in file order until told otherwise 
+    pageSize = 0;
+    currentPage = 0;
+    rankFiles = false;
+    contextLines = 0;
+    timeoutMs = options.timeoutMs;
+    maxResults = options.maxResults;
+    numDead = 0;
+    inodesKnown = 0;
+    numAliases = 0;
+    copiesCounted = true;
+    baseLookups = filterRejects = 0;
+    readWithRing = false;
+    clearScope();
+
+    //map a saved index, or walk the given input directory to build the 
+    //index (on disk if it is to be saved) 
+    if (not options.loadIndex.empty()) {
+        loadShared(directory);
+    } else {
+        if (not options.saveIndex.empty() and options.memoryBudget == 0) {
+            options.memoryBudget = SAVE_BUDGET;
+        }
+        buildIndex(directory);
+    }
 
-    //create string to contain the name of the root 
-    string pathString = tree.getRoot()->getName();
+    //start reading the most common words of an index file 
+    if (options.prefetch) {
+        disk.prefetchHot();
+    }
+
+    //write the statistics of every word before any file changes 
+    if (not options.dumpVocab.empty()) {
+        dumpVocab(options.dumpVocab);
+    }
 
-    //traverse the tree to build the index 
-    treeTraversal(tree.getRoot(), pathString);
+    //follow the files as they change from now on 
+    if (options.watch) {
+        startWatching();
+    }
 }
 
 /*
@@ -43,10 +91,38 @@ gerp::gerp(string directory, string outputFile) {
  * arguments: none
  * returns:   none 
  * effects:   deletes an memory that was used in the gerp class once the 
- *            program is finished 
+ *            program is finished. Stops watching first, so no change is 
+ *            applied while the index is being destroyed. 
 */
 gerp::~gerp() { 
+    watcher.stop();
+}
+
+/*
+ * name:      parseCount 
+ * purpose:   reads a count given with a command 
+ * arguments: a reference to a string with the count and a reference to a 
+ *            size_t to store it in 
+ * returns:   a bool, true if the string is a number that fits in a size_t 
+ * effects:   sets count only if the string is a number 
+*/
+static bool parseCount(const string &text, size_t &count) {
+    //only digits, so the signs and spaces strtoull skips are not taken 
+    if (text.empty() or text.find_first_not_of("0123456789") != 
+                        string::npos) {
+        return false;
+    }
+
+    //and no more than fit in a size_t 
+    errno = 0;
+    char *end = nullptr;
+    unsigned long long value = strtoull(text.c_str(), &end, 10);
+    if (errno == ERANGE or *end != '\0' or value > SIZE_MAX) {
+        return false;
+    }
 
+    count = value;
+    return true;
 }
 
 /*
@@ -59,7 +135,8 @@ gerp::~gerp() {
  *            helper functions to handle those queries. Updates any variables
  *            needed to conduct those queries. Continues to accept input from
  *            the client until the commands for quiting the program (@q and 
- *            @quit) are produced 
+ *            @quit) are produced. Each command is bounded by the time and 
+ *            results a query may take, and can be cancelled while it runs. 
 */
 void gerp::handleQuery(istream &input) {
     //string to contain commands and queries
@@ -71,29 +148,261 @@ void gerp::handleQuery(istream &input) {
         cout << "Query? ";
         input >> command;
 
+        //bound the query by the time and results it may take 
+        budget.start(timeoutMs, maxResults);
+
+        //if command limits the query to a directory, find the directory's 
+        //files and read the query that follows 
+        if (command == "@in") {
+            input >> query;
+            setScope(query);
+            input >> command;
+        }
+
         //if command is for insensitive, get query and handle it 
         if (command == "@i" or command == "@insensitive") {
             input >> query;
-            insensitive = true;
             string stripped = stripNonAlphaNum(query);
-            printInsensitive(stripped);
+            runQuery<InsensitiveCase, ResultsMode>(stripped);
         }
-        //if command is for new output file, get query and handle it 
+        //if command is for new output file, get its format (if one is 
+        //given, otherwise the one chosen at the start) and name and open it
         else if (command == "@f") {
+            resultWriter::Format format = options.format;
             input >> query;
-            newOutput(query);
+            if (query.length() > 1 and query[0] == '@' and 
+                resultWriter::parseFormat(query.substr(1), format)) {
+                input >> query;
+            }
+            newOutput(query, format);
         } 
+        //if command sets the page size, get it and store it 
+        else if (command == "@limit") {
+            input >> query;
+            if (not parseCount(query, pageSize)) {
+                printMessage("Usage: @limit N\n");
+            }
+        }
+        //if command bounds the time or results of each query, store it 
+        else if (command == "@timeout") {
+            input >> query;
+            if (not parseCount(query, timeoutMs)) {
+                printMessage("Usage: @timeout ms\n");
+            }
+        }
+        else if (command == "@max") {
+            input >> query;
+            if (not parseCount(query, maxResults)) {
+                printMessage("Usage: @max N\n");
+            }
+        }
+        //if command is for a page of the last query, get it and print it 
+        else if (command == "@page") {
+            size_t page = 0;
+            input >> query;
+            if (parseCount(query, page)) {
+                gotoPage(page);
+            } else {
+                printMessage("Usage: @page k\n");
+            }
+        }
+        else if (command == "@more") {
+            gotoPage(currentPage + 1);
+        }
+        //if command is for a count or list of files, get the (optionally 
+        //insensitive) query and answer it from the index alone 
+        else if (command == "@count" or command == "@files") {
+            bool insensitive = false;
+            input >> query;
+            if (query == "@i" or query == "@insensitive") {
+                insensitive = true;
+                input >> query;
+            }
+
+            string stripped = stripNonAlphaNum(query);
+            if (command == "@count" and insensitive) {
+                runQuery<InsensitiveCase, CountMode>(stripped);
+            } else if (command == "@count") {
+                runQuery<SensitiveCase, CountMode>(stripped);
+            } else if (insensitive) {
+                runQuery<InsensitiveCase, FilesMode>(stripped);
+            } else {
+                runQuery<SensitiveCase, FilesMode>(stripped);
+            }
+        }
+        //if command is for the lines around a word, get the number of lines
+        //and the (optionally insensitive) query and print each location 
+        //with that many lines before and after it 
+        else if (command == "@ctx") {
+            bool insensitive = false, counted = false;
+            input >> query;
+            counted = parseCount(query, contextLines);
+            input >> query;
+            if (query == "@i" or query == "@insensitive") {
+                insensitive = true;
+                input >> query;
+            }
+
+            string stripped = stripNonAlphaNum(query);
+            if (not counted) {
+                printMessage("Usage: @ctx N [@i] word\n");
+            } else if (insensitive) {
+                runQuery<InsensitiveCase, ContextMode>(stripped);
+            } else {
+                runQuery<SensitiveCase, ContextMode>(stripped);
+            }
+        }
+        //if command is for a substring or regular expression, get the 
+        //(optionally insensitive) pattern and search every line for it 
+        else if (command == "@sub" or command == "@re") {
+            bool insensitive = false;
+            input >> query;
+            if (query == "@i" or query == "@insensitive") {
+                insensitive = true;
+                input >> query;
+            }
+            printMatches(query, command == "@re", insensitive);
+        }
+        //if command is for adding files, index them into a new segment 
+        else if (command == "@add") {
+            input >> query;
+            addFiles(query);
+        }
+        //if command is for the statistics of a word (or of the most 
+        //frequent words), print them from the index 
+        else if (command == "@stats") {
+            input >> query;
+            if (query == "@top") {
+                printTopKeys();
+            } else {
+                string stripped = stripNonAlphaNum(query);
+                printStats(stripped);
+            }
+        }
+        //if command is for ranking files, toggle it for the next queries 
+        else if (command == "@rank") {
+            rankFiles = not rankFiles;
+        }
         //if command is for any word, handle it 
         else if (command != "@q" and command != "@quit") {
-            insensitive = false;
             string sensitive_stripped = stripNonAlphaNum(command);
-            printSensitive(sensitive_stripped);
+            runQuery<SensitiveCase, ResultsMode>(sensitive_stripped);
         }
+
+        //the directory and the bounds only apply to one query 
+        clearScope();
+        budget.finish();
     }
     //close current output file once client quits program
     output.close();
 }
 
+/*
+ * name:      printDiagnostics 
+ * purpose:   prints an occupancy and memory report of the index 
+ * arguments: an output stream to print the report to 
+ * returns:   none 
+ * effects:   prints the number of indexed files and directories and the 
+ *            bytes used by their paths (and the line offsets and trigrams,
+ *            if they were built), followed by the hashTable's diagnostics 
+ *            report, or the size of the index file if it was built on disk
+*/
+void gerp::printDiagnostics(ostream &out) {
+    lock_guard<mutex> guard(indexLock);
+
+    //count the bytes held by the file paths vector 
+    out << "files: " << paths.size() << " in " << paths.numDirectories() 
+        << " directories\n";
+    out << "file path bytes: " << paths.bytes() << "\n";
+    out << "file reads: " << (readWithRing ? "io_uring" : "thread pool") 
+        << ", " << fileReader::DEFAULT_DEPTH << " files in flight\n";
+    if (options.lineOffsets) {
+        out << "line offset bytes: " << lineStarts.bytes() << "\n";
+    }
+    if (options.trigrams) {
+        out << "trigrams: " << trigrams.numTrigrams() << ", " 
+            << trigrams.bytes() << " bytes\n";
+    }
+
+    //lookups turned away by the filter 
+    out << "word filter: " << filter.bytes() << " bytes, " << filterRejects
+        << " of " << baseLookups << " lookups answered by the filter\n";
+
+    //files with the same contents as an earlier file 
+    if (numAliases > 0) {
+        out << "duplicate files: " << numAliases << " copies of " 
+            << aliases.size() << " files\n";
+    }
+
+    //common words stored as bitmaps 
+    if (not denseWords.empty()) {
+        size_t lines = 0, bytes = 0;
+        unordered_map<const WordLocations *, roaringBitmap>::iterator it;
+        for (it = denseWords.begin(); it != denseWords.end(); ++it) {
+            lines += it->second.cardinality();
+            bytes += it->second.bytes();
+        }
+        out << "dense words: " << denseWords.size() << ", " << lines 
+            << " lines in bitmaps, " << bytes << " bytes\n";
+    }
+
+    //segments of files added since the start 
+    vector<shared_ptr<const indexSegment>> current = segments.snapshot();
+    if (not current.empty()) {
+        size_t locations = 0, bytes = 0;
+        for (size_t i = 0; i < current.size(); i++) {
+            locations += current[i]->numLocations();
+            bytes += current[i]->bytes();
+        }
+        out << "added segments: " << current.size() << ", " << locations 
+            << " locations, " << bytes << " bytes, " 
+            << segments.numCompactions() << " merges\n";
+    }
+
+    //files left out by the file rules 
+    out << "skipped: " << fileRules.skippedByName() << " files and " 
+        << fileRules.skippedDirectories() << " directories by name, " 
+        << fileRules.skippedBySize() << " files by size, " 
+        << fileRules.skippedBinary() << " binary files (" 
+        << fileRules.skippedBytes() << " bytes)\n";
+
+    //files replaced or deleted while watching 
+    if (options.watch) {
+        out << "watched changes: " << watcher.numBatches() << " batches, " 
+            << numDead << " files replaced or deleted\n";
+    }
+
+    //an index built on disk reports its file instead of the table 
+    if (disk.isOpen()) {
+        if (shared.isOpen()) {
+            out << "shared index: " << options.loadIndex << ", " 
+                << shared.bytes() << " bytes mapped\n";
+        } else {
+            out << "memory budget: " << builder.budget() << " bytes, " 
+                << builder.numRuns() << " runs\n";
+        }
+        out << "index file: " << disk.numKeys() << " keys, " 
+            << disk.numWords() << " words, " << disk.numLocations() 
+            << " locations, " << disk.bytes() << " bytes\n";
+        return;
+    }
+
+    //the locations of dense words are counted from their bitmaps, and the 
+    //bitmaps' bytes are part of the table's 
+    table.printDiagnostics(out, [this](const WordLocations &entry) {
+        unordered_map<const WordLocations *, roaringBitmap>::const_iterator
+            dense = denseWords.find(&entry);
+        if (dense != denseWords.end()) {
+            return dense->second.cardinality();
+        }
+        return entry.location.size();
+    }, [this](const WordLocations &entry) {
+        unordered_map<const WordLocations *, roaringBitmap>::const_iterator
+            dense = denseWords.find(&entry);
+        return dense != denseWords.end() ? dense->second.bytes() : 0;
+    });
+}
+
 /*
  * name:      open_file
  * purpose:   opens the file with provided file name with the provided stream
@@ -114,254 +423,2350 @@ void gerp::open_or_die(streamtype &stream, string &fileName) {
 }
 
 /*
- * name:      treeTraversal 
+ * name:      buildIndex 
  * purpose:   reads through all of the files in the directory 
- * arguments: a DirNode with the current directory and a reference to a string
- *            containing the path 
+ * arguments: a reference to a string with the directory to index 
  * returns:   none 
- * effects:   traverses the tree and adds names of directories to the given 
- *            path. Once files are reached, build the name of the current path 
- *            and each file and updates the index for the new file
+ * effects:   walks the directory depth first (the files of a directory, then
+ *            each subdirectory) and indexes the files in the order the walk
+ *            reaches them, storing each one's directory and name in the path
+ *            table. A fileReader keeps the next files being opened (relative
+ *            to their directories) and read (with io_uring where it can) 
+ *            while each file is indexed, so the walker leaves marking the 
+ *            range of files under each directory in the path table, and 
+ *            closing the directory, to us once the files before it are 
+ *            added. 
+ *            Files left out by the file rules (by name, size, or binary 
+ *            contents) are skipped and counted. 
+ *            With a memory budget, the words are written to runs on disk 
+ *            and merged into an index file that is then mapped for queries.
+ *            Throws a runtime_error if the directory or one of its files 
+ *            cannot be opened, or the index file cannot be written. 
 */
-void gerp::treeTraversal(DirNode *root, string &path) {
-    //print out path if directory is empty
-    if (root->isEmpty()) {
-        return;
+void gerp::buildIndex(string &directory) {
+    dirWalker walker(directory, paths);
+    walker.setFilter(&fileRules);
+    walker.deferRanges(true);
+    size_t readBytes = fileReader::DEFAULT_BYTES;
+    if (options.memoryBudget > 0) {
+        readBytes = min(readBytes, options.memoryBudget / 4);
+    }
+    fileReader reader(fileReader::DEFAULT_DEPTH, &fileRules, readBytes);
+    readWithRing = reader.usesRing();
+
+    //with a memory budget, words go to the builder instead of the table 
+    if (options.memoryBudget > 0) {
+        builder.start(options.memoryBudget, options.tempDirectory);
+    }
+
+    //add each file to the path table and insert its words into table, 
+    //numbering the lines of all the files one after another 
+    lineIdStarts.assign(1, 0);
+    deque<WalkedFile> walked;
+    WalkedFile last;
+    bool walking = true;
+    fileReader::File file;
+    while (true) {
+        //keep the reader full of the next files of the walk 
+        while (walking and not reader.full()) {
+            walking = walker.next();
+            if (walking) {
+                walked.push_back(WalkedFile());
+            }
+            WalkedFile &entry = walking ? walked.back() : last;
+            entry.startedBefore.swap(walker.startedDirectories());
+            entry.finishedBefore.swap(walker.finishedDirectories());
+            entry.releasedBefore.swap(walker.releasedDescriptors());
+            if (walking) {
+                entry.directory = walker.directory();
+                entry.name = walker.name();
+                reader.submit(walker.directoryFd(), walker.name(), 
+                              walker.path());
+            }
+        }
+
+        //index the next file once it has been read 
+        if (not reader.next(file)) {
+            break;
+        }
+        WalkedFile &current = walked.front();
+        markRanges(current);
+        if (not file.opened) {
+            throw runtime_error("Unable to open file " + file.path);
+        }
+        if (fileRules.record(file.verdict, file.size)) {
+            size_t index = paths.addFile(current.directory, current.name);
+            size_t lines = indexWords(file.contents, index, nullptr);
+            lineIdStarts.push_back(lineIdStarts.back() + lines);
+            if (file.inode != 0) {
+                fileInodes[make_pair(file.device, file.inode)] = index;
+            }
+        }
+        walked.pop_front();
     }
+    markRanges(last);
+    inodesKnown = paths.size();
 
-    //finish the paths for the files in the directory, insert words into table
-    for (int i = 0; i < root->numFiles(); i++) {
-        filepaths.push_back(path + "/" + root->getFile(i));
-        readWords(filepaths.back(), filepaths.size() - 1);
+    //merge the builder's runs and answer queries from the index file 
+    string indexFile;
+    if (options.memoryBudget > 0) {
+        indexFile = builder.finish();
+        disk.open(indexFile);
     }
 
-    //traverse each subdirectory 
-    for (int i = 0; i < root->numSubDirs(); i++) {
-        string temp = path + "/" + root->getSubDir(i)->getName();
-        treeTraversal(root->getSubDir(i), temp);
+    //the hashes are only needed while the directory is read 
+    unordered_map<uint64_t, size_t>().swap(contentFiles);
+
+    buildFilter();
+    if (not disk.isOpen()) {
+        buildDenseWords();
+    }
+    if (not options.saveIndex.empty()) {
+        saveShared(indexFile);
     }
 }
 
 /*
- * name:      readWords
- * purpose:   adds the words in the given output file to the index
- * arguments: a string with the name of a file in the directory and that file's
- *            index in the vector of file paths 
+ * name:      saveShared 
+ * purpose:   saves the index for other processes to map 
+ * arguments: a string with the path of the index file built on disk 
  * returns:   none 
- * effects:   opens the given file and adds all of the words in that file to
- *            the hashTable index using the table's insert function
+ * effects:   writes the index file, the path table, the copies of each 
+ *            file with the same contents as an earlier one, and the filter 
+ *            to the file given with --save-index. Throws a runtime_error if 
+ *            it cannot be written. 
 */
-void gerp::readWords(string &file, int index) {
-    //create input stream and open the file 
-    ifstream input;
-    open_or_die(input, file);
+void gerp::saveShared(const string &indexFile) {
+    vector<uint64_t> pairs;
+    map<size_t, vector<size_t>>::iterator it;
+    for (it = aliases.begin(); it != aliases.end(); ++it) {
+        for (size_t i = 0; i < it->second.size(); i++) {
+            pairs.push_back(it->first);
+            pairs.push_back(it->second[i]);
+        }
+    }
 
-    //variables to store a line in the file and number of that line in the file 
-    string line;
-    int lineNum = 1;
+    sharedIndex::save(options.saveIndex, indexFile, paths, pairs, filter);
+}
 
-    //go through each line in the file
-    while (getline(input, line)) {
-        //create stream for the line and string to contain a word in the line
-        istringstream ss(line);
-        string word;
+/*
+ * name:      loadShared 
+ * purpose:   answers queries from an index saved by another process 
+ * arguments: a string with the directory the index should be of 
+ * returns:   none 
+ * effects:   maps the file given with --load-index and points the index 
+ *            file, path table and filter into it without reading them, so 
+ *            every process that loads the file shares its pages. Only the 
+ *            copies of files with the same contents are copied out. Throws 
+ *            a runtime_error if the file cannot be mapped or is the index 
+ *            of a different directory. 
+*/
+void gerp::loadShared(const string &directory) {
+    shared.open(options.loadIndex);
+    sharedIndex::Section section = shared.words();
+    disk.attach(section.data, section.length);
+    section = shared.paths();
+    paths.attach(section.data, section.length);
+    section = shared.filter();
+    filter.attach(section.data, section.length);
 
-        //go through each word in the line
-        while (ss >> word) {
-            //remove non alpha numeric characters from the word
-            string processed = stripNonAlphaNum(word);
+    //the index must be of the directory we were given 
+    string root = paths.numDirectories() > 0 ? paths.directoryPath(0) : "";
+    string given = directory;
+    while (root.length() > 1 and root.back() == '/') {
+        root.pop_back();
+    }
+    while (given.length() > 1 and given.back() == '/') {
+        given.pop_back();
+    }
+    if (root != given) {
+        throw runtime_error("Index " + options.loadIndex + " is of " + root);
+    }
 
-            //add word to index if it has alpha numeric characters 
-            if (not processed.empty()) 
-                table.insert(processed, index, lineNum);
+    //the copies of files with the same contents, which must be files in 
+    //the path table 
+    size_t numPairs = 0;
+    const uint64_t *pairs = shared.aliases(numPairs);
+    for (size_t i = 0; i < 2 * numPairs; i++) {
+        if (pairs[i] >= paths.size()) {
+            throw runtime_error("Damaged index: copy of an unknown file in " +
+                                options.loadIndex);
         }
-
-        //increment line number
-        lineNum++;
     }
+    for (size_t i = 0; i < numPairs; i++) {
+        aliases[pairs[2 * i]].push_back(pairs[2 * i + 1]);
+        isAlias.resize(max(isAlias.size(), (size_t) pairs[2 * i + 1] + 1), 
+                       false);
+        isAlias[pairs[2 * i + 1]] = true;
+        numAliases++;
+    }
+    copiesCounted = (numPairs == 0);
+    lineIdStarts.assign(1, 0);
+}
 
-    //close input file
-    input.close();
+/*
+ * name:      markRanges 
+ * purpose:   marks the directories the walk entered or finished before a file
+ * arguments: a reference to the WalkedFile of the file 
+ * returns:   none 
+ * effects:   starts and then finishes the ranges of files under those 
+ *            directories in the path table, and closes the descriptors of 
+ *            the directories the walk was done with. Called once the files 
+ *            before this one are added, so none of them is still being 
+ *            opened relative to those directories. 
+*/
+void gerp::markRanges(const WalkedFile &file) {
+    for (size_t i = 0; i < file.startedBefore.size(); i++) {
+        paths.startDirectory(file.startedBefore[i]);
+    }
+    for (size_t i = 0; i < file.finishedBefore.size(); i++) {
+        paths.finishDirectory(file.finishedBefore[i]);
+    }
+    for (size_t i = 0; i < file.releasedBefore.size(); i++) {
+        close(file.releasedBefore[i]);
+    }
 }
 
 /*
- * name:      newOutput
- * purpose:   updates output file to be the file provided by the client
- * arguments: a string with the name of an output file 
+ * name:      buildFilter 
+ * purpose:   builds the filter of the words in the index 
+ * arguments: none
  * returns:   none 
- * effects:   closes the output file that was currently open and opens the new
- *            output file, updating variables that are used to store 
- *            informtion on that file 
+ * effects:   adds every lowercase key and every case sensitive word of the 
+ *            hashTable (or of the index file) to the filter, so lookups of 
+ *            words that are not in the index can be answered without 
+ *            searching it. Files added later are not in the filter; their 
+ *            segments are always searched. 
 */
-void gerp::newOutput(string &outputFile) {
-    //close the current output file 
-    output.close();
+void gerp::buildFilter() {
+    //add the keys and words of the index file 
+    if (disk.isOpen()) {
+        filter.reset(disk.numKeys() + disk.numWords());
+        for (size_t i = 0; i < disk.numKeys(); i++) {
+            const diskIndex::KeyEntry *key = disk.keyAt(i);
+            filter.add(disk.name(key->nameOffset), key->nameLength, true);
 
-    //open new output file 
-    open_or_die(output, outputFile);
+            const diskIndex::WordEntry *entries = disk.words(*key);
+            for (size_t j = 0; j < key->numWords; j++) {
+                filter.add(disk.name(entries[j].nameOffset), 
+                           entries[j].nameLength, false);
+            }
+        }
+        return;
+    }
 
-    //update output file variables 
-    curr_output = outputFile;
-    outputLine = 0;
+    //or of the hashTable 
+    vector<const hashTable::Node *> nodes;
+    table.getNodes(nodes);
+    size_t numWords = nodes.size();
+    for (size_t i = 0; i < nodes.size(); i++) {
+        numWords += nodes[i]->entries.size();
+    }
+
+    filter.reset(numWords);
+    for (size_t i = 0; i < nodes.size(); i++) {
+        const string &key = nodes[i]->key;
+        filter.add(key.data(), key.length(), true);
+        for (size_t j = 0; j < nodes[i]->entries.size(); j++) {
+            const string &word = nodes[i]->entries[j].word;
+            filter.add(word.data(), word.length(), false);
+        }
+    }
 }
 
 /*
- * name:      printSensitive 
- * purpose:   prints the case sensitive locations of the given word 
- * arguments: a string with a word that is being queried  
+ * name:      addFiles 
+ * purpose:   adds files to the index without rebuilding it 
+ * arguments: a string with the path of a file or directory to add 
  * returns:   none 
- * effects:   gets all of the locations of the given case sensitive word in the
- *            directory and prints them out by calling a helper function. 
- *            Prints a message to query the word with insensitive command if 
- *            there are no instances of the case sensitive word in the 
- *            directory
+ * effects:   gives the new files the next file numbers, indexes their words
+ *            into a new hashTable, and freezes the table into a segment 
+ *            that later queries search along with the rest of the index. 
+ *            A small segment is merged into the head segment; others may 
+ *            later be merged in the background. Files that are already in 
+ *            the index are left out. Prints how many files were added, that
+ *            the path is already indexed, or a message if the path could 
+ *            not be read. 
 */
-void gerp::printSensitive(string &word) {
-    //get the case sensitive locations of the word
-    WordLocations entry = table.getSensitiveWord(word);
+void gerp::addFiles(string &path) {
+    lock_guard<mutex> updating(updateLock);
+    recordInodes();
+    lock_guard<mutex> guard(indexLock);
+    size_t first = paths.size(), already = 0;
+    hashTable live;
 
-    //print message if there are no locations of the case sensitive word
-    if (entry.location.empty()) {
-        output << word << " Not Found. Try with @insensitive or @i.\n";
-    }
+    try {
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0) {
+            throw runtime_error("Unable to open " + path);
+        }
 
-    //otherwise, print out word
-    else {
+        //a single file goes in a directory entry of its own 
+        if (S_ISREG(info.st_mode) and isIndexed(info)) {
+            already++;
+        } else if (S_ISREG(info.st_mode)) {
+            size_t slash = path.rfind('/');
+            string dirName = (slash == string::npos) ? "." : 
+                             path.substr(0, max(slash, (size_t) 1));
+            string name = path.substr(slash + 1);
+            int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) {
+                throw runtime_error("Unable to open " + path);
+            }
+            if (not fileRules.wantsContents(fd)) {
+                close(fd);
+                throw runtime_error("Skipped " + path);
+            }
+            size_t directory = paths.addDirectory(pathTable::NO_PARENT, 
+                                                  dirName);
+            readWords(fd, paths.addFile(directory, name), &live);
+            paths.finishDirectory(directory);
+        }
+        //a directory is walked like the one indexed at the start 
+        else {
+            dirWalker walker(path, paths);
+            walker.setFilter(&fileRules);
+            while (walker.next()) {
+                int fd = walker.openFile();
+                if (fd < 0) {
+                    throw runtime_error("Unable to open " + walker.path());
+                }
+                struct stat fileInfo;
+                if (fstat(fd, &fileInfo) == 0 and isIndexed(fileInfo)) {
+                    close(fd);
+                    already++;
+                    continue;
+                }
+                if (not fileRules.wantsContents(fd)) {
+                    close(fd);
+                    continue;
+                }
+                readWords(fd, paths.addFile(walker.directory(), 
+                                            walker.name()), &live);
+            }
+        }
+    } catch (const runtime_error &e) {
+        printMessage(path + " could not be added.\n");
+    }
 
-        //get size of the locations vector
-        int size = entry.location.size();
-        //store the number of lines that have been printed
-        int printed_lines = 0;
+    //freeze whatever files were read into a segment 
+    size_t end = paths.size();
+    if (end > first) {
+        segments.add(make_shared<const indexSegment>(live, first, end));
+        printMessage("Added " + to_string(end - first) + 
+                     (end - first == 1 ? " file" : " files") + " from " + 
+                     path + ".\n");
+    } else if (already > 0) {
+        printMessage(path + " is already indexed.\n");
+    }
+}
 
-        //try and print each location, updating number of lines printed
-        for (int i = 0; i < size; i++) {
-            printed_lines += outputPaths(entry.location.at(i));
+/*
+ * name:      recordInodes 
+ * purpose:   records the device and inode of the files indexed since they 
+ *            were last recorded 
+ * arguments: none
+ * returns:   none 
+ * effects:   stats each such file by its path. The build records the files
+ *            it reads as it goes, so this only has the files added since 
+ *            (or every file of an index loaded with --load-index, the first
+ *            time). Must be called with the update lock held and without 
+ *            the index lock: only changes to the index add paths, and they 
+ *            hold the update lock, so queries go on while the files are 
+ *            looked at. 
+*/
+void gerp::recordInodes() {
+    struct stat known;
+    for (; inodesKnown < paths.size(); inodesKnown++) {
+        if (stat(paths.path(inodesKnown).c_str(), &known) == 0) {
+            fileInodes[make_pair(known.st_dev, known.st_ino)] = inodesKnown;
         }
+    }
+}
 
-        //update the current line we are at in the output file 
-        outputLine += printed_lines;
+/*
+ * name:      isIndexed 
+ * purpose:   checks whether a file is already in the index 
+ * arguments: the file's stat information 
+ * returns:   returns true if a file in the index that has not been deleted 
+ *            or replaced is the same file (the same device and inode), 
+ *            false otherwise 
+ * effects:   none. The files indexed must have been recorded with 
+ *            recordInodes first. 
+*/
+bool gerp::isIndexed(const struct stat &info) {
+    map<pair<dev_t, ino_t>, size_t>::iterator found = 
+        fileInodes.find(make_pair(info.st_dev, info.st_ino));
+    if (found == fileInodes.end()) {
+        return false;
     }
+    size_t file = found->second;
+    return file >= deadFiles.size() or not deadFiles[file];
 }
 
 /*
- * name:      printInsensitive 
- * purpose:   prints all of the locations of the word in the directory 
- *            regardless of case sensitivity
- * arguments: a string with a word that was queried  
+ * name:      startWatching 
+ * purpose:   starts keeping the index up to date as files change 
+ * arguments: none
  * returns:   none 
- * effects:   gets all of the locations of the word, regardless of case 
- *            sensitive letters, and prints them out by calling a helper 
- *            function. Prints a message that the word is not found if there
- *            are no locations of that word in the directory
+ * effects:   remembers the number of every indexed path and watches every 
+ *            indexed directory. Each batch of changes is applied by 
+ *            applyChanges on the watcher's thread while queries go on. 
+ *            Throws a runtime_error if the directories cannot be watched. 
 */
-void gerp::printInsensitive(string &word) {
-    //get all of the locations of the case insensitive word 
-    hashTable::Node node = table.getInsensitiveWord(word);
+void gerp::startWatching() {
+    for (size_t i = 0; i < paths.size(); i++) {
+        fileIds[paths.path(i)] = i;
+    }
 
-    //if there are no locations, print not found
-    if (node.entries.empty()) { 
-        output << word << " Not Found.\n";
+    vector<string> directories;
+    for (size_t i = 0; i < paths.numDirectories(); i++) {
+        directories.push_back(paths.directoryPath(i));
     }
 
-    //otherwise, print out locations
-    else {
+    watcher.start(directories, [this](const vector<string> &changed, 
+                                      const vector<string> &deleted) {
+        applyChanges(changed, deleted);
+    });
+}
+
+/*
+ * name:      applyChanges 
+ * purpose:   updates the index for a batch of changed and deleted files 
+ * arguments: a vector with the paths of files that were written or created
+ *            and a vector with the paths of files and directories that were
+ *            deleted 
+ * returns:   none 
+ * effects:   gives each changed file a new file number in its directory 
+ *            (adding the directory if it is new), reads the changed 
+ *            files into a new hashTable without holding the index lock 
+ *            (unless line offsets are built, since they are shared with 
+ *            queries), then, under the lock, marks the old numbers of the 
+ *            changed files and the numbers of the deleted ones as deleted 
+ *            and freezes the table into a segment (merged into the head 
+ *            segment if it is small). Queries skip the locations of deleted
+ *            files, so no postings are rewritten. A changed file that 
+ *            cannot be read or is not wanted by the file rules is left out,
+ *            without counting it as skipped again (the skip counts are of 
+ *            the build). 
+*/
+void gerp::applyChanges(const vector<string> &changed, 
+                        const vector<string> &deleted) {
+    lock_guard<mutex> updating(updateLock);
+    size_t first = 0;
 
-        //get size of the entries vector
-        int size = node.entries.size();
-        //int to store number of lines printed 
-        int printed_lines = 0;
+    //leave out the files the file rules skip by name, and sort the rest so
+    //the files under each directory get consecutive numbers 
+    vector<string> files;
+    for (size_t i = 0; i < changed.size(); i++) {
+        string name = changed[i].substr(changed[i].rfind('/') + 1);
+        if (fileRules.checkName(changed[i], name)) {
+            files.push_back(changed[i]);
+        }
+    }
+    sort(files.begin(), files.end());
 
-        //go through each case sensitive entry of the word 
-        for (int i = 0; i < size; i++) {
-            int entry_size = node.entries.at(i).location.size();
+    //give each changed file the next file number, in its directory 
+    {
+        lock_guard<mutex> guard(indexLock);
+        first = paths.size();
+        for (size_t i = 0; i < files.size(); i++) {
+            size_t slash = files[i].rfind('/');
+            string dirPath = (slash == string::npos) ? "." : 
+                             files[i].substr(0, max(slash, (size_t) 1));
+            paths.addFile(paths.addDirectoryPath(dirPath), 
+                          files[i].substr(slash + 1));
+        }
+    }
 
-            //go through each location of word, update number of lines printed
-            for (int j = 0; j < entry_size; j++) {
-                printed_lines += outputPaths(node.entries.at(i).location.at(j));
+    //read the changed files, keeping the ones that could not be read 
+    hashTable live;
+    vector<bool> unread(files.size(), false);
+    {
+        unique_lock<mutex> guard(indexLock, defer_lock);
+        if (options.lineOffsets) {
+            guard.lock();
+        }
+        for (size_t i = 0; i < files.size(); i++) {
+            int fd = open(files[i].c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) {
+                unread[i] = true;
+                continue;
+            }
+            size_t fileBytes = 0;
+            if (fileRules.checkContents(fd, fileBytes) != 
+                fileFilter::WANTED) {
+                close(fd);
+                unread[i] = true;
+                continue;
+            }
+            try {
+                readWords(fd, first + i, &live);
+            } catch (const runtime_error &e) {
+                unread[i] = true;
             }
         }
+    }
 
-        //update line we are at in output once finished printing
-        outputLine += printed_lines;
+    //replace the old versions of the files with the new ones 
+    lock_guard<mutex> guard(indexLock);
+    for (size_t i = 0; i < deleted.size(); i++) {
+        dropFile(deleted[i]);
+    }
+    for (size_t i = 0; i < files.size(); i++) {
+        dropFile(files[i]);
+        if (unread[i]) {
+            deadFiles.resize(paths.size(), false);
+            deadFiles[first + i] = true;
+            numDead++;
+        } else {
+            fileIds[files[i]] = first + i;
+        }
+    }
+    if (not files.empty()) {
+        segments.add(make_shared<const indexSegment>(live, first, 
+                                                     first + files.size()));
     }
 }
 
 /*
- * name:      outputPaths
- * purpose:   prints the given location of a word to the output file
- * arguments: an Instance variable with a location in the directory   
- * returns:   returns 1 if a line was printed to the output file, 0 if no line
- *            was printed 
- * effects:   gets the file and line where the queried word was located in the
- *            directory, checking to make sure that the line was not printed
- *            already for case insensitive searches. Returns whether a line was
- *            printed to the output file in order to update the line in the 
- *            output file 
+ * name:      dropFile 
+ * purpose:   removes a file, or every file under a directory, from the 
+ *            results of later queries 
+ * arguments: a string with the path of the file or directory 
+ * returns:   none 
+ * effects:   marks the file number of the path as deleted and forgets the 
+ *            path. If the path is not an indexed file, does the same for 
+ *            every indexed file under it. Must be called with the index 
+ *            lock held. 
 */
-int gerp::outputPaths(Instance &location) {
-    //get the name of the file at the given index in the file paths vectory
-    string path = filepaths.at(location.file_path_index);
-    //open the file 
-    ifstream input;
-    open_or_die(input, path);
+void gerp::dropFile(const string &path) {
+    vector<size_t> dropped;
 
-    string line;    //store line
-    int line_number = 1, printed = 0;    //output line num, whether line printed
-    bool found = false;     //store whether word was found 
+    //the path of an indexed file 
+    unordered_map<string, size_t>::iterator found = fileIds.find(path);
+    if (found != fileIds.end()) {
+        dropped.push_back(found->second);
+        fileIds.erase(found);
+    }
+    //or of a directory, whose files are all dropped 
+    else {
+        string prefix = path + "/";
+        for (found = fileIds.begin(); found != fileIds.end(); ) {
+            if (found->first.compare(0, prefix.length(), prefix) == 0) {
+                dropped.push_back(found->second);
+                found = fileIds.erase(found);
+            } else {
+                ++found;
+            }
+        }
+    }
+
+    //mark the files as deleted 
+    deadFiles.resize(paths.size(), false);
+    for (size_t i = 0; i < dropped.size(); i++) {
+        if (not deadFiles[dropped[i]]) {
+            deadFiles[dropped[i]] = true;
+            numDead++;
+        }
+    }
+}
+
+/*
+ * name:      isDuplicate 
+ * purpose:   checks whether a file has the same contents as an earlier one
+ * arguments: a size_t with the file's number, a uint64_t with the hash of 
+ *            its contents, and a string with the contents 
+ * returns:   returns true if an earlier file had the same contents, false 
+ *            otherwise 
+ * effects:   makes the file an alias of the first file with the hash if 
+ *            that file's bytes are the same, or remembers the hash if it is
+ *            new. A file whose hash matches but whose bytes do not is 
+ *            indexed on its own. 
+*/
+bool gerp::isDuplicate(size_t index, uint64_t hash, const string &contents) {
+    pair<unordered_map<uint64_t, size_t>::iterator, bool> added = 
+        contentFiles.insert(make_pair(hash, index));
+    if (added.second) {
+        return false;
+    }
+    if (not sameContents(added.first->second, contents)) {
+        return false;
+    }
 
-    //go through each line until location in file is reached 
-    while (getline(input, line) and (not found)) {
-        //if line number reached, print location to output file 
-        if (line_number == location.lineNum) {
-            string temp = ":" + to_string(line_number) + ": " + line;
-            path += temp;
+    aliases[added.first->second].push_back(index);
+    isAlias.resize(index + 1, false);
+    isAlias[index] = true;
+    numAliases++;
+    return true;
+}
+
+/*
+ * name:      sameContents 
+ * purpose:   checks whether a file indexed earlier has the given contents 
+ * arguments: a size_t with the earlier file's number and a string with the
+ *            contents to compare it to 
+ * returns:   returns true if the file has exactly those bytes, false if it 
+ *            does not or cannot be read 
+ * effects:   compares the file's size, then reads it back a chunk at a time
+ *            and compares each chunk, so the contents of earlier files do 
+ *            not have to be kept 
+*/
+bool gerp::sameContents(size_t file, const string &contents) {
+    int fd = open(paths.path(file).c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 or (size_t) info.st_size != contents.size()) {
+        close(fd);
+        return false;
+    }
 
-            //make sure path was not printed, especially for insensitive 
-            if ((not insensitive) or (checkOutput(path) and insensitive)) {
-                output << path << endl;
-                printed++;
-            }   
-            //indicate we found location
-            found = true;
+    char chunk[65536];
+    size_t position = 0;
+    ssize_t bytes;
+    while (position < contents.size() and 
+           (bytes = read(fd, chunk, sizeof(chunk))) > 0) {
+        if ((size_t) bytes > contents.size() - position or 
+            memcmp(chunk, contents.data() + position, bytes) != 0) {
+            close(fd);
+            return false;
         }
+        position += bytes;
+    }
+    close(fd);
+    return position == contents.size();
+}
 
-        line_number++;
+/*
+ * name:      countCopy 
+ * purpose:   counts a word of a copy of a file toward the word's counts 
+ * arguments: a string with the word, and the file's number and line number 
+ *            the word is on 
+ * returns:   none 
+ * effects:   adds the line (if the word or its key was not already counted 
+ *            on it) and the file (if they were not counted in it) to the 
+ *            counts the copies add to the case sensitive word and to its 
+ *            lowercase key. The files of a copy are read one at a time, so 
+ *            only the last file and line counted need to be kept. 
+*/
+void gerp::countCopy(const string &word, size_t index, size_t lineNum) {
+    string key = word;
+    makeLowerInPlace(key);
+    CopyCounts *counts[2] = {&copyWords[word], &copyKeys[key]};
+    for (int i = 0; i < 2; i++) {
+        CopyCounts &count = *counts[i];
+        if (count.lines > 0 and count.lastFile == index and 
+            count.lastLine == lineNum) {
+            continue;
+        }
+        if (count.lines == 0 or count.lastFile != index) {
+            count.files++;
+        }
+        count.lines++;
+        count.lastFile = index;
+        count.lastLine = lineNum;
     }
-    input.close();
-    return printed;
 }
 
 /*
- * name:      checkOutput
- * purpose:   checks whether a line was already printed to output during the
- *            current query
- * arguments: a string with a path and location in the directory
- * returns:   returns true if the line is unique, false if it is not  
- * effects:   opens the output file and checks if the given location was 
- *            already printed during the current query
+ * name:      addCopyCounts 
+ * purpose:   adds the lines and files of the copies of files to a word's 
+ *            counts 
+ * arguments: a string with the word, whether the lookup ignores case, and 
+ *            references to the size_ts with its number of lines and files 
+ * returns:   none 
+ * effects:   adds what countCopy counted for the word (or for its lowercase 
+ *            key, if case is ignored), so the stored counts include every 
+ *            copy the way walking the locations would 
 */
-bool gerp::checkOutput(const string &path) {
-    //open output file 
-    ifstream input;
-    open_or_die(input, curr_output);
+void gerp::addCopyCounts(const string &word, bool insensitive, 
+                         size_t &numLines, size_t &numFiles) {
+    if (numAliases == 0) {
+        return;
+    }
 
-    //variables to store line and line number in output
-    string line;
-    int curr_line = 0;
+    unordered_map<string, CopyCounts>::const_iterator found;
+    if (insensitive) {
+        string key = word;
+        makeLowerInPlace(key);
+        found = copyKeys.find(key);
+        if (found == copyKeys.end()) {
+            return;
+        }
+    } else {
+        found = copyWords.find(word);
+        if (found == copyWords.end()) {
+            return;
+        }
+    }
+    numLines += found->second.lines;
+    numFiles += found->second.files;
+}
 
-    //go through each line in the output file 
-    while (getline(input, line)) {
-        //line already printed during current query, end loop & return false
-        if ((line == path) and (curr_line >= outputLine)) {
-            input.close();
-            return false;
+/*
+ * name:      buildDenseWords 
+ * purpose:   stores the lines of the most common words as bitmaps 
+ * arguments: none
+ * returns:   none 
+ * effects:   gives every line of the directory a line id, in file and line 
+ *            order, and moves the locations of each case sensitive word on 
+ *            at least one line in DENSE_LINES (and on MIN_DENSE_LINES lines
+ *            or more) into a Roaring bitmap of line ids, emptying its 
+ *            vector, so the case variants of a word are unioned a container
+ *            at a time instead of merged a location at a time. A bitmap 
+ *            that is not smaller than the vector is dropped, and the word 
+ *            keeps its vector. Does nothing if there are too many lines for
+ *            32 bit line ids. 
+*/
+void gerp::buildDenseWords() {
+    size_t totalLines = lineIdStarts.back();
+    if (totalLines == 0 or totalLines > UINT32_MAX) {
+        return;
+    }
+
+    vector<hashTable::Node *> nodes;
+    table.getNodes(nodes);
+    for (size_t i = 0; i < nodes.size(); i++) {
+        for (size_t j = 0; j < nodes[i]->entries.size(); j++) {
+            WordLocations &entry = nodes[i]->entries[j];
+            if (entry.location.size() * DENSE_LINES < totalLines or 
+                entry.location.size() < MIN_DENSE_LINES) {
+                continue;
+            }
+
+            //add the line id of each location 
+            roaringBitmap lineIds;
+            for (size_t k = 0; k < entry.location.size(); k++) {
+                const Instance &location = entry.location[k];
+                lineIds.add(lineIdStarts[location.file_path_index()] + 
+                            location.lineNum() - 1);
+            }
+
+            //and keep the bitmap only if it is smaller, freeing the vector
+            if (lineIds.bytes() >= 
+                entry.location.capacity() * sizeof(Instance)) {
+                continue;
+            }
+            denseWords[&entry] = move(lineIds);
+            vector<Instance>().swap(entry.location);
         }
+    }
+}
 
-        //increment line number 
-        curr_line++;
+/*
+ * name:      readWords
+ * purpose:   adds the words in the given open file to the index
+ * arguments: an int with an open file descriptor of a file in the directory,
+ *            that file's index in the vector of file paths, and a pointer 
+ *            to the table of the segment being added (nullptr for the index
+ *            built at the start) 
+ * returns:   a size_t with the number of lines in the file 
+ * effects:   reads the whole file into a string, closes the file descriptor
+ *            and indexes the contents with indexWords 
+*/
+size_t gerp::readWords(int fd, size_t index, hashTable *into) {
+    string contents;
+    char chunk[65536];
+    ssize_t bytes;
+    while ((bytes = read(fd, chunk, sizeof(chunk))) > 0) {
+        contents.append(chunk, bytes);
     }
+    close(fd);
 
-    //close file and return true
-    input.close();
-    return true;
+    return indexWords(contents, index, into);
+}
+
+/*
+ * name:      indexWords
+ * purpose:   adds the words in the contents of a file to the index
+ * arguments: a string with the whole contents of a file in the directory, 
+ *            that file's index in the vector of file paths, and a pointer 
+ *            to the table of the segment being added (nullptr for the index
+ *            built at the start) 
+ * returns:   a size_t with the number of lines in the file 
+ * effects:   splits the contents into lines and the lines into whitespace 
+ *            separated words (the same way getline and >> would), and adds 
+ *            each word to the hashTable index using the table's insert 
+ *            function (or the builder's, with a memory budget, or the given
+ *            table). The words of a file indexed at the start with the same
+ *            contents as an earlier one are not added; it becomes an alias 
+ *            of the earlier file instead, and its words are only counted 
+ *            toward the lines and files of the copies. If line offsets are 
+ *            enabled, records where each line starts in the line index, and
+ *            if trigrams are, adds each line's trigrams. 
+*/
+size_t gerp::indexWords(const string &contents, size_t index, 
+                        hashTable *into) {
+    //a copy of a file indexed at the start only needs its lines counted 
+    bool duplicate = false;
+    if (into == nullptr) {
+        contentHash hash;
+        hash.update(contents.data(), contents.length());
+        duplicate = isDuplicate(index, hash.finish(), contents);
+    }
+
+    //positions in the file and number of the line we are at in the file, 
+    //and a buffer for the current word that keeps its memory between words
+    size_t position = 0, length = contents.length();
+    size_t lineNum = 1;
+    const char *text = contents.data();
+    string word;
+    if (options.lineOffsets) {
+        lineStarts.addFile(index);
+    }
+
+    //go through each line in the file
+    while (position < length) {
+        size_t end = contents.find('\n', position);
+        if (end == string::npos) {
+            end = length;
+        }
+
+        //record the line for substring and regular expression searches 
+        if (options.lineOffsets) {
+            lineStarts.addLine(index, position);
+        }
+        if (options.trigrams and not duplicate) {
+            trigrams.addLine(contents.data() + position, end - position, 
+                             Instance(index, lineNum));
+        }
+
+        //go through each word in the line
+        size_t i = position;
+        while (i < end) {
+            //skip whitespace before the word, then find where it ends 
+            while (i < end and isSpaceChar(text[i])) {
+                i++;
+            }
+            size_t start = i;
+            while (i < end and not isSpaceChar(text[i])) {
+                i++;
+            }
+
+            //remove non alpha numeric characters from the word (in place, 
+            //without copying it first) and add it to index if it has alpha
+            //numeric characters 
+            size_t first = 0;
+            size_t kept = trimNonAlphaNum(text + start, i - start, first);
+            if (kept == 0) {
+                continue;
+            }
+            word.assign(text + start + first, kept);
+            if (duplicate) {
+                countCopy(word, index, lineNum);
+            } else if (into != nullptr) {
+                into->insert(word, index, lineNum);
+            } else if (options.memoryBudget > 0) {
+                builder.insert(word, index, lineNum);
+            } else {
+                table.insert(word, index, lineNum);
+            }
+        }
+
+        //move to the next line 
+        lineNum++;
+        position = end + 1;
+    }
+    if (options.lineOffsets) {
+        lineStarts.finishFile(index, length);
+    }
+    return lineNum - 1;
+}
+
+/*
+ * name:      newOutput
+ * purpose:   updates output file to be the file provided by the client
+ * arguments: a string with the name of an output file and the format to 
+ *            write it in 
+ * returns:   none 
+ * effects:   closes the output file that was currently open and opens the new
+ *            output file, updating variables that are used to store 
+ *            informtion on that file 
+*/
+void gerp::newOutput(string &outputFile, resultWriter::Format format) {
+    //close the current output file 
+    output.close();
+
+    //open new output file 
+    open_or_die(output, outputFile);
+
+    //update output file variables 
+    curr_output = outputFile;
+    writer = resultWriter(format);
+}
+
+/*
+ * name:      printMessage 
+ * purpose:   writes a message to the output file 
+ * arguments: a string with the message, ending with a newline 
+ * returns:   none 
+ * effects:   writes the message as it is in text, or as a message record in
+ *            the other formats 
+*/
+void gerp::printMessage(const string &text) {
+    string buffer;
+    writer.message(buffer, text);
+    output << buffer;
+}
+
+/*
+ * name:      printCount 
+ * purpose:   writes the number of lines and files with a word 
+ * arguments: a string with the word and size_ts with its numbers of lines 
+ *            and files 
+ * returns:   none 
+ * effects:   writes "word: lines lines in files files" in text, or as a 
+ *            count record in the other formats 
+*/
+void gerp::printCount(const string &word, size_t lines, size_t files) {
+    string buffer;
+    writer.count(buffer, word, lines, files);
+    output << buffer;
+}
+
+/*
+ * name:      printTruncated 
+ * purpose:   writes that a query was stopped before it finished 
+ * arguments: a size_t with the number of results it gave 
+ * returns:   none 
+ * effects:   writes "-- stopped after N results: reason --" in text, or as a
+ *            truncated record in the other formats, with the reason the 
+ *            query's guard stopped it 
+*/
+void gerp::printTruncated(size_t given) {
+    string buffer;
+    writer.truncated(buffer, queryGuard::describe(budget.reason()), given);
+    output << buffer;
+}
+
+/*
+ * name:      printStats 
+ * purpose:   writes how often a word occurs in the directory 
+ * arguments: a string with the word, in any case 
+ * returns:   none 
+ * effects:   writes the occurrences, lines and files of the word's 
+ *            lowercase key, then of each of its case variants, or that the 
+ *            word is not found. The counts are of the files indexed at the 
+ *            start (leaving out copies of files, which a note after them 
+ *            says), so they include files deleted since and not files added
+ *            since. Only an index built in memory counts occurrences. 
+*/
+void gerp::printStats(string &word) {
+    lock_guard<mutex> guard(indexLock);
+    if (disk.isOpen()) {
+        printMessage("Statistics need the index built in memory.\n");
+        return;
+    }
+
+    const hashTable::Node *node = table.findInsensitiveWord(word);
+    if (node == nullptr) {
+        printMessage(word + InsensitiveCase::notFound());
+        return;
+    }
+    string buffer;
+    appendStats(buffer, *node, true, writer);
+    appendCopiesNote(buffer, writer);
+    output << buffer;
+}
+
+/*
+ * name:      printTopKeys 
+ * purpose:   writes the most frequent words in the directory 
+ * arguments: none 
+ * returns:   none 
+ * effects:   writes the occurrences, lines and files of each of the 
+ *            hashTable::TOP_KEYS lowercase keys with the most occurrences, 
+ *            most first, from the heap the table kept while it was built, 
+ *            and a note if they leave out copies of files 
+*/
+void gerp::printTopKeys() {
+    lock_guard<mutex> guard(indexLock);
+    if (disk.isOpen()) {
+        printMessage("Statistics need the index built in memory.\n");
+        return;
+    }
+
+    vector<const hashTable::Node *> nodes;
+    table.getTopKeys(nodes);
+    string buffer;
+    for (size_t i = 0; i < nodes.size(); i++) {
+        appendStats(buffer, *nodes[i], false, writer);
+    }
+    appendCopiesNote(buffer, writer);
+    output << buffer;
+}
+
+/*
+ * name:      dumpVocab 
+ * purpose:   writes the statistics of every word in the directory to a file
+ * arguments: a string with the name of the file 
+ * returns:   none 
+ * effects:   writes each lowercase key, in order, with its case variants 
+ *            under it, in the format chosen at the start, and a note if the 
+ *            counts leave out copies of files. Throws a runtime_error if the
+ *            file cannot be opened. 
+*/
+void gerp::dumpVocab(const string &vocabFile) {
+    vector<const hashTable::Node *> nodes;
+    table.getNodes(nodes);
+    sort(nodes.begin(), nodes.end(), 
+         [](const hashTable::Node *a, const hashTable::Node *b) {
+             return a->key < b->key;
+         });
+
+    //write the keys a buffer at a time 
+    ofstream vocab;
+    string name = vocabFile;
+    open_or_die(vocab, name);
+    resultWriter vocabWriter(options.format);
+    string buffer;
+    for (size_t i = 0; i < nodes.size(); i++) {
+        appendStats(buffer, *nodes[i], true, vocabWriter);
+        if (buffer.length() >= (1 << 16)) {
+            vocab << buffer;
+            buffer.clear();
+        }
+    }
+    appendCopiesNote(buffer, vocabWriter);
+    vocab << buffer;
+}
+
+/*
+ * name:      appendStats 
+ * purpose:   writes the statistics of a lowercase key 
+ * arguments: a string to append to, the key's Node, whether to write each 
+ *            of its case variants too, and the writer to write them with 
+ * returns:   none 
+ * effects:   appends the key's occurrences, lines and files, then those of 
+ *            each variant (in the order they were first found). The lines 
+ *            of a variant with a bitmap are counted from the bitmap, since 
+ *            its location vector was emptied. 
+*/
+void gerp::appendStats(string &buffer, const hashTable::Node &node, 
+                       bool variants, const resultWriter &to) {
+    to.term(buffer, node.key, node.occurrences, node.numLines, 
+            node.numFiles, false);
+    for (size_t i = 0; variants and i < node.entries.size(); i++) {
+        const WordLocations &entry = node.entries[i];
+        size_t lines = entry.location.size();
+        unordered_map<const WordLocations *, roaringBitmap>::const_iterator
+            dense = denseWords.find(&entry);
+        if (dense != denseWords.end()) {
+            lines = dense->second.cardinality();
+        }
+        to.term(buffer, entry.word, entry.occurrences, lines, 
+                entry.numFiles, true);
+    }
+}
+
+/*
+ * name:      appendCopiesNote 
+ * purpose:   writes that the statistics leave out copies of files 
+ * arguments: a string to append to and the writer to write it with 
+ * returns:   none 
+ * effects:   appends a message with the number of files left out for having
+ *            the same contents as an earlier file, if there are any, since 
+ *            the statistics count each contents once while @count counts 
+ *            every copy 
+*/
+void gerp::appendCopiesNote(string &buffer, const resultWriter &to) {
+    if (numAliases == 1) {
+        to.message(buffer, "Counts leave out 1 copy of a file; @count "
+                           "includes it.\n");
+    } else if (numAliases > 1) {
+        to.message(buffer, "Counts leave out " + to_string(numAliases) + 
+                           " copies of files; @count includes them.\n");
+    }
+}
+
+/*
+ * name:      findLocations 
+ * purpose:   finds the lists of locations of a word and its counts 
+ * arguments: a string with a word, whether to ignore case sensitivity, a 
+ *            vector to store the word's location lists in, and references to
+ *            size_ts to store its number of lines and files in 
+ * returns:   returns true if the word was found, false otherwise 
+ * effects:   looks the word up in the index of the directory and in each 
+ *            segment of files added since, adding up the counts (every 
+ *            segment has its own files, so no line or file is counted 
+ *            twice), and the lines and files of the copies of files. Keeps 
+ *            the segments that were searched until the next call, since the 
+ *            lists point into them. 
+*/
+bool gerp::findLocations(string &word, bool insensitive, 
+                         vector<LocationList> &lists, size_t &numLines, 
+                         size_t &numFiles) {
+    lists.clear();
+    queryBitmaps.clear();
+    findBaseLocations(word, insensitive, lists, numLines, numFiles);
+    addCopyCounts(word, insensitive, numLines, numFiles);
+
+    //add the locations in the segments of added files 
+    querySegments = segments.snapshot();
+    for (size_t i = 0; i < querySegments.size(); i++) {
+        size_t lines = 0, files = 0;
+        if (querySegments[i]->find(word, insensitive, lists, lines, files)) {
+            numLines += lines;
+            numFiles += files;
+        }
+    }
+
+    return numLines > 0;
+}
+
+/*
+ * name:      findBaseLocations 
+ * purpose:   finds the lists of locations of a word in the directory that 
+ *            was indexed when gerp started 
+ * arguments: a string with a word, whether to ignore case sensitivity, a 
+ *            vector to add the word's location lists to, and references to
+ *            size_ts to store its number of lines and files in 
+ * returns:   returns true if the word was found, false otherwise 
+ * effects:   asks the filter first, and returns false right away if the 
+ *            word is certainly not in the index. Otherwise looks the word 
+ *            up in the hashTable, or in the index file when the index was
+ *            built on disk. The bitmaps of common words go in queryBitmaps 
+ *            instead of the lists. An insensitive search gives one 
+ *            list per case sensitive variant of the word. The lists point 
+ *            into the index and are not copied. 
+*/
+bool gerp::findBaseLocations(string &word, bool insensitive, 
+                             vector<LocationList> &lists, size_t &numLines, 
+                             size_t &numFiles) {
+    numLines = numFiles = 0;
+
+    //most words that are not in the index stop at the filter 
+    baseLookups++;
+    if (not filter.mayContain(word, insensitive)) {
+        filterRejects++;
+        return false;
+    }
+
+    //look the word up in the index file 
+    if (disk.isOpen()) {
+        if (insensitive) {
+            const diskIndex::KeyEntry *key = disk.findKey(word);
+            if (key == nullptr) {
+                return false;
+            }
+            const diskIndex::WordEntry *entries = disk.words(*key);
+            for (size_t i = 0; i < key->numWords; i++) {
+                lists.push_back(disk.locations(entries[i]));
+            }
+            numLines = key->numLines;
+            numFiles = key->numFiles;
+        } else {
+            const diskIndex::WordEntry *entry = disk.findWord(word);
+            if (entry == nullptr) {
+                return false;
+            }
+            lists.push_back(disk.locations(*entry));
+            numLines = entry->numLocations;
+            numFiles = entry->numFiles;
+        }
+        return numLines > 0;
+    }
+
+    //or in the hashTable 
+    if (insensitive) {
+        const hashTable::Node *node = table.findInsensitiveWord(word);
+        if (node == nullptr) {
+            return false;
+        }
+        for (size_t i = 0; i < node->entries.size(); i++) {
+            const WordLocations &entry = node->entries.at(i);
+            unordered_map<const WordLocations *, roaringBitmap>::iterator 
+                dense = denseWords.find(&entry);
+            if (dense != denseWords.end()) {
+                queryBitmaps.push_back(&dense->second);
+                continue;
+            }
+            LocationList list = {entry.location.data(), 
+                                 entry.location.size()};
+            lists.push_back(list);
+        }
+        numLines = node->numLines;
+        numFiles = node->numFiles;
+    } else {
+        const WordLocations *entry = table.findSensitiveWord(word);
+        if (entry == nullptr) {
+            return false;
+        }
+        numLines = entry->location.size();
+        numFiles = entry->numFiles;
+
+        //a common word's lines are in its bitmap 
+        unordered_map<const WordLocations *, roaringBitmap>::iterator 
+            dense = denseWords.find(entry);
+        if (dense != denseWords.end()) {
+            queryBitmaps.push_back(&dense->second);
+            numLines = dense->second.cardinality();
+            return true;
+        }
+        LocationList list = {entry->location.data(), entry->location.size()};
+        lists.push_back(list);
+    }
+    return numLines > 0;
+}
+
+/*
+ * name:      addDenseLists 
+ * purpose:   adds the locations in the bitmaps of the last lookup to its 
+ *            lists 
+ * arguments: a vector of the location lists of the last lookup 
+ * returns:   none 
+ * effects:   unions the bitmaps of every case variant that has one, turns 
+ *            the line ids back into locations in file and line order, and 
+ *            adds them to the lists as one more list. The locations are 
+ *            kept until the next lookup's are added, or until the next 
+ *            query's results start if they are the current results. 
+*/
+void gerp::addDenseLists(vector<LocationList> &lists) {
+    if (queryBitmaps.empty()) {
+        return;
+    }
+
+    //union the bitmaps if there are more than one 
+    roaringBitmap merged;
+    const roaringBitmap *lineIds = queryBitmaps[0];
+    if (queryBitmaps.size() > 1) {
+        merged = *queryBitmaps[0];
+        for (size_t i = 1; i < queryBitmaps.size(); i++) {
+            merged.unionWith(*queryBitmaps[i]);
+        }
+        lineIds = &merged;
+    }
+    queryBitmaps.clear();
+
+    //find the file of each line id, moving forward through the files 
+    queryDecoded.clear();
+    queryDecoded.reserve(lineIds->cardinality());
+    size_t file = 0;
+    lineIds->forEach([&](uint32_t lineId) {
+        while (lineId >= lineIdStarts[file + 1]) {
+            file++;
+        }
+        Instance location;
+        location.packed = ((PackedLocation) file << Instance::LINE_BITS) | 
+                          (PackedLocation) (lineId - lineIdStarts[file] + 1);
+        queryDecoded.push_back(location);
+    });
+
+    LocationList list = {queryDecoded.data(), queryDecoded.size()};
+    lists.push_back(list);
+}
+
+/*
+ * name:      addAliasLists 
+ * purpose:   adds the locations in files that are copies of other files 
+ * arguments: a vector of the location lists of the last lookup (with the 
+ *            bitmaps already added) 
+ * returns:   none 
+ * effects:   finds the locations in each file that has copies and repeats 
+ *            them in each copy, then adds them to the lists as one more list
+ *            in file and line order, so results come out as if every copy 
+ *            had been indexed. A short list is scanned, a long one is 
+ *            binary searched for each file with copies. The locations are 
+ *            kept like the bitmaps' locations. 
+*/
+void gerp::addAliasLists(vector<LocationList> &lists) {
+    if (aliases.empty()) {
+        return;
+    }
+
+    queryAliases.clear();
+    for (size_t i = 0; i < lists.size(); i++) {
+        const Instance *list = lists[i].data;
+        size_t size = lists[i].size;
+        map<size_t, vector<size_t>>::iterator copies;
+
+        //a list shorter than the number of copied files is scanned 
+        if (size <= aliases.size()) {
+            for (size_t j = 0; j < size; j++) {
+                copies = aliases.find(list[j].file_path_index());
+                if (copies == aliases.end()) {
+                    continue;
+                }
+                for (size_t k = 0; k < copies->second.size(); k++) {
+                    queryAliases.push_back(Instance(copies->second[k], 
+                                                    list[j].lineNum()));
+                }
+            }
+            continue;
+        }
+
+        //otherwise find each copied file's locations in the list 
+        for (copies = aliases.begin(); copies != aliases.end(); ++copies) {
+            const Instance *first = lower_bound(list, list + size, 
+                                                Instance(copies->first, 0));
+            for (const Instance *location = first; location < list + size 
+                 and location->file_path_index() == copies->first; 
+                 location++) {
+                for (size_t k = 0; k < copies->second.size(); k++) {
+                    queryAliases.push_back(Instance(copies->second[k], 
+                                                    location->lineNum()));
+                }
+            }
+        }
+    }
+
+    //a line found by several case variants is only kept once 
+    sortLocations(queryAliases);
+    queryAliases.erase(unique(queryAliases.begin(), queryAliases.end()), 
+                       queryAliases.end());
+    LocationList list = {queryAliases.data(), queryAliases.size()};
+    lists.push_back(list);
+}
+
+/*
+ * name:      runQuery 
+ * purpose:   answers a query of a word 
+ * arguments: a string with a word that was queried (already stripped) 
+ * returns:   none 
+ * effects:   looks the word up in every case or only as written (by the 
+ *            Case policy) and lets the Mode policy answer from the counts 
+ *            the index keeps if it can. Otherwise prints the Case's not 
+ *            found message if there are no locations, or adds the lines of
+ *            common words and copies of files and hands the lists to the 
+ *            Mode. Each pair of policies compiles to its own function, so 
+ *            no query checks its case or mode again once it has started. 
+*/
+template<typename Case, typename Mode>
+void gerp::runQuery(string &word) {
+    lock_guard<mutex> guard(indexLock);
+    vector<LocationList> lists;
+    size_t lines = 0, files = 0;
+
+    bool found = findLocations(word, Case::INSENSITIVE, lists, lines, files);
+    if (Mode::byCounts(*this, word, found, lines, files, Case::notFound())) {
+        return;
+    }
+
+    //print not found if there are no locations 
+    if (not found) {
+        Mode::missing(*this);
+        printMessage(word + Case::notFound());
+        return;
+    }
+
+    addDenseLists(lists);
+    addAliasLists(lists);
+    Mode::answer(*this, lists, word, Case::notFound());
+}
+
+/*
+ * name:      ResultsMode::byCounts 
+ * purpose:   answers a query for the locations of a word from its counts 
+ * arguments: the gerp, the word, whether it was found, its number of lines 
+ *            and files, and the not found message of its case 
+ * returns:   returns false, the locations themselves are always needed 
+ * effects:   none 
+*/
+bool gerp::ResultsMode::byCounts(gerp &, string &, bool, size_t, size_t, 
+                                 const char *) {
+    return false;
+}
+
+/*
+ * name:      ResultsMode::missing 
+ * purpose:   forgets the results of the last query when a word is not found
+ * arguments: the gerp 
+ * returns:   none 
+ * effects:   empties the results, so @more and @page have nothing to print 
+*/
+void gerp::ResultsMode::missing(gerp &index) {
+    index.results = PostingCursor();
+}
+
+/*
+ * name:      ResultsMode::answer 
+ * purpose:   prints the first page of the locations of a word 
+ * arguments: the gerp, the word's lists, the word, and the not found 
+ *            message of its case 
+ * returns:   none 
+ * effects:   streams out the first page of the locations in file and line 
+ *            order without repeated lines, keeping the rest for @more 
+*/
+void gerp::ResultsMode::answer(gerp &index, vector<LocationList> &lists, 
+                               string &word, const char *notFound) {
+    index.startResults(lists, word, notFound);
+}
+
+/*
+ * name:      CountMode::byCounts 
+ * purpose:   prints the number of lines and files with a word from the 
+ *            counts the index keeps, if they are right for the query 
+ * arguments: the gerp, the word, whether it was found, its number of lines 
+ *            and files, and the not found message of its case 
+ * returns:   returns true if the query was answered, false if its 
+ *            locations must be counted 
+ * effects:   prints the stored counts (or not found) unless the query is 
+ *            limited to a directory or files were deleted, or the copies of
+ *            files were not counted, since the stored counts include files 
+ *            outside the directory and deleted files. Prints that a 
+ *            word in none of the files of the directory is not found in it.
+*/
+bool gerp::CountMode::byCounts(gerp &index, string &word, bool found, 
+                               size_t lines, size_t files, 
+                               const char *notFound) {
+    if (index.scoped or index.numDead > 0 or not index.copiesCounted) {
+        if (not found and index.scoped) {
+            index.printMessage(word + " Not Found in " + index.scopePath + 
+                               ".\n");
+            return true;
+        }
+        return false;
+    }
+
+    if (lines == 0) {
+        index.printMessage(word + notFound);
+    } else {
+        index.printCount(word, lines, files);
+    }
+    return true;
+}
+
+/*
+ * name:      CountMode::missing 
+ * purpose:   does nothing when a word to count is not found 
+ * arguments: the gerp 
+ * returns:   none 
+ * effects:   none, the results of the last query are kept 
+*/
+void gerp::CountMode::missing(gerp &) {
+}
+
+/*
+ * name:      CountMode::answer 
+ * purpose:   prints the number of lines and files with a word, counted from
+ *            its locations 
+ * arguments: the gerp, the word's lists, the word, and the not found 
+ *            message of its case 
+ * returns:   none 
+ * effects:   walks only the word's locations inside the directory's range of
+ *            files (if the query has a directory) and outside deleted files,
+ *            counting lines and files. Prints a not found message if there 
+ *            are none. If the query runs out of time or reaches its limit of
+ *            results, prints the count so far and where it stopped. 
+*/
+void gerp::CountMode::answer(gerp &index, vector<LocationList> &lists, 
+                             string &word, const char *notFound) {
+    PostingCursor cursor(lists);
+    if (index.scoped) {
+        cursor.restrictFiles(index.scopeFirst, index.scopeEnd);
+    }
+    cursor.skipFiles(index.skippedFiles());
+
+    //count the lines, and the files they are in, under the directory, 
+    //until the query runs out of time or results 
+    size_t lines = 0, files = 0, lastFile = 0;
+    cursor.forEach([&](Instance location) {
+        if (index.budget.expired() or index.budget.full(lines)) {
+            return false;
+        }
+        size_t file = location.file_path_index();
+        if (lines == 0 or file != lastFile) {
+            files++;
+            lastFile = file;
+        }
+        lines++;
+        return true;
+    });
+
+    //a count that was cut short is only the count so far 
+    if (index.budget.reason() != queryGuard::NONE) {
+        if (lines > 0) {
+            index.printCount(word, lines, files);
+        }
+        index.printTruncated(lines);
+    } else if (lines == 0 and index.scoped) {
+        index.printMessage(word + " Not Found in " + index.scopePath + ".\n");
+    } else if (lines == 0) {
+        index.printMessage(word + notFound);
+    } else {
+        index.printCount(word, lines, files);
+    }
+}
+
+/*
+ * name:      FilesMode::byCounts 
+ * purpose:   answers a query for the files of a word from its counts 
+ * arguments: the gerp, the word, whether it was found, its number of lines 
+ *            and files, and the not found message of its case 
+ * returns:   returns false, the locations themselves are always needed 
+ * effects:   none 
+*/
+bool gerp::FilesMode::byCounts(gerp &, string &, bool, size_t, size_t, 
+                               const char *) {
+    return false;
+}
+
+/*
+ * name:      FilesMode::missing 
+ * purpose:   does nothing when a word to list the files of is not found 
+ * arguments: the gerp 
+ * returns:   none 
+ * effects:   none, the results of the last query are kept 
+*/
+void gerp::FilesMode::missing(gerp &) {
+}
+
+/*
+ * name:      FilesMode::answer 
+ * purpose:   prints each file that contains a word, once 
+ * arguments: the gerp, the word's lists, the word, and the not found 
+ *            message of its case 
+ * returns:   none 
+ * effects:   walks the word's locations a file at a time (skipping over the
+ *            rest of each file's locations) and prints each file's path 
+ *            under the directory of the query (if any), without opening any
+ *            of the files, until the query runs out of time or results. 
+ *            Leaves out files that are not in the path table (a damaged 
+ *            index file). Prints a not found message if there are none. 
+*/
+void gerp::FilesMode::answer(gerp &index, vector<LocationList> &lists, 
+                             string &word, const char *notFound) {
+    if (not index.scoped) {
+        index.prefetchLists(lists);
+    }
+    PostingCursor files(lists);
+    if (index.scoped) {
+        files.restrictFiles(index.scopeFirst, index.scopeEnd);
+    }
+    files.skipFiles(index.skippedFiles());
+    size_t file = 0, listed = 0;
+    string path, buffer;
+    while (not index.budget.expired() and not index.budget.full(listed) and 
+           files.nextFile(file)) {
+        if (file >= index.paths.size()) {
+            continue;
+        }
+        path.clear();
+        buffer.clear();
+        index.paths.appendPath(file, path);
+        index.writer.listFile(buffer, path, file);
+        index.output << buffer;
+        listed++;
+    }
+
+    if (index.budget.reason() != queryGuard::NONE) {
+        index.printTruncated(listed);
+    } else if (listed == 0 and index.scoped) {
+        index.printMessage(word + " Not Found in " + index.scopePath + ".\n");
+    } else if (listed == 0) {
+        index.printMessage(word + notFound);
+    }
+}
+
+/*
+ * name:      ContextMode::byCounts 
+ * purpose:   answers a query for the lines around a word from its counts 
+ * arguments: the gerp, the word, whether it was found, its number of lines 
+ *            and files, and the not found message of its case 
+ * returns:   returns false, the locations themselves are always needed 
+ * effects:   none 
+*/
+bool gerp::ContextMode::byCounts(gerp &, string &, bool, size_t, size_t, 
+                                 const char *) {
+    return false;
+}
+
+/*
+ * name:      ContextMode::missing 
+ * purpose:   does nothing when a word to print the lines around is not found
+ * arguments: the gerp 
+ * returns:   none 
+ * effects:   none, the results of the last query are kept 
+*/
+void gerp::ContextMode::missing(gerp &) {
+}
+
+/*
+ * name:      ContextMode::answer 
+ * purpose:   prints each location of a word with the lines around it 
+ * arguments: the gerp, the word's lists, the word, and the not found 
+ *            message of its case 
+ * returns:   none 
+ * effects:   walks the word's locations under the directory of the query 
+ *            (if any) and outside deleted files in file and line order, 
+ *            handing them to outputContext in batches that never split a 
+ *            file, so the windows of a file can be merged. Every location is
+ *            printed (until the query runs out of time or results, which is 
+ *            then printed); the results kept for @more are left alone. 
+ *            Prints a not found message if there are none. 
+*/
+void gerp::ContextMode::answer(gerp &index, vector<LocationList> &lists, 
+                               string &word, const char *notFound) {
+    if (not index.scoped) {
+        index.prefetchLists(lists);
+    }
+    PostingCursor cursor(lists);
+    if (index.scoped) {
+        cursor.restrictFiles(index.scopeFirst, index.scopeEnd);
+    }
+    cursor.skipFiles(index.skippedFiles());
+
+    //print a batch once it is full and the next location starts a file, 
+    //until the query runs out of time or results 
+    vector<Instance> batch;
+    bool first = true;
+    size_t taken = 0, shown = 0;
+    cursor.forEach([&](Instance location) {
+        if (index.budget.expired() or index.budget.full(taken)) {
+            return false;
+        }
+        if (batch.size() >= RENDER_BATCH and location.file_path_index() != 
+                                             batch.back().file_path_index()) {
+            size_t written = index.outputContext(batch, first);
+            shown += written;
+            if (written < batch.size()) {
+                return false;
+            }
+            batch.clear();
+        }
+        batch.push_back(location);
+        taken++;
+        return true;
+    });
+    if (not batch.empty() and shown == taken - batch.size()) {
+        shown += index.outputContext(batch, first);
+    }
+
+    if (index.budget.reason() != queryGuard::NONE) {
+        index.printTruncated(shown);
+    } else if (first and index.scoped) {
+        index.printMessage(word + " Not Found in " + index.scopePath + ".\n");
+    } else if (first) {
+        index.printMessage(word + notFound);
+    }
+}
+
+/*
+ * name:      printMatches 
+ * purpose:   prints every line that contains a substring or matches a 
+ *            regular expression 
+ * arguments: a string with the pattern, whether it is a regular expression 
+ *            (ECMAScript syntax) or plain text, and whether to ignore case 
+ * returns:   none 
+ * effects:   uses the trigram index to find the lines that could match, 
+ *            checks each of them against the pattern on the thread pool 
+ *            (reading only those lines, through the line index), and streams
+ *            out the first page of matching lines like a word query. Prints a
+ *            message if the pattern is not valid, if the index was built 
+ *            without trigrams, or if no line matches. If the query runs out 
+ *            of time while checking lines, prints that it stopped instead. 
+*/
+void gerp::printMatches(string &pattern, bool isRegex, bool insensitive) {
+    lock_guard<mutex> guard(indexLock);
+    results = PostingCursor();
+    matches.clear();
+
+    if (not options.trigrams) {
+        printMessage("Substring and regular expression searches need the "
+                     "index built with --trigrams.\n");
+        return;
+    }
+
+    //compile the regular expression, and find the text every match has 
+    regex compiled;
+    vector<string> literals;
+    if (isRegex) {
+        try {
+            regex::flag_type flags = regex::ECMAScript | regex::optimize;
+            if (insensitive) {
+                flags |= regex::icase;
+            }
+            compiled.assign(pattern, flags);
+        } catch (const regex_error &e) {
+            printMessage(pattern + " is not a valid regular expression.\n");
+            return;
+        }
+        literals = trigramIndex::requiredLiterals(pattern);
+    } else {
+        literals.push_back(pattern);
+    }
+
+    //lowercase the text once so each line is only lowercased once 
+    string text = pattern;
+    if (not isRegex and insensitive) {
+        makeLowerInPlace(text);
+    }
+
+    vector<Instance> candidates;
+    findCandidates(literals, candidates);
+
+    //find where each file's candidates start 
+    vector<size_t> starts;
+    for (size_t i = 0; i < candidates.size(); i++) {
+        if (i == 0 or candidates[i].file_path_index() != 
+                      candidates[i - 1].file_path_index()) {
+            starts.push_back(i);
+        }
+    }
+    starts.push_back(candidates.size());
+
+    //check the candidates of each file in parallel, until the query runs 
+    //out of time 
+    size_t runs = starts.size() - 1;
+    vector<vector<Instance>> found(runs);
+    pool.run(runs, [&](size_t run) {
+        if (budget.late()) {
+            return;
+        }
+        verifyFile(&candidates[starts[run]], starts[run + 1] - starts[run],
+                   isRegex ? &compiled : nullptr, text, insensitive, 
+                   found[run]);
+    });
+    if (budget.check()) {
+        printTruncated(0);
+        return;
+    }
+    for (size_t i = 0; i < runs; i++) {
+        matches.insert(matches.end(), found[i].begin(), found[i].end());
+    }
+
+    //print not found if no line matched 
+    if (matches.empty()) {
+        if (scoped and scopeFound) {
+            printMessage(pattern + " Not Found in " + scopePath + ".\n");
+        } else if (not scoped) {
+            printMessage(pattern + " Not Found.\n");
+        }
+        return;
+    }
+
+    vector<LocationList> lists;
+    LocationList list = {matches.data(), matches.size()};
+    lists.push_back(list);
+    addAliasLists(lists);
+    startResults(lists, pattern, " Not Found.\n");
+}
+
+/*
+ * name:      findCandidates 
+ * purpose:   finds the lines that could contain some literals 
+ * arguments: a vector of strings that every matching line contains and a 
+ *            vector to store the candidate lines in 
+ * returns:   none 
+ * effects:   intersects the lines of each trigram of the literals. If the 
+ *            literals are too short to have trigrams, every line is a 
+ *            candidate. Only lines under the directory of the query (if any,
+ *            and no file has copies) and outside deleted files and copies 
+ *            of other files are kept. 
+*/
+void gerp::findCandidates(vector<string> &literals, 
+                          vector<Instance> &candidates) {
+    //a copy under the directory may be of a file outside it, so with copies
+    //the directory is only applied to the results 
+    size_t first = 0, end = paths.size();
+    bool inScope = scoped and aliases.empty();
+    const vector<bool> *skipped = numDead > 0 ? &deadFiles : nullptr;
+    if (inScope) {
+        first = scopeFirst;
+        end = scopeEnd;
+        skipped = skippedFiles();
+    }
+
+    //without trigrams to go on, every line has to be checked 
+    if (not trigrams.candidates(literals, candidates)) {
+        for (size_t file = first; file < end; file++) {
+            if ((skipped != nullptr and file < skipped->size() and 
+                 (*skipped)[file]) or 
+                (file < isAlias.size() and isAlias[file])) {
+                continue;
+            }
+            size_t count = lineStarts.numLines(file);
+            for (size_t line = 1; line <= count; line++) {
+                candidates.push_back(Instance(file, line));
+            }
+        }
+        return;
+    }
+
+    //keep only the candidates under the directory and in live files 
+    if (inScope or skipped != nullptr) {
+        size_t kept = 0;
+        for (size_t i = 0; i < candidates.size(); i++) {
+            size_t file = candidates[i].file_path_index();
+            bool skip = skipped != nullptr and file < skipped->size() and 
+                        (*skipped)[file];
+            if (file >= first and file < end and not skip) {
+                candidates[kept++] = candidates[i];
+            }
+        }
+        candidates.resize(kept);
+    }
+}
+
+/*
+ * name:      verifyFile 
+ * purpose:   checks which candidate lines of one file really match 
+ * arguments: a pointer to candidate lines in the same file (in line order),
+ *            the number of candidates, a pointer to the compiled regular 
+ *            expression (nullptr for a substring search), the substring 
+ *            (lowercase if insensitive), whether to ignore case, and a 
+ *            vector to add the matching lines to 
+ * returns:   none 
+ * effects:   reads each candidate line from the file with the line index 
+ *            and tests it. Finds nothing in a file that cannot be opened 
+ *            (such as one deleted since it was indexed) or that is not in 
+ *            the path table (a damaged index file). Safe to run on several 
+ *            threads at once. 
+*/
+void gerp::verifyFile(const Instance *candidates, size_t count, 
+                      const regex *pattern, const string &text, 
+                      bool insensitive, vector<Instance> &found) {
+    size_t file = candidates[0].file_path_index();
+    if (file >= paths.size()) {
+        return;
+    }
+    string path = paths.path(file);
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+
+    //test each candidate line 
+    string line;
+    for (size_t i = 0; i < count; i++) {
+        size_t lineNum = candidates[i].lineNum();
+        if (not lineStarts.readLine(fd, file, lineNum, line)) {
+            continue;
+        }
+
+        bool match;
+        if (pattern != nullptr) {
+            match = regex_search(line, *pattern);
+        } else {
+            if (insensitive) {
+                makeLowerInPlace(line);
+            }
+            match = line.find(text) != string::npos;
+        }
+
+        if (match) {
+            found.push_back(candidates[i]);
+        }
+    }
+    close(fd);
+}
+
+/*
+ * name:      setScope 
+ * purpose:   limits the next query to the files under a directory 
+ * arguments: a string with the path of an indexed directory 
+ * returns:   none 
+ * effects:   finds the directory in the path table and stores its range of 
+ *            file numbers for the next query. If files were added under 
+ *            the directory since it was indexed, widens the range to cover
+ *            them and marks the files in it that are not under the 
+ *            directory (or are deleted) to be skipped, which costs a bit 
+ *            per file in the range. If the directory was not indexed, 
+ *            prints a message and stores an empty range so the next query 
+ *            has no results. 
+*/
+void gerp::setScope(string &dirPath) {
+    lock_guard<mutex> guard(indexLock);
+    size_t directory = 0;
+
+    scoped = true;
+    scopePath = dirPath;
+    scopeFound = paths.findDirectory(dirPath, directory);
+
+    if (not scopeFound) {
+        printMessage(dirPath + " Not Found.\n");
+        scopeFirst = scopeEnd = 0;
+        return;
+    }
+    paths.fileRange(directory, scopeFirst, scopeEnd);
+    const vector<pair<size_t, size_t>> &later = 
+        paths.laterRanges(directory);
+    if (later.empty()) {
+        return;
+    }
+
+    //cover the files added later too, skipping the ones in between 
+    vector<pair<size_t, size_t>> ranges = later;
+    if (scopeFirst < scopeEnd) {
+        ranges.push_back(make_pair(scopeFirst, scopeEnd));
+    }
+    scopeFirst = scopeFirst < scopeEnd ? min(scopeFirst, later[0].first) : 
+                                         later[0].first;
+    scopeEnd = later.back().second;
+    scopeSkip.assign(scopeEnd, true);
+    for (size_t i = 0; i < ranges.size(); i++) {
+        for (size_t file = ranges[i].first; file < ranges[i].second; 
+             file++) {
+            scopeSkip[file] = file < deadFiles.size() and deadFiles[file];
+        }
+    }
+}
+
+/*
+ * name:      skippedFiles 
+ * purpose:   gets the files the current query leaves out 
+ * arguments: none 
+ * returns:   a pointer to a vector with true for each file to leave out 
+ *            (files past its end are kept), or nullptr if there are none 
+ * effects:   none. The skipped files of a directory with files added since
+ *            it was indexed include the deleted files, so the deleted files
+ *            alone are only given without one. 
+*/
+const vector<bool> *gerp::skippedFiles() {
+    if (not scopeSkip.empty()) {
+        return &scopeSkip;
+    }
+    return numDead > 0 ? &deadFiles : nullptr;
+}
+
+/*
+ * name:      clearScope 
+ * purpose:   lets queries search every file again 
+ * arguments: none
+ * returns:   none 
+ * effects:   resets the variables for the directory of the query 
+*/
+void gerp::clearScope() {
+    scoped = false;
+    scopeFound = false;
+    scopePath = "";
+    scopeFirst = scopeEnd = 0;
+    scopeSkip.clear();
+}
+
+/*
+ * name:      prefetchLists 
+ * purpose:   starts reading the lists of a query from the index file 
+ * arguments: a vector of the location lists of the query 
+ * returns:   none 
+ * effects:   asks the index file (if the index is on disk) to read the 
+ *            start of each of its lists in the background, so the lists of 
+ *            every variant of a word are read at once rather than as the 
+ *            merge reaches each one. Lists in memory are left alone. 
+*/
+void gerp::prefetchLists(const vector<LocationList> &lists) {
+    if (not disk.isOpen()) {
+        return;
+    }
+    for (size_t i = 0; i < lists.size(); i++) {
+        disk.prefetch(lists[i]);
+    }
+}
+
+/*
+ * name:      startResults 
+ * purpose:   starts streaming the results of a new query 
+ * arguments: a vector of the sorted location lists of the query, a 
+ *            string with the word that was queried, and the message to 
+ *            print after it if it is not found 
+ * returns:   none 
+ * effects:   starts reading the heads of the lists in the index file (if 
+ *            any) together, replaces the results of the previous query 
+ *            with a cursor over the given lists (keeping the segments and 
+ *            decoded locations they point into), limits them to the 
+ *            directory of the query (if any), leaves out deleted files, 
+ *            ranks them by file if ranking is on, and prints the first 
+ *            page. Prints a message if the directory (or the files that are
+ *            left) has no results. 
+*/
+void gerp::startResults(vector<LocationList> &lists, string &word, 
+                        const char *notFound) {
+    //a query of a directory seeks past the heads of the lists 
+    if (not scoped) {
+        prefetchLists(lists);
+    }
+
+    results = PostingCursor(lists);
+    resultSegments = querySegments;
+    resultDecoded.swap(queryDecoded);
+    resultAliases.swap(queryAliases);
+    if (scoped) {
+        results.restrictFiles(scopeFirst, scopeEnd);
+    }
+    const vector<bool> *skipped = skippedFiles();
+    if (skipped == &scopeSkip) {
+        resultSkip = scopeSkip;
+        skipped = &resultSkip;
+    }
+    results.skipFiles(skipped);
+    if (rankFiles) {
+        results.rankByFile();
+    }
+
+    //the word is in the index, but not under the directory 
+    if (scoped and results.done()) {
+        if (scopeFound) {
+            printMessage(word + " Not Found in " + scopePath + ".\n");
+        }
+        return;
+    }
+
+    //the word is in the index, but only in deleted files, which reads the 
+    //same as a word that was never there 
+    if (results.done()) {
+        printMessage(word + notFound);
+        return;
+    }
+
+    currentPage = 1;
+    printPage();
+}
+
+/*
+ * name:      gotoPage 
+ * purpose:   prints a page of the results of the last query 
+ * arguments: a size_t with the number of the page to print, starting at 1 
+ * returns:   none 
+ * effects:   continues from where the cursor stopped when the page is the 
+ *            next one, otherwise moves the cursor to the start of the page.
+ *            Prints a message if the page is past the last result. 
+*/
+void gerp::gotoPage(size_t page) {
+    lock_guard<mutex> guard(indexLock);
+    //pages only exist when there is a limit, and start before SIZE_MAX 
+    if (page == 0 or pageSize == 0 or page - 1 > SIZE_MAX / pageSize) {
+        printMessage("No page " + to_string(page) + ".\n");
+        return;
+    }
+
+    //move the cursor unless it is already at the start of the page 
+    if (page != currentPage + 1 or results.position() != currentPage * 
+                                                        pageSize) {
+        results.restart();
+        results.skip((page - 1) * pageSize);
+    }
+    currentPage = page;
+
+    if (results.done()) {
+        printMessage("No page " + to_string(page) + ".\n");
+        return;
+    }
+    printPage();
+}
+
+/*
+ * name:      printPage 
+ * purpose:   prints the next page of results from the cursor 
+ * arguments: none
+ * returns:   none 
+ * effects:   prints up to pageSize results (all of them if there is no 
+ *            limit), then a line saying how to get the next page if there 
+ *            are results left. If the query runs out of time or results, 
+ *            stops (leaving the cursor at the first result not printed) and
+ *            prints where and why instead. 
+*/
+void gerp::printPage() {
+    vector<Instance> batch;
+    Instance location;
+    size_t printed = 0;
+
+    //take results in batches until the page is full, they run out, or the 
+    //query runs out of time or results 
+    while (pageSize == 0 or printed < pageSize) {
+        batch.clear();
+        while (batch.size() < RENDER_BATCH and 
+               (pageSize == 0 or printed < pageSize) and 
+               not budget.expired() and not budget.full(printed) and 
+               results.next(location)) {
+            batch.push_back(location);
+            printed++;
+        }
+
+        if (batch.empty()) {
+            break;
+        }
+
+        //put the results that were not written back on the cursor 
+        size_t written = outputLocations(batch);
+        if (written < batch.size()) {
+            size_t position = results.position() - (batch.size() - written);
+            results.restart();
+            results.skip(position);
+            printed -= batch.size() - written;
+            break;
+        }
+    }
+
+    //say where the query stopped, or tell the client how to continue if 
+    //the page was cut short 
+    if (budget.reason() != queryGuard::NONE) {
+        printTruncated(printed);
+    } else if (pageSize != 0 and not results.done()) {
+        printMessage("-- more results, @more or @page " + 
+                     to_string(currentPage + 1) + " --\n");
+    }
+}
+
+/*
+ * name:      outputLocations
+ * purpose:   prints a batch of locations to the output file in order 
+ * arguments: a reference to a vector of locations 
+ * returns:   a size_t with the number of locations written, fewer than in 
+ *            the batch if the query ran out of time while rendering it 
+ * effects:   splits the batch into runs of locations in the same file, 
+ *            renders each run into its own buffer on the thread pool (one 
+ *            pass through each file), then writes the buffers in the order of
+ *            the batch. The output is the same as printing each location on 
+ *            its own. A file is not rendered once the query is out of time, 
+ *            and nothing from it or after it is written. 
+*/
+size_t gerp::outputLocations(vector<Instance> &locations) {
+    //find where each run of locations in the same file starts 
+    vector<size_t> starts;
+    for (size_t i = 0; i < locations.size(); i++) {
+        if (i == 0 or locations[i].file_path_index() != 
+                      locations[i - 1].file_path_index()) {
+            starts.push_back(i);
+        }
+    }
+    starts.push_back(locations.size());
+
+    //render each run in parallel, skipping the files reached after the 
+    //query ran out of time 
+    size_t runs = starts.size() - 1;
+    vector<string> buffers(runs);
+    vector<char> skipped(runs, false);
+    pool.run(runs, [&](size_t run) {
+        if (budget.late()) {
+            skipped[run] = true;
+            return;
+        }
+        renderFile(&locations[starts[run]], starts[run + 1] - starts[run],
+                   buffers[run]);
+    });
+
+    //write the runs in their original order, up to the first one skipped 
+    for (size_t i = 0; i < runs; i++) {
+        if (skipped[i]) {
+            budget.check();
+            return starts[i];
+        }
+        output << buffers[i];
+    }
+    return locations.size();
+}
+
+/*
+ * name:      renderFile
+ * purpose:   formats the lines of one file at the given locations 
+ * arguments: a pointer to locations in the same file (in line order), the 
+ *            number of locations, and a string to append the lines to 
+ * returns:   none 
+ * effects:   reads through the file once and appends each location's line 
+ *            to the buffer in the output format ("path:line: text" in text),
+ *            keeping track of where each line starts. Appends nothing for 
+ *            a file that cannot be opened (such as one deleted since it was
+ *            indexed) or that is not in the path table (a damaged index 
+ *            file). Safe to run on several threads at once. 
+*/
+void gerp::renderFile(const Instance *locations, size_t count, 
+                      string &buffer) {
+    //get the path of the file the locations are in and open it 
+    size_t file = locations[0].file_path_index();
+    if (file >= paths.size()) {
+        return;
+    }
+    string path = paths.path(file);
+    ifstream input(path);
+    if (not input.is_open()) {
+        return;
+    }
+    writer.fileStart(buffer, path, file);
+
+    string line;    //store line
+    size_t line_number = 1, next = 0;    //line we are at, next location 
+    uint64_t offset = 0;    //where the line starts in the file 
+
+    //go through each line until every location in the file is reached 
+    while (next < count and getline(input, line)) {
+        //if the next location's line is reached, format it 
+        if (line_number == locations[next].lineNum()) {
+            writer.line(buffer, path, file, line_number, offset, line.data(),
+                        line.length(), false);
+            next++;
+        }
+
+        line_number++;
+        offset += line.length() + 1;
+    }
+    input.close();
+}
+
+/*
+ * name:      outputContext 
+ * purpose:   prints a batch of locations to the output file with the lines 
+ *            around them 
+ * arguments: a reference to a vector of locations (in file and line order, 
+ *            with every location of each of its files) and a reference to a
+ *            bool that is true until something has been printed 
+ * returns:   a size_t with the number of locations written, fewer than in 
+ *            the batch if the query ran out of time while rendering it 
+ * effects:   splits the batch into runs of locations in the same file, 
+ *            renders each run on the thread pool, then writes the runs in 
+ *            order with a gap between them. Sets first to false once a run 
+ *            is written. A file is not rendered once the query is out of 
+ *            time, and nothing from it or after it is written. 
+*/
+size_t gerp::outputContext(vector<Instance> &locations, bool &first) {
+    //find where each run of locations in the same file starts 
+    vector<size_t> starts;
+    for (size_t i = 0; i < locations.size(); i++) {
+        if (i == 0 or locations[i].file_path_index() != 
+                      locations[i - 1].file_path_index()) {
+            starts.push_back(i);
+        }
+    }
+    starts.push_back(locations.size());
+
+    //render each run in parallel, skipping the files reached after the 
+    //query ran out of time 
+    size_t runs = starts.size() - 1;
+    vector<string> buffers(runs);
+    vector<char> skipped(runs, false);
+    pool.run(runs, [&](size_t run) {
+        if (budget.late()) {
+            skipped[run] = true;
+            return;
+        }
+        renderContext(&locations[starts[run]], starts[run + 1] - starts[run],
+                      buffers[run]);
+    });
+
+    //write the runs in their original order, apart from each other, up to 
+    //the first one skipped 
+    for (size_t i = 0; i < runs; i++) {
+        if (skipped[i]) {
+            budget.check();
+            return starts[i];
+        }
+        if (buffers[i].empty()) {
+            continue;
+        }
+        if (not first) {
+            string gap;
+            writer.gap(gap);
+            output << gap;
+        }
+        output << buffers[i];
+        first = false;
+    }
+    return locations.size();
+}
+
+/*
+ * name:      renderContext 
+ * purpose:   formats the lines of one file at and around the given 
+ *            locations 
+ * arguments: a pointer to locations in the same file (in line order), the 
+ *            number of locations, and a string to append the lines to 
+ * returns:   none 
+ * effects:   merges the windows of contextLines lines before and after each
+ *            location where they overlap or touch, then appends each window
+ *            in the output format with a gap between windows. In text, a 
+ *            location's own line is printed as "path:line: text", the lines
+ *            around it as "path-line- text", and the gap as "--". Nothing 
+ *            is appended if none of the lines are found. If the line 
+ *            offsets of the file were recorded, each window is read with a 
+ *            single pread, so the work done follows the size of the output;
+ *            otherwise the file is read from the top up to the end of its 
+ *            last window. Appends nothing for a file that cannot be 
+ *            opened (such as one deleted since it was indexed) or that is 
+ *            not in the path table (a damaged index file). Safe to run on 
+ *            several threads at once. 
+*/
+void gerp::renderContext(const Instance *locations, size_t count, 
+                         string &buffer) {
+    size_t file = locations[0].file_path_index();
+    if (file >= paths.size()) {
+        return;
+    }
+    string path = paths.path(file);
+
+    //merge the windows of the locations, first and last line of each 
+    vector<pair<size_t, size_t>> windows;
+    for (size_t i = 0; i < count; i++) {
+        size_t line = locations[i].lineNum();
+        size_t start = line > contextLines ? line - contextLines : 1;
+        size_t end = contextLines > SIZE_MAX - line ? SIZE_MAX 
+                                                     : line + contextLines;
+        if (not windows.empty() and start - 1 <= windows.back().second) {
+            windows.back().second = max(windows.back().second, end);
+        } else {
+            windows.push_back(make_pair(start, end));
+        }
+    }
+
+    //append one line of a window, marking it if it is not a location, 
+    //after the start of the file or a gap if it is the first of its window
+    size_t next = 0, window = 0, begin = buffer.length();
+    auto append = [&](size_t number, uint64_t offset, const char *text, 
+                      size_t length) {
+        while (next < count and locations[next].lineNum() < number) {
+            next++;
+        }
+        bool context = next == count or locations[next].lineNum() != number;
+        if (buffer.length() == begin) {
+            writer.fileStart(buffer, path, file);
+        } else if (number == windows[window].first) {
+            writer.gap(buffer);
+        }
+        writer.line(buffer, path, file, number, offset, text, length, 
+                    context);
+    };
+
+    //slice each window straight out of the file with its line offsets 
+    size_t numLines = lineStarts.numLines(file);
+    if (numLines > 0) {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+        string text;
+        uint64_t offset = 0, unused = 0;
+        for (; window < windows.size(); window++) {
+            size_t start = windows[window].first;
+            size_t end = min(windows[window].second, numLines);
+            if (start > end or 
+                not lineStarts.lineBounds(file, start, offset, unused) or
+                not lineStarts.readLines(fd, file, start, end, text)) {
+                continue;
+            }
+
+            //split the run back into its lines 
+            size_t position = 0;
+            for (size_t line = start; line <= end; line++) {
+                size_t stop = text.find('\n', position);
+                if (stop == string::npos) {
+                    stop = text.length();
+                }
+                append(line, offset + position, text.data() + position, 
+                       stop - position);
+                position = stop + 1;
+            }
+        }
+        close(fd);
+        return;
+    }
+
+    //without offsets, read through the file to the end of the last window 
+    ifstream input(path);
+    if (not input.is_open()) {
+        return;
+    }
+    string line;
+    size_t number = 1;
+    uint64_t offset = 0;
+    while (window < windows.size() and getline(input, line)) {
+        if (number >= windows[window].first) {
+            append(number, offset, line.data(), line.length());
+        }
+        if (number == windows[window].second) {
+            window++;
+        }
+        number++;
+        offset += line.length() + 1;
+    }
+    input.close();
 }
@@ -5,17 +5,31 @@
  *
  *  Gerp is a class with the ability to build an index of words based on a file
  *  directory provided by the client and handle queries from the client on the
- *  index, storing the results of those queries in a provided output file. 
- *  Queries include searching for a word in the directory regardless of case 
+ *  index, storing the results of those queries in a provided output file.
+ *  Queries include searching for a word in the directory regardless of case
  *  sensitive letters, and searching for a word with specific case sensitivity.
- *  Clients also have the ability to change output files while running the 
- *  program. Gerp will produce an error message to the client should a queried
- *  word not be found in the directory; for case sensitive searches, it will 
- *  also recommend that the user do a case insensitive search. Gerp interacts 
- *  with FSTree and DirNode to build a file system tree based on the given 
- *  directory, hashTable to build an index of words and their locations in the
- *  directory, and stringProcessing to remove leading and trailing non alpha
- *  numeric when inserting and searching for words. 
+ *  Clients also have the ability to change output files while running the
+ *  program, to limit queries to a number of results per page and ask for later
+ *  pages, to rank results by the files with the most matches, to ask only for
+ *  the number of matching lines or the matching files, to ask for how often a
+ *  word and each of its case variants occur, to limit a query to the files
+ *  under one directory, and to add files to the index without rebuilding it.
+ *  With --watch, the index also follows the files as they are written, moved
+ *  and deleted, which corpusWatcher reports. When built with trigrams, clients
+ *  can also search for any substring or regular expression, not just whole
+ *  words. Gerp will produce an error message to the client should a queried
+ *  word not be found in the directory; for case sensitive searches, it will
+ *  also recommend that the user do a case insensitive search. Gerp interacts
+ *  with dirWalker and fileFilter to visit each text file in the given
+ *  directory (skipping binary, oversized, and excluded files), fileReader to
+ *  read the files ahead of indexing them, hashTable to build an index of words
+ *  and their locations in the directory (or spimiBuilder and diskIndex to
+ *  build it on disk within a memory budget, sharedIndex to save it for other
+ *  processes to map, with bloomFilter in front to turn away words that are not
+ *  there, roaringBitmap for the lines of the most common words, and
+ *  contentHash to index the words of identical files only once), and
+ *  stringProcessing to remove leading and trailing non alpha numeric when
+ *  inserting and searching for words.
  *
 */
 
@@ -23,52 +37,378 @@
 #define GERP_H
 
 #include "hashTable.h"
-#include "FSTree.h"
-#include "DirNode.h"
+#include "postingCursor.h"
+#include "threadPool.h"
+#include "dirWalker.h"
+#include "fileFilter.h"
+#include "fileReader.h"
+#include "pathTable.h"
+#include "lineIndex.h"
+#include "trigramIndex.h"
+#include "spimiBuilder.h"
+#include "diskIndex.h"
+#include "sharedIndex.h"
+#include "bloomFilter.h"
+#include "roaringBitmap.h"
+#include "contentHash.h"
+#include "segmentSet.h"
+#include "corpusWatcher.h"
 #include "stringProcessing.h"
+#include "resultWriter.h"
+#include "queryGuard.h"
 #include <sstream>
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <regex>
+#include <mutex>
+#include <unordered_map>
+#include <map>
+#include <deque>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+// 
+//  gerpOptions struct, used to choose the optional parts of the index that 
+//  are built from the command line (the trigrams, which also need the line
+//  offsets, and the line offsets alone), the memory budget (in bytes, 0 for 
+//  none) and temporary directory for building the index on disk, 
+//  whether to keep the index up to date as files change, and which files to
+//  index: glob patterns to include and exclude, the largest file size (in 
+//  bytes, 0 for no limit), and whether to index binary files too. An index 
+//  can also be saved to a file that other processes load instead of 
+//  building their own (empty for neither), and the most common words of an
+//  index on disk read in the background as soon as it is opened. Results 
+//  are written in the given format unless @f names another one, and each 
+//  query stops after the given milliseconds and number of results (0 for 
+//  no limit) unless @timeout and @max change them. The statistics of every
+//  word can be written to a file once the index is built (empty for none) 
+// 
+struct gerpOptions {
+    bool trigrams;
+    bool lineOffsets;
+    size_t memoryBudget;
+    string tempDirectory;
+    bool watch;
+    vector<string> includes;
+    vector<string> excludes;
+    size_t maxFileBytes;
+    bool indexBinary;
+    string saveIndex;
+    string loadIndex;
+    bool prefetch;
+    resultWriter::Format format;
+    size_t timeoutMs;
+    size_t maxResults;
+    string dumpVocab;
+
+    gerpOptions() : trigrams(false), lineOffsets(false), memoryBudget(0), 
+                    tempDirectory("/tmp"), watch(false), maxFileBytes(0), 
+                    indexBinary(false), prefetch(false), 
+                    format(resultWriter::TEXT), timeoutMs(0), 
+                    maxResults(0) {}
+};
 
 class gerp {
 //public functions available to the client 
 public:
-    gerp(string directory, string outputFile);
+    gerp(string directory, string outputFile, 
+         gerpOptions indexOptions = gerpOptions());
     ~gerp();
 
     void handleQuery(istream &input);
+    void printDiagnostics(ostream &out);
 
 //private functions, comment out private keyword when testing 
 private: 
+    // 
+    //  WalkedFile struct, used to remember a file of the walk while it is 
+    //  read ahead: its directory, its name, the directories the walk 
+    //  entered and finished just before it, and the descriptors of the 
+    //  directories the walk was done with just before it 
+    // 
+    struct WalkedFile {
+        size_t directory;
+        string name;
+        vector<size_t> startedBefore;
+        vector<size_t> finishedBefore;
+        vector<int> releasedBefore;
+    };
+
+    // 
+    //  CopyCounts struct, used to store the lines and files the copies of 
+    //  files add to a word's counts, and the last file and line counted 
+    // 
+    struct CopyCounts {
+        size_t lines;
+        size_t files;
+        size_t lastFile;
+        size_t lastLine;
+    };
+
+    // 
+    //  SensitiveCase and InsensitiveCase structs, the case policies of a 
+    //  query of a word: whether every case of it is looked up, and what is 
+    //  printed after it when it is not found 
+    // 
+    struct SensitiveCase {
+        static const bool INSENSITIVE = false;
+        static const char *notFound() {
+            return " Not Found. Try with @insensitive or @i.\n";
+        }
+    };
+    struct InsensitiveCase {
+        static const bool INSENSITIVE = true;
+        static const char *notFound() {
+            return " Not Found.\n";
+        }
+    };
+
+    // 
+    //  ResultsMode, CountMode, FilesMode and ContextMode structs, the mode 
+    //  policies of a query of a word, used to choose what is done with its 
+    //  locations: print them a page at a time, count their lines and files,
+    //  print each of their files, or print them with the lines around them.
+    //  byCounts answers the query without the locations where it can, 
+    //  missing runs when the word is not found, and answer runs with the 
+    //  word's lists otherwise 
+    // 
+    struct ResultsMode {
+        static bool byCounts(gerp &index, string &word, bool found, 
+                             size_t lines, size_t files, 
+                             const char *notFound);
+        static void missing(gerp &index);
+        static void answer(gerp &index, vector<LocationList> &lists, 
+                           string &word, const char *notFound);
+    };
+    struct CountMode {
+        static bool byCounts(gerp &index, string &word, bool found, 
+                             size_t lines, size_t files, 
+                             const char *notFound);
+        static void missing(gerp &index);
+        static void answer(gerp &index, vector<LocationList> &lists, 
+                           string &word, const char *notFound);
+    };
+    struct FilesMode {
+        static bool byCounts(gerp &index, string &word, bool found, 
+                             size_t lines, size_t files, 
+                             const char *notFound);
+        static void missing(gerp &index);
+        static void answer(gerp &index, vector<LocationList> &lists, 
+                           string &word, const char *notFound);
+    };
+    struct ContextMode {
+        static bool byCounts(gerp &index, string &word, bool found, 
+                             size_t lines, size_t files, 
+                             const char *notFound);
+        static void missing(gerp &index);
+        static void answer(gerp &index, vector<LocationList> &lists, 
+                           string &word, const char *notFound);
+    };
+
     template<typename streamtype>
     void open_or_die(streamtype &stream, string &fileName);
 
     //functions for building index 
-    void treeTraversal(DirNode *root, string &path);
-    void readWords(string &file, int index);
+    void buildIndex(string &directory);
+    size_t readWords(int fd, size_t index, hashTable *into);
+    size_t indexWords(const string &contents, size_t index, hashTable *into);
+    void markRanges(const WalkedFile &file);
+    void saveShared(const string &indexFile);
+    void loadShared(const string &directory);
+    void buildFilter();
+    void buildDenseWords();
+    bool isDuplicate(size_t index, uint64_t hash, const string &contents);
+    bool sameContents(size_t file, const string &contents);
+    void countCopy(const string &word, size_t index, size_t lineNum);
+    void addCopyCounts(const string &word, bool insensitive, 
+                       size_t &numLines, size_t &numFiles);
+    void addFiles(string &path);
+    void recordInodes();
+    bool isIndexed(const struct stat &info);
+
+    //functions for keeping the index up to date as files change 
+    void startWatching();
+    void applyChanges(const vector<string> &changed, 
+                      const vector<string> &deleted);
+    void dropFile(const string &path);
 
     //functions for responding to queries 
-    void printSensitive(string &word);
-    void printInsensitive(string &word);
-    void newOutput(string &outputFile);
+    bool findLocations(string &word, bool insensitive, 
+                       vector<LocationList> &lists, size_t &numLines, 
+                       size_t &numFiles);
+    bool findBaseLocations(string &word, bool insensitive, 
+                           vector<LocationList> &lists, size_t &numLines, 
+                           size_t &numFiles);
+    template<typename Case, typename Mode>
+    void runQuery(string &word);
+    void newOutput(string &outputFile, resultWriter::Format format);
+    void printMessage(const string &text);
+    void printCount(const string &word, size_t lines, size_t files);
+    void printTruncated(size_t given);
+    void printStats(string &word);
+    void printTopKeys();
+    void dumpVocab(const string &vocabFile);
+    void appendStats(string &buffer, const hashTable::Node &node, 
+                     bool variants, const resultWriter &to);
+    void appendCopiesNote(string &buffer, const resultWriter &to);
+    void printMatches(string &pattern, bool isRegex, bool insensitive);
+    void addDenseLists(vector<LocationList> &lists);
+    void addAliasLists(vector<LocationList> &lists);
+    void prefetchLists(const vector<LocationList> &lists);
+
+    //helper functions for substring and regular expression searches 
+    void findCandidates(vector<string> &literals, 
+                        vector<Instance> &candidates);
+    void verifyFile(const Instance *candidates, size_t count, 
+                    const regex *pattern, const string &text, 
+                    bool insensitive, vector<Instance> &found);
 
-    //helper functions
-    int outputPaths(Instance &location);
-    bool checkOutput(const string &path);
+    //functions for limiting a query to the files under a directory 
+    void setScope(string &dirPath);
+    const vector<bool> *skippedFiles();
+    void clearScope();
 
-    //data structures to contain data 
-    vector<string> filepaths;
+    //functions for streaming results a page at a time 
+    void startResults(vector<LocationList> &lists, string &word, 
+                      const char *notFound);
+    void gotoPage(size_t page);
+    void printPage();
+
+    //helper functions for printing locations 
+    size_t outputLocations(vector<Instance> &locations);
+    void renderFile(const Instance *locations, size_t count, string &buffer);
+    size_t outputContext(vector<Instance> &locations, bool &first);
+    void renderContext(const Instance *locations, size_t count, 
+                       string &buffer);
+
+    //data structures to contain data, the rules for which files to index,
+    //and whether the files indexed at the start were read with io_uring 
+    gerpOptions options;
+    fileFilter fileRules;
+    bool readWithRing;
+    pathTable paths;
     hashTable table;
+    lineIndex lineStarts;
+    trigramIndex trigrams;
+
+    //builder for an index on disk, the index file once it is built, and 
+    //the shared index file when the index was loaded from one (the index 
+    //file, path table and filter then point into it) 
+    spimiBuilder builder;
+    diskIndex disk;
+    sharedIndex shared;
+    static const size_t SAVE_BUDGET = (size_t) 512 << 20;
 
-    //variables for the output file (output stream, name of current file, line
-    //we're at in that file)
+    //filter of the words in the index built at the start, and the number 
+    //of lookups in that index and of those the filter answered alone 
+    bloomFilter filter;
+    size_t baseLookups;
+    size_t filterRejects;
+
+    //line id of the first line of each file indexed at the start (and the
+    //number of lines after the last one), the lines of the words on at 
+    //least one line in DENSE_LINES and on at least MIN_DENSE_LINES lines as
+    //bitmaps of line ids, where those are smaller (their location vectors 
+    //are emptied), the bitmaps found by the last lookup, and the locations 
+    //decoded from them for the last lookup and current results
+    vector<uint32_t> lineIdStarts;
+    unordered_map<const WordLocations *, roaringBitmap> denseWords;
+    vector<const roaringBitmap *> queryBitmaps;
+    vector<Instance> queryDecoded;
+    vector<Instance> resultDecoded;
+    static const size_t DENSE_LINES = 64;
+    static const size_t MIN_DENSE_LINES = 256;
+
+    //first file indexed at the start with each hash of contents (only kept
+    //while indexing), the later files with the same contents as each such 
+    //file, true for each of those copies, and the number of copies. The 
+    //lines and files the copies add to the count of each case sensitive 
+    //word and each lowercase key, and whether they were counted (they are 
+    //not for an index loaded with --load-index). The locations repeated for
+    //the copies in the last lookup and in the current results 
+    unordered_map<uint64_t, size_t> contentFiles;
+    map<size_t, vector<size_t>> aliases;
+    vector<bool> isAlias;
+    size_t numAliases;
+    unordered_map<string, CopyCounts> copyWords;
+    unordered_map<string, CopyCounts> copyKeys;
+    bool copiesCounted;
+    vector<Instance> queryAliases;
+    vector<Instance> resultAliases;
+
+    //segments of files added after the start, and the segments that the 
+    //last lookup and the current results point into 
+    segmentSet segments;
+    vector<shared_ptr<const indexSegment>> querySegments;
+    vector<shared_ptr<const indexSegment>> resultSegments;
+
+    //variables for the output file (output stream, name of current file,
+    //and the writer of its format) 
     ofstream output;
     string curr_output;
-    int outputLine;
+    resultWriter writer;
+
+    //results of the last query (and the lines found by the last substring 
+    //or regular expression search, which the cursor reads), the number of
+    //results per page (0 for no limit), the page we are on, and whether 
+    //files are ranked by results 
+    PostingCursor results;
+    vector<Instance> matches;
+    size_t pageSize;
+    size_t currentPage;
+    bool rankFiles;
+
+    //number of lines printed before and after each location by @ctx 
+    size_t contextLines;
+
+    //most milliseconds and results each query may take (0 for no limit), 
+    //and the guard that stops the running query when it reaches either or 
+    //is cancelled 
+    size_t timeoutMs;
+    size_t maxResults;
+    queryGuard budget;
+
+    //whether the current query is limited to a directory, whether that 
+    //directory was found, its path, and its range of file numbers 
+    bool scoped;
+    bool scopeFound;
+    string scopePath;
+    size_t scopeFirst, scopeEnd;
+
+    //when files were added to the directory after it was indexed, the 
+    //files to leave out of its (widened) range: those of other directories 
+    //and deleted ones. Empty otherwise. The results keep their own copy. 
+    vector<bool> scopeSkip;
+    vector<bool> resultSkip;
+
+    //watcher of the indexed directories, the files that were deleted or 
+    //replaced since the start (true for each such file number) and how many
+    //there are, and the number of each indexed path 
+    corpusWatcher watcher;
+    vector<bool> deadFiles;
+    size_t numDead;
+    unordered_map<string, size_t> fileIds;
+
+    //number of each indexed file by its device and inode, so @add leaves 
+    //out files already in the index, and how many files have been recorded
+    //(all the files read by the build) 
+    map<pair<dev_t, ino_t>, size_t> fileInodes;
+    size_t inodesKnown;
+
+    //lock held by queries and by changes to the index, and lock held by one
+    //change to the index at a time (always taken first) 
+    mutex indexLock;
+    mutex updateLock;
 
-    //variable for case sensitivty 
-    bool insensitive;
+    //threads for rendering results, and the most results rendered at once 
+    threadPool pool;
+    static const size_t RENDER_BATCH = 4096;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,111 @@
+/*
+ *  gerpStats.cpp
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ * 
+ *  Builds the gerp index for a directory provided by the client and prints
+ *  a report of how the index is laid out: bucket chain lengths, case variants
+ *  per key, locations per word, and the bytes used by each part of the index.
+ *  Used to size memory for new directories and to compare hash functions.
+ *  Given a file of queries too, it times each query (one per line) and 
+ *  prints how long it took, to compare changes to the query code.
+ *
+*/
+
+#include "gerp.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <iostream>
+
+using namespace std;
+
+//number of times each query is run when timing queries 
+static const int RUNS = 5;
+
+/*
+ * name:      timeQueries
+ * purpose:   prints how long each query in a file takes 
+ * arguments: a reference to a gerp and a string with the path of a file of
+ *            queries, one per line 
+ * returns:   none 
+ * effects:   runs each line of the file on its own RUNS times (its results
+ *            go to the gerp's output file, and its prompts are discarded), 
+ *            and prints the fastest and median run of each in microseconds.
+ *            Throws a runtime_error if the file cannot be opened. 
+*/
+static void timeQueries(gerp &index, const string &queryFile) {
+    ifstream queries(queryFile);
+    if (not queries.is_open()) {
+        throw runtime_error("Unable to open file " + queryFile);
+    }
+
+    cout << "\nquery timings (microseconds, fastest and median of " << RUNS 
+         << " runs):\n";
+    string line;
+    ostringstream prompts;
+    while (getline(queries, line)) {
+        if (line.empty() or line == "@q" or line == "@quit") {
+            continue;
+        }
+
+        //run the query with the prompts sent nowhere 
+        vector<double> times;
+        for (int run = 0; run < RUNS; run++) {
+            istringstream input(line + "\n@q\n");
+            streambuf *saved = cout.rdbuf(prompts.rdbuf());
+            chrono::steady_clock::time_point start = 
+                chrono::steady_clock::now();
+            index.handleQuery(input);
+            chrono::steady_clock::time_point end = 
+                chrono::steady_clock::now();
+            cout.rdbuf(saved);
+            prompts.str("");
+            times.push_back(
+                chrono::duration<double, micro>(end - start).count());
+        }
+
+        sort(times.begin(), times.end());
+        cout << setw(10) << fixed << setprecision(1) << times[0] 
+             << setw(10) << times[RUNS / 2] << "  " << line << "\n";
+    }
+}
+
+/*
+ * name:      main
+ * purpose:   builds an index and prints its diagnostics 
+ * arguments: a int with number of arguments and an array with the arguments 
+ * returns:   an int of whether the program finished successfully 
+ * effects:   prints error if client did not produce correct number of 
+ *            arguments. Builds a gerp for the given directory (discarding 
+ *            query output) and prints its diagnostics to cout, then the 
+ *            timings of the queries in the query file, if one was given. 
+*/
+int main(int argc, char *argv[]) {
+    //if client does not input correct arguments, print error message
+    if (argc != 2 and argc != 3) {
+        cerr << "Usage: ./gerpStats inputDirectory [queryFile]" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    //try to build the index and report on it 
+    try {
+        gerp new_gerp(argv[1], "/dev/null");
+        new_gerp.printDiagnostics(cout);
+        if (argc == 3) {
+            timeQueries(new_gerp, argv[2]);
+        }
+    }
+
+    //print error message if indexing was not successful 
+    catch (const runtime_error &e) {
+        cerr << "Could not build index, exiting." << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    return 0;
+}
@@ -8,6 +8,11 @@
 */
 
 #include "hashTable.h"
+#include "stringProcessing.h"
+#include <algorithm>
+
+//definition of the constant declared in the class 
+const size_t hashTable::TOP_KEYS;
 
 /*
  * name:      hashTable constructor 
@@ -53,13 +58,15 @@ static size_t hashValue(KeyType key) {
 /*
  * name:      insert
  * purpose:   inserts a Key and it's location in files into the hash table
- * arguments: a KeyType with a key, an int with a file number in the
- *            directory, and an int with a line number in that file 
+ * arguments: a KeyType with a key, a size_t with a file number in the
+ *            directory, and a size_t with a line number in that file 
  * returns:   none 
  * effects:   inserts the key and location (file and line number) into the hash
- *            table, calling helper functions to achieve this
+ *            table, calling helper functions to achieve this, and counts the 
+ *            occurrence even if the word was already on that line. Throws a 
+ *            runtime_error if the location does not fit in an Instance. 
 */
-void hashTable::insert(KeyType key, int file, int line) {
+void hashTable::insert(KeyType key, size_t file, size_t line) {
     //set key to all lowercase and us lowercase string to get hash index 
     string lowercaseKey = makeLower(key);
     int index = hashValue(lowercaseKey) % currentTableSize;
@@ -71,20 +78,21 @@ void hashTable::insert(KeyType key, int file, int line) {
     if (node_index == -1) {
         //create new node at with the given lowercase key
         Node new_node(lowercaseKey);
-        //create new WordLocation with case sensitive word and location
-        WordLocations new_location(key, file, line);
-
-        //add case sensitive word to the node 
-        new_node.entries.push_back(new_location);
-        //add node to the bucket and update number of items in the table 
         chainingTable[index].nodes.push_back(new_node);
-        numItemsInTable++;        
+        node_index = chainingTable[index].nodes.size() - 1;
     } 
     
-    //otherwise, insert the word into the prexisting node 
-    else {
-        Node *existingNode = &chainingTable[index].nodes.at(node_index);
-        insertWord(key, file, line, *existingNode);
+    //insert the case sensitive word into the key's node 
+    Node *existingNode = &chainingTable[index].nodes.at(node_index);
+    insertWord(key, file, line, *existingNode);
+
+    //count the occurrence, and rank the key if it may now be one of the 
+    //most frequent (checked here so most inserts skip the call) 
+    existingNode->occurrences++;
+    if (not existingNode->ranked and 
+        (topKeys.size() < TOP_KEYS or 
+         existingNode->occurrences > topKeys.top().first)) {
+        rankKey(*existingNode);
     }
 
     //check load factor and expand if necessary 
@@ -95,15 +103,18 @@ void hashTable::insert(KeyType key, int file, int line) {
 /*
  * name:      insertWord
  * purpose:   insert the case sensitive word into the given node 
- * arguments: a KeyType with a word, a reference to an int with a file number 
- *            in the directory, a reference to an int with a line number in the 
- *            file, and a reference to a node in the table 
+ * arguments: a KeyType with a word, a size_t with a file number in the 
+ *            directory, a size_t with a line number in the file, and a 
+ *            reference to a node in the table 
  * returns:   none 
- * effects:   inserts the word into the given node in the table 
+ * effects:   inserts the word into the given node in the table and updates
+ *            the word's and the node's line and file counts 
 */
-void hashTable::insertWord(KeyType &word, int &file, int &line, Node &node) {
+void hashTable::insertWord(KeyType &word, size_t file, size_t line, 
+                           Node &node) {
     //get index of the case sensitive word (entry) in the node 
     int index = getEntriesIndex(word, node);
+    Instance newInstance(file, line);
 
     //no entry for this case sensitive word, so create new entry
     if (index == -1) {
@@ -116,14 +127,53 @@ void hashTable::insertWord(KeyType &word, int &file, int &line, Node &node) {
     } 
     
     //entry exists, so update entry with new instance (location)
-    else if (not isDuplicate(node.entries.at(index), file, line)) { 
+    else {
         //get the entry that corresponds to the given word
         WordLocations *entry = &node.entries.at(index);
+        entry->occurrences++;
 
-        //create new location and add it to the word's vector of locations
-        Instance newInstance(file, line);
+        //stop if the location is already the last one there 
+        if (isDuplicate(*entry, newInstance)) {
+            return;
+        }
+
+        //count a new file if the location starts one 
+        if (entry->location.back().file_path_index() != file) {
+            entry->numFiles++;
+        }
+
+        //add the new location to the word's vector of locations
         entry->location.push_back(newInstance);
     }
+
+    countLocation(node, newInstance);
+}
+
+/*
+ * name:      countLocation
+ * purpose:   updates the line and file counts of a node for a new location 
+ * arguments: a reference to a node and a reference to the location that was
+ *            just added to one of its case sensitive words 
+ * returns:   none 
+ * effects:   counts the location as a new line unless another variation of 
+ *            the key was already found on that line, and as a new file if it
+ *            is in a different file than the last location. Locations are 
+ *            added in file and line order, so the last one is enough. 
+*/
+void hashTable::countLocation(Node &node, Instance &location) {
+    //nothing new if another variation was on the same line 
+    if (node.numLines != 0 and node.last == location) {
+        return;
+    }
+
+    //count a new file if this is the first line of a new file 
+    if (node.numLines == 0 or 
+        node.last.file_path_index() != location.file_path_index()) {
+        node.numFiles++;
+    }
+
+    node.numLines++;
+    node.last = location;
 }
 
 /*
@@ -181,25 +231,19 @@ int hashTable::getEntriesIndex(string &word, Node &node) {
  * name:      isDuplicate
  * purpose:   checks if a location (file index and line number) already exists
  *            in the given WordLocations 
- * arguments: a reference to a WordLocations, a reference to an int with a file
- *            number in the directory, and a reference to an int with a line 
- *            number in that file 
+ * arguments: a reference to a WordLocations and a reference to an Instance 
+ *            with a location in the directory 
  * returns:   returns true if the location is equal to the last location 
  *            inserted in the WordLocations' vector of Instances, return false
  *            otherwise 
- * effects:   gets the file number and the line number of the last Instance 
- *            (location) that was inserted into the given WordLocatons, 
- *            and checks if the they are equal to the given file and line
- *            number 
+ * effects:   compares the packed file and line number of the last Instance
+ *            (location) that was inserted into the given WordLocatons with
+ *            the given location 
 */
 
-bool hashTable::isDuplicate(WordLocations &entry, int &file, int &line) {
-    //get file and line numbers for the last Instance in Wordlocations' vector
-    int filepath = entry.location.back().file_path_index;
-    int lineNum = entry.location.back().lineNum;
-
-    //checks to see if they are equal to the file and line numbers given
-    return filepath == file and lineNum == line;
+bool hashTable::isDuplicate(WordLocations &entry, Instance &location) {
+    //checks to see if the last location is equal to the location given
+    return entry.location.back() == location;
 }
 
 /*
@@ -254,42 +298,197 @@ void hashTable::expand() {
     chainingTable = newTable;
 }
 
+/*
+ * name:      findSensitiveWord
+ * purpose:   find the WordLocations struct that corresponds to the case 
+ *            sensitive key without copying it 
+ * arguments: a KeyType with a key
+ * returns:   returns a pointer to the key's WordLocations in the table, or 
+ *            nullptr if the case sensitive key does not exist in the table 
+ * effects:   searches the table for the given case sensitive key. The pointer
+ *            is only valid until the next insert. 
+*/
+
+const WordLocations *hashTable::findSensitiveWord(KeyType &key) {
+    //find the node of the lowercase key first 
+    Node *node = findNode(key);
+
+    //search through the node for the case sensitive word 
+    if (node != nullptr) {
+        int entry_index = getEntriesIndex(key, *node);
+
+        //if the case sensitive word has an entry, return it 
+        if (entry_index != -1) {
+            return &node->entries.at(entry_index); 
+        }
+    }
+
+    return nullptr;
+}
+
+/*
+ * name:      findInsensitiveWord
+ * purpose:   find the Node with every case sensitive variant of the key 
+ *            without copying it 
+ * arguments: a KeyType with a key
+ * returns:   returns a pointer to the key's Node in the table, or nullptr if 
+ *            the key does not exist in the table regardless of case 
+ * effects:   searches the table for the lowercase version of the key. The 
+ *            pointer is only valid until the next insert. 
+*/
+
+const hashTable::Node *hashTable::findInsensitiveWord(KeyType &key) {
+    return findNode(key);
+}
+
+/*
+ * name:      getNodes
+ * purpose:   collects every Node in the table 
+ * arguments: a vector to add pointers to the Nodes to 
+ * returns:   none 
+ * effects:   adds a pointer to each Node, in no particular order. The 
+ *            pointers are only valid until the next insert. 
+*/
+
+void hashTable::getNodes(vector<const Node *> &nodes) {
+    for (int i = 0; i < currentTableSize; i++) {
+        Bucket &bucket = chainingTable[i];
+        for (size_t j = 0; j < bucket.nodes.size(); j++) {
+            nodes.push_back(&bucket.nodes[j]);
+        }
+    }
+}
+
+/*
+ * name:      getNodes
+ * purpose:   collects every Node in the table so they can be changed 
+ * arguments: a vector to add pointers to the Nodes to 
+ * returns:   none 
+ * effects:   adds a pointer to each Node, in no particular order. The 
+ *            pointers are only valid until the next insert. Changing a 
+ *            Node's key or words breaks later lookups; only the locations 
+ *            may be changed. 
+*/
+
+void hashTable::getNodes(vector<Node *> &nodes) {
+    for (int i = 0; i < currentTableSize; i++) {
+        Bucket &bucket = chainingTable[i];
+        for (size_t j = 0; j < bucket.nodes.size(); j++) {
+            nodes.push_back(&bucket.nodes[j]);
+        }
+    }
+}
+
+/*
+ * name:      getTopKeys
+ * purpose:   collects the most frequent keys in the table 
+ * arguments: a vector to add pointers to the Nodes to 
+ * returns:   none 
+ * effects:   adds a pointer to each of the (up to) TOP_KEYS Nodes with the 
+ *            most occurrences, most first and then in key order, looking 
+ *            each up for its current count. The pointers are only valid 
+ *            until the next insert. 
+*/
+void hashTable::getTopKeys(vector<const Node *> &nodes) {
+    //empty a copy of the heap, so the table can keep ranking keys 
+    size_t first = nodes.size();
+    priority_queue<RankedKey, vector<RankedKey>, greater<RankedKey>> ranked =
+        topKeys;
+    while (not ranked.empty()) {
+        KeyType key = ranked.top().second;
+        nodes.push_back(findNode(key));
+        ranked.pop();
+    }
+
+    //order them by their counts now, not their counts in the heap 
+    sort(nodes.begin() + first, nodes.end(), 
+         [](const Node *a, const Node *b) {
+             if (a->occurrences != b->occurrences) {
+                 return a->occurrences > b->occurrences;
+             }
+             return a->key < b->key;
+         });
+}
+
+/*
+ * name:      rankKey
+ * purpose:   puts a key in the heap of the most frequent keys if it is now 
+ *            one of them 
+ * arguments: a reference to a Node that is not in the heap 
+ * returns:   none 
+ * effects:   pushes the key if the heap is not full. Otherwise, while the 
+ *            key has more occurrences than the heap's least, looks up the 
+ *            least key's current count: if it has grown, pushes it back 
+ *            with that count, and if not, drops it and pushes this key. A 
+ *            key that ties the least stays out. 
+*/
+void hashTable::rankKey(Node &node) {
+    while (topKeys.size() == TOP_KEYS and 
+           node.occurrences > topKeys.top().first) {
+        //take the least key off with the count it was pushed with 
+        KeyType least = topKeys.top().second;
+        size_t counted = topKeys.top().first;
+        topKeys.pop();
+
+        //push it back if it has been found since, otherwise drop it 
+        Node *leastNode = findNode(least);
+        if (leastNode->occurrences > counted) {
+            topKeys.push(RankedKey(leastNode->occurrences, least));
+        } else {
+            leastNode->ranked = false;
+        }
+    }
+
+    if (topKeys.size() < TOP_KEYS) {
+        topKeys.push(RankedKey(node.occurrences, node.key));
+        node.ranked = true;
+    }
+}
+
+/*
+ * name:      findNode
+ * purpose:   find the Node of the lowercase version of the key 
+ * arguments: a KeyType with a key in any case 
+ * returns:   returns a pointer to the Node in the table, or nullptr if there 
+ *            is none 
+ * effects:   hashes the lowercase key and searches its bucket in place 
+*/
+
+hashTable::Node *hashTable::findNode(KeyType &key) {
+    //make key all lowercase and use it to find it's bucket in the table 
+    string lower = makeLower(key);
+    int index = hashValue(lower) % currentTableSize;
+    Bucket &bucket = chainingTable[index];
+
+    //search through the bucket for the lowercase key 
+    int node_index = getNodeIndex(lower, bucket);
+    if (node_index != -1) {
+        return &bucket.nodes.at(node_index);
+    }
+
+    return nullptr;
+}
+
 /*
  * name:      getSensitiveWord
  * purpose:   get the WordLocations struct that correspondings to the case 
  *            sensitive key 
  * arguments: a KeyType with a key
- * returns:   returns the key's WordLocations
+ * returns:   returns a copy of the key's WordLocations
  * effects:   searches the table for the given case sensitive key and returns
  *            its corresponding WordLocations, return an empty one if the case
  *            sensitive key does not exist in the table 
 */
 
 WordLocations hashTable::getSensitiveWord(KeyType &key) {
-    //get lowercase version of key and use it to get its index and bucket 
-    string lower = makeLower(key);
-    int index = hashValue(lower) % currentTableSize;
-    Bucket bucket = chainingTable[index];
-
-    //search through the bucket if it's not empty
-    if (not bucket.nodes.empty()) {
-        int node_index = getNodeIndex(lower, bucket);
-
-        //search through the node with the lowercase key if its not empty
-        if (node_index != -1) {
-            Node node = bucket.nodes.at(node_index);
-
-            int entry_index = getEntriesIndex(key, node);
+    const WordLocations *entry = findSensitiveWord(key);
 
-            //if the case sensitive word has an entry, return it 
-            if (entry_index != -1) {
-                return node.entries.at(entry_index); 
-            }
-        }
+    //if case sensitive word does not have a Wordlocations, return an empty one
+    if (entry == nullptr) {
+        return WordLocations();
     }
 
-    //if case sensitive word does not have a Wordlocations, return an empty one
-    return WordLocations();
+    return *entry;
 }
 
 /*
@@ -297,31 +496,22 @@ WordLocations hashTable::getSensitiveWord(KeyType &key) {
  * purpose:   get all of the WordLocations for the given key regardless of case
  *            sensitivity 
  * arguments: a KeyType with a key
- * returns:   returns the Node that contains all of the WordLocations for the 
- *            key, regardless of case sensitive lettering 
+ * returns:   returns a copy of the Node that contains all of the 
+ *            WordLocations for the key, regardless of case sensitive lettering
  * effects:   searches through the table for the node that corresponds to the
  *            lowercase key and return it, returning an empty node if the key
  *            does not exist in the table
 */
 
 hashTable::Node hashTable::getInsensitiveWord(KeyType &key) {
-    //make key all lowercase and use it to find it's bucket in the table 
-    string lower = makeLower(key);
-    int index = hashValue(lower) % currentTableSize;
-    Bucket bucket = chainingTable[index];
+    const Node *node = findInsensitiveWord(key);
 
-    //search through bucket if it's not empty
-    if (not bucket.nodes.empty()) {
-        int node_index = getNodeIndex(lower, bucket);
-
-        //if node that corresponds with key is not empty, return it 
-        if (node_index != -1) {
-            return bucket.nodes.at(node_index);
-        }
+    //if there is no node for the key, return an empty node 
+    if (node == nullptr) {
+        return Node();
     }
 
-    //otherwise, return an empty node 
-    return Node();
+    return *node;
 }
 
 /*
@@ -329,25 +519,215 @@ hashTable::Node hashTable::getInsensitiveWord(KeyType &key) {
  * purpose:   sets the given word to all lowercase 
  * arguments: a reference to a string with a word 
  * returns:   returns the all lowercase version of the word 
- * effects:   goes through each char in the word string and makes it lowercase,
- *            then returns the result 
+ * effects:   copies the word and makes each char lowercase (as the C locale
+ *            would, whatever the locale is), then returns the result 
 */
 
 string hashTable::makeLower(string &word) {
-    //string to contain lowercase word
-    string lower = "";
-    //int to contain size of word
-    int length = word.length();
-
-    //go through each character in the word, make it lowercase, and add to lower
-    for (int i = 0; i < length; i++) {
-        lower += tolower(word.at(i));
-    }
+    //copy the word and lowercase it with one table lookup per character 
+    string lower = word;
+    makeLowerInPlace(lower);
 
     //return lowercase string
     return lower;
 }
 
+/*
+ * name:      stringBytes 
+ * purpose:   get the number of heap bytes used by a string 
+ * arguments: a reference to a string 
+ * returns:   a size_t with the bytes allocated outside the string object 
+ * effects:   returns 0 for strings stored inline (small string optimization),
+ *            otherwise returns the capacity of the string's buffer
+*/
+static size_t stringBytes(const string &str) {
+    //inline strings point into the string object itself 
+    const char *data = str.data();
+    const char *object = (const char *) &str;
+    if (data >= object and data < object + sizeof(string)) {
+        return 0;
+    }
+
+    //otherwise the buffer (and its terminator) lives on the heap 
+    return str.capacity() + 1;
+}
+
+/*
+ * name:      addToHistogram 
+ * purpose:   count a value in a histogram with a capped last slot 
+ * arguments: a reference to a histogram vector and the value to count 
+ * returns:   none 
+ * effects:   increments the slot for the value, or the last slot if the 
+ *            value is larger than the histogram 
+*/
+static void addToHistogram(vector<size_t> &histogram, size_t value) {
+    //clamp large values into the last slot 
+    if (value >= histogram.size()) {
+        value = histogram.size() - 1;
+    }
+
+    histogram.at(value)++;
+}
+
+/*
+ * name:      getDiagnostics 
+ * purpose:   report how the table is occupied 
+ * arguments: functions for the number of locations of a variant and the 
+ *            bytes used by the ones moved out of its vector, or nullptr if 
+ *            every variant's locations are in its vector 
+ * returns:   a Diagnostics struct with counts, histograms and byte usage 
+ * effects:   walks every bucket, node and entry in the table and records 
+ *            chain lengths, case variants per key, locations per variant and
+ *            the memory used by each of those components
+*/
+hashTable::Diagnostics hashTable::getDiagnostics(
+    const LengthFunction &lengthOf, const LengthFunction &bytesOf) {
+    Diagnostics stats;
+
+    //sizes as the table sees them 
+    stats.numBuckets = currentTableSize;
+    stats.usedBuckets = 0;
+    stats.numItemsInTable = numItemsInTable;
+    stats.numKeys = stats.numVariants = stats.numPostings = 0;
+
+    //chains and variant counts are small, posting lengths use log2 slots 
+    stats.chainLengths.assign(17, 0);
+    stats.variantsPerKey.assign(17, 0);
+    stats.postingLengths.assign(33, 0);
+
+    //the bucket array itself 
+    stats.bucketBytes = currentTableSize * sizeof(Bucket);
+    stats.nodeBytes = stats.keyBytes = 0;
+    stats.entryBytes = stats.wordBytes = stats.postingBytes = 0;
+    stats.movedBytes = 0;
+
+    //go through each bucket in the table 
+    for (int i = 0; i < currentTableSize; i++) {
+        Bucket &bucket = chainingTable[i];
+        addToHistogram(stats.chainLengths, bucket.nodes.size());
+        stats.nodeBytes += bucket.nodes.capacity() * sizeof(Node);
+
+        if (not bucket.nodes.empty()) {
+            stats.usedBuckets++;
+        }
+
+        //go through each lowercase key in the bucket 
+        for (size_t j = 0; j < bucket.nodes.size(); j++) {
+            Node &node = bucket.nodes.at(j);
+            stats.numKeys++;
+            stats.keyBytes += stringBytes(node.key);
+            stats.entryBytes += node.entries.capacity() * sizeof(ValueType);
+            addToHistogram(stats.variantsPerKey, node.entries.size());
+
+            //go through each case variant of the key 
+            for (size_t k = 0; k < node.entries.size(); k++) {
+                WordLocations &entry = node.entries.at(k);
+                size_t length = lengthOf ? lengthOf(entry) : 
+                                           entry.location.size();
+
+                stats.numVariants++;
+                stats.numPostings += length;
+                stats.wordBytes += stringBytes(entry.word);
+                stats.postingBytes += entry.location.capacity() * 
+                                      sizeof(Instance);
+                if (bytesOf) {
+                    stats.movedBytes += bytesOf(entry);
+                }
+
+                //find floor(log2(length)) for the posting histogram 
+                size_t slot = 0;
+                while (length > 1) {
+                    length >>= 1;
+                    slot++;
+                }
+                addToHistogram(stats.postingLengths, slot);
+            }
+        }
+    }
+
+    return stats;
+}
+
+/*
+ * name:      printHistogram 
+ * purpose:   print one histogram of a Diagnostics report 
+ * arguments: an output stream, a title, the histogram, and whether the slots
+ *            are powers of two 
+ * returns:   none 
+ * effects:   prints each non empty slot of the histogram on its own line 
+*/
+static void printHistogram(ostream &out, const string &title, 
+                           const vector<size_t> &histogram, bool log2) {
+    out << title << ":\n";
+
+    for (size_t i = 0; i < histogram.size(); i++) {
+        //skip empty slots to keep the report short
+        if (histogram.at(i) == 0) {
+            continue;
+        }
+
+        //label the slot with its value or range of values 
+        out << "  ";
+        if (log2) {
+            out << "[" << (1UL << i) << ", " << (1UL << (i + 1)) << ")";
+        } else {
+            out << i;
+        }
+        if (i == histogram.size() - 1) {
+            out << "+";
+        }
+
+        out << ": " << histogram.at(i) << "\n";
+    }
+}
+
+/*
+ * name:      printDiagnostics 
+ * purpose:   print a human readable occupancy report of the table 
+ * arguments: an output stream to print the report to, and functions for 
+ *            the number of locations of a variant and the bytes used by the
+ *            ones moved out of its vector (or nullptr) 
+ * returns:   none 
+ * effects:   calls getDiagnostics and prints the counts, load factors, 
+ *            histograms and byte usage it reports
+*/
+void hashTable::printDiagnostics(ostream &out, 
+                                 const LengthFunction &lengthOf, 
+                                 const LengthFunction &bytesOf) {
+    Diagnostics stats = getDiagnostics(lengthOf, bytesOf);
+
+    //counts and the two load factors (what expand sees vs real occupancy)
+    out << "buckets: " << stats.numBuckets << " (" << stats.usedBuckets 
+        << " used)\n";
+    out << "keys: " << stats.numKeys << ", case variants: " 
+        << stats.numVariants << ", locations: " << stats.numPostings << "\n";
+    out << "numItemsInTable: " << stats.numItemsInTable << "\n";
+    out << "load factor (numItemsInTable): " << getLoadFactor() << "\n";
+    out << "load factor (keys): " 
+        << (float) stats.numKeys / (float) stats.numBuckets << "\n";
+
+    //histograms 
+    printHistogram(out, "nodes per bucket", stats.chainLengths, false);
+    printHistogram(out, "case variants per key", stats.variantsPerKey, false);
+    printHistogram(out, "locations per variant", stats.postingLengths, true);
+
+    //memory used by each component 
+    size_t total = stats.bucketBytes + stats.nodeBytes + stats.keyBytes + 
+                   stats.entryBytes + stats.wordBytes + stats.postingBytes + 
+                   stats.movedBytes;
+    out << "bytes:\n";
+    out << "  buckets: " << stats.bucketBytes << "\n";
+    out << "  nodes: " << stats.nodeBytes << "\n";
+    out << "  key strings: " << stats.keyBytes << "\n";
+    out << "  entries: " << stats.entryBytes << "\n";
+    out << "  word strings: " << stats.wordBytes << "\n";
+    out << "  locations: " << stats.postingBytes << "\n";
+    if (stats.movedBytes > 0) {
+        out << "  locations moved out: " << stats.movedBytes << "\n";
+    }
+    out << "  total: " << total << "\n";
+}
+
 //USED FOR TESTING, UNCOMMENT WHEN RUNNING UNIT TESTS 
 // void hashTable::printTable(){
 
@@ -367,8 +747,8 @@ string hashTable::makeLower(string &word) {
 //                 for (int l = 0; l < entry.location.size(); l++) {
 //                     Instance location = entry.location.at(l);
 
-//                     cout << "(" << location.file_path_index << ", "
-//                         << location.lineNum << ")";
+//                     cout << "(" << location.file_path_index() << ", "
+//                         << location.lineNum() << ")";
 //                 }
 
 //                 cout << "] ";
@@ -9,6 +9,14 @@
  *  words into the table using the C++ hash function, as well as retrieve those
  *  words and a list of their locations from the table. 
  *
+ *  Every occurrence of a word is counted as it is inserted (the locations 
+ *  only keep one per line), and the TOP_KEYS keys with the most occurrences 
+ *  are kept in a min heap during the build, so the most frequent keys are 
+ *  known without going through the whole table afterwards. The heap's 
+ *  counts may lag behind the keys' own counts: a key's count is only pushed 
+ *  again when the key is about to be dropped from the heap, so a key that 
+ *  is already there costs nothing more as it is inserted. 
+ *
 */
 
 #ifndef HASHTABLE_H
@@ -18,31 +26,13 @@
 #include <vector>
 #include <iostream>
 #include <set>
+#include <queue>
+#include <functional>
+#include <utility>
+#include "packedLocation.h"
 
 using namespace std;
 
-// 
-//  Instance struct, used to store a specific location in the directory. A 
-//  location is a file number in the directory and a line number in that file.
-// 
-struct Instance {
-    //ints to contain file number in directory and line num in that file 
-    int file_path_index;
-    int lineNum;
-
-    //default constructor 
-    Instance() {
-        file_path_index = -1;
-        lineNum = -1;
-    }
-
-    //constructor to set file and line numbers 
-    Instance(int filepath, int linenum){
-        file_path_index = filepath;
-        lineNum = linenum;
-    }
-};
-
 // 
 //  WordLocations struct, used to store a case sensitive word and all of its 
 //  unique locations in the directory 
@@ -52,17 +42,25 @@ struct WordLocations {
     string word;
     //vector to contain all locations of that word 
     vector<Instance> location;
+    //number of different files in the vector of locations 
+    size_t numFiles;
+    //number of times the word was inserted, including repeats on a line 
+    size_t occurrences;
 
     //default constructor 
     WordLocations() {
         word = "";
+        numFiles = 0;
+        occurrences = 0;
     }
 
     //constructor to initialize variables with given information 
-    WordLocations(string &data, int file, int line) {
+    WordLocations(string &data, size_t file, size_t line) {
         word = data;
         Instance instance(file, line);
         location.push_back(instance);
+        numFiles = 1;
+        occurrences = 1;
     }
 };
 
@@ -85,26 +83,91 @@ public:
         //vector with all of the case sensitive variations of they key
         vector<ValueType> entries;
 
+        //number of different lines and files with any variation of the key,
+        //and the last location added to any variation 
+        size_t numLines;
+        size_t numFiles;
+        Instance last;
+
+        //number of times any variation was inserted, and whether the key is
+        //in the heap of the most frequent keys 
+        size_t occurrences;
+        bool ranked;
+
         //default constructor 
         Node() {
             key = "";
+            numLines = 0;
+            numFiles = 0;
+            occurrences = 0;
+            ranked = false;
         }
 
         //constructor to initialize key 
         Node(KeyType k) {
             key = k;
+            numLines = 0;
+            numFiles = 0;
+            occurrences = 0;
+            ranked = false;
         }
     };
 
     enum HashFunction {GOOD_HASH_FUNCTION};
 
     //function for inserting words 
-    void insert(KeyType key, int file, int line);
+    void insert(KeyType key, size_t file, size_t line);
 
     //functions for getting words based on sensitivity
     WordLocations getSensitiveWord(KeyType &key);
     Node getInsensitiveWord(KeyType &key);
 
+    //functions for finding words in place, without copying their locations
+    const WordLocations *findSensitiveWord(KeyType &key);
+    const Node *findInsensitiveWord(KeyType &key);
+
+    //functions for visiting every key, such as to freeze the table or to 
+    //move the locations of common words elsewhere 
+    void getNodes(vector<const Node *> &nodes);
+    void getNodes(vector<Node *> &nodes);
+
+    //number of most frequent keys kept during the build, and a function for
+    //getting them, most occurrences first 
+    static const size_t TOP_KEYS = 20;
+    void getTopKeys(vector<const Node *> &nodes);
+
+    // 
+    //  Diagnostics struct, used to report how the table is actually occupied.
+    //  Histograms are indexed by count (the last slot holds everything at or
+    //  above it), except postingLengths which is indexed by floor(log2(len)).
+    // 
+    struct Diagnostics {
+        //sizes as the table sees them 
+        size_t numBuckets, usedBuckets, numItemsInTable;
+        //number of lowercase keys, case variants and locations stored 
+        size_t numKeys, numVariants, numPostings;
+
+        //nodes per bucket, variants per node, locations per variant 
+        vector<size_t> chainLengths;
+        vector<size_t> variantsPerKey;
+        vector<size_t> postingLengths;
+
+        //bytes used by each component, including unused vector capacity,
+        //and by the locations moved out of their vectors 
+        size_t bucketBytes, nodeBytes, keyBytes;
+        size_t entryBytes, wordBytes, postingBytes, movedBytes;
+    };
+
+    //functions for inspecting the occupancy of the table, given functions
+    //for the number of locations of a variant and the bytes they use if 
+    //some were moved out of its vector (such as into a bitmap), or nullptr
+    //to count the vectors 
+    typedef function<size_t(const WordLocations &)> LengthFunction;
+    Diagnostics getDiagnostics(const LengthFunction &lengthOf, 
+                               const LengthFunction &bytesOf = nullptr);
+    void printDiagnostics(ostream &out, const LengthFunction &lengthOf, 
+                          const LengthFunction &bytesOf = nullptr);
+
 //private functions, comment out when unit testing 
 private:
 
@@ -121,14 +184,22 @@ private:
     //array to act as table 
     Bucket *chainingTable;
 
+    //min heap of the most frequent keys and their occurrences when they 
+    //were last pushed 
+    typedef pair<size_t, KeyType> RankedKey;
+    priority_queue<RankedKey, vector<RankedKey>, greater<RankedKey>> topKeys;
+
     //helper functions for inserting and accessing 
     void expand();
     string makeLower(string &word);
+    Node *findNode(KeyType &key);
     float getLoadFactor();
     int getNodeIndex(KeyType &key, Bucket &bucket);
     int getEntriesIndex(string &word, Node &node);
-    bool isDuplicate(WordLocations &entry, int &file, int &line);
-    void insertWord(KeyType &word, int &file, int &line, Node &node);
+    bool isDuplicate(WordLocations &entry, Instance &location);
+    void insertWord(KeyType &word, size_t file, size_t line, Node &node);
+    void countLocation(Node &node, Instance &location);
+    void rankKey(Node &node);
 
     //Function for testing
     //void printTable();
@@ -0,0 +1,272 @@
+/*
+ *  indexSegment.cpp
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  Contains an implementation of the indexSegment class.   
+ *
+*/
+
+#include "indexSegment.h"
+#include "stringProcessing.h"
+#include <algorithm>
+
+/*
+ * name:      indexSegment constructor 
+ * purpose:   freezes a hashTable into a segment 
+ * arguments: a reference to a hashTable with the words of some files, and 
+ *            size_ts with the first file number and one past the last 
+ * returns:   none 
+ * effects:   copies every key of the table, sorted by its text, and every 
+ *            case sensitive word of each key, sorted by its text, along with
+ *            their locations and counts 
+*/
+indexSegment::indexSegment(hashTable &table, size_t firstFile, 
+                           size_t endFile) {
+    first = firstFile;
+    end = endFile;
+    total = 0;
+
+    //sort the keys by their text 
+    vector<const hashTable::Node *> nodes;
+    table.getNodes(nodes);
+    sort(nodes.begin(), nodes.end(), 
+         [](const hashTable::Node *a, const hashTable::Node *b) {
+             return a->key < b->key;
+         });
+
+    keys.reserve(nodes.size());
+    for (size_t i = 0; i < nodes.size(); i++) {
+        const hashTable::Node &node = *nodes[i];
+        Key key = {node.key, words.size(), node.entries.size(), 
+                   node.numLines, node.numFiles};
+        keys.push_back(key);
+
+        //copy the key's words, sorted by their text 
+        vector<const WordLocations *> entries;
+        for (size_t j = 0; j < node.entries.size(); j++) {
+            entries.push_back(&node.entries[j]);
+        }
+        sort(entries.begin(), entries.end(), 
+             [](const WordLocations *a, const WordLocations *b) {
+                 return a->word < b->word;
+             });
+        for (size_t j = 0; j < entries.size(); j++) {
+            Word word = {entries[j]->word, entries[j]->location, 
+                         entries[j]->numFiles};
+            word.locations.shrink_to_fit();
+            total += word.locations.size();
+            words.push_back(word);
+        }
+    }
+}
+
+/*
+ * name:      indexSegment merge constructor 
+ * purpose:   merges several segments into one 
+ * arguments: a vector of pointers to segments whose file ranges do not 
+ *            overlap 
+ * returns:   none 
+ * effects:   walks the sorted keys of every segment in step and, for each 
+ *            key, gathers its words from each segment. The locations of a 
+ *            word are appended segment by segment in file order, which keeps
+ *            them sorted since the file ranges do not overlap. Counts add up
+ *            for the same reason. The segments are only read. 
+*/
+indexSegment::indexSegment(const vector<shared_ptr<const indexSegment>> 
+                           &parts) {
+    //order the segments by their files 
+    vector<const indexSegment *> segments;
+    for (size_t i = 0; i < parts.size(); i++) {
+        segments.push_back(parts[i].get());
+    }
+    sort(segments.begin(), segments.end(), 
+         [](const indexSegment *a, const indexSegment *b) {
+             return a->first < b->first;
+         });
+
+    first = segments.empty() ? 0 : segments.front()->first;
+    end = segments.empty() ? 0 : segments.back()->end;
+    total = 0;
+
+    //position in each segment's keys 
+    vector<size_t> heads(segments.size(), 0);
+    while (true) {
+        //find the smallest key left in any segment 
+        const string *smallest = nullptr;
+        for (size_t i = 0; i < segments.size(); i++) {
+            if (heads[i] < segments[i]->keys.size() and 
+                (smallest == nullptr or 
+                 segments[i]->keys[heads[i]].text < *smallest)) {
+                smallest = &segments[i]->keys[heads[i]].text;
+            }
+        }
+        if (smallest == nullptr) {
+            break;
+        }
+
+        //gather the key's words from each segment that has it, in order 
+        Key key = {*smallest, words.size(), 0, 0, 0};
+        vector<pair<const Word *, size_t>> found;
+        for (size_t i = 0; i < segments.size(); i++) {
+            if (heads[i] == segments[i]->keys.size() or 
+                segments[i]->keys[heads[i]].text != key.text) {
+                continue;
+            }
+            const Key &part = segments[i]->keys[heads[i]];
+            key.numLines += part.numLines;
+            key.numFiles += part.numFiles;
+            for (size_t j = 0; j < part.numWords; j++) {
+                found.push_back(make_pair(
+                    &segments[i]->words[part.firstWord + j], i));
+            }
+            heads[i]++;
+        }
+
+        //group the same word from different segments (segment order stays)
+        stable_sort(found.begin(), found.end(), 
+                    [](const pair<const Word *, size_t> &a, 
+                       const pair<const Word *, size_t> &b) {
+                        return a.first->text < b.first->text;
+                    });
+        for (size_t j = 0; j < found.size(); j++) {
+            const Word &part = *found[j].first;
+            if (j == 0 or part.text != words.back().text) {
+                Word word = {part.text, vector<Instance>(), 0};
+                words.push_back(word);
+                key.numWords++;
+            }
+            Word &word = words.back();
+            word.locations.insert(word.locations.end(), 
+                                  part.locations.begin(), 
+                                  part.locations.end());
+            word.numFiles += part.numFiles;
+            total += part.locations.size();
+        }
+        keys.push_back(key);
+    }
+}
+
+/*
+ * name:      findKey 
+ * purpose:   finds a lowercase key 
+ * arguments: a string with the key in lowercase 
+ * returns:   returns a pointer to the key, or nullptr if it is not in the 
+ *            segment 
+ * effects:   binary searches the sorted keys 
+*/
+const indexSegment::Key *indexSegment::findKey(const string &lower) const {
+    vector<Key>::const_iterator found = 
+        lower_bound(keys.begin(), keys.end(), lower, 
+                    [](const Key &key, const string &text) {
+                        return key.text < text;
+                    });
+    if (found == keys.end() or found->text != lower) {
+        return nullptr;
+    }
+    return &*found;
+}
+
+/*
+ * name:      find 
+ * purpose:   finds the locations of a word in the segment 
+ * arguments: a string with a word, whether to ignore case sensitivity, a 
+ *            vector to add the word's location lists to, and references to
+ *            size_ts to store its number of lines and files in 
+ * returns:   returns true if the word is in the segment, false otherwise 
+ * effects:   adds one list per case sensitive variant for an insensitive 
+ *            search, or the list of the exact word. The lists point into the
+ *            segment. 
+*/
+bool indexSegment::find(const string &word, bool insensitive, 
+                        vector<LocationList> &lists, size_t &numLines, 
+                        size_t &numFiles) const {
+    //keys are stored in lowercase 
+    string lower = word;
+    makeLowerInPlace(lower);
+
+    const Key *key = findKey(lower);
+    if (key == nullptr) {
+        return false;
+    }
+
+    //every variant of the key 
+    if (insensitive) {
+        for (size_t i = 0; i < key->numWords; i++) {
+            const Word &entry = words[key->firstWord + i];
+            LocationList list = {entry.locations.data(), 
+                                 entry.locations.size()};
+            lists.push_back(list);
+        }
+        numLines = key->numLines;
+        numFiles = key->numFiles;
+        return true;
+    }
+
+    //or only the exact word 
+    for (size_t i = 0; i < key->numWords; i++) {
+        const Word &entry = words[key->firstWord + i];
+        if (entry.text == word) {
+            LocationList list = {entry.locations.data(), 
+                                 entry.locations.size()};
+            lists.push_back(list);
+            numLines = entry.locations.size();
+            numFiles = entry.numFiles;
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * name:      numLocations 
+ * purpose:   gets the number of locations in the segment 
+ * arguments: none
+ * returns:   a size_t with the number of locations of every word 
+ * effects:   none 
+*/
+size_t indexSegment::numLocations() const {
+    return total;
+}
+
+/*
+ * name:      firstFile 
+ * purpose:   gets the first file number in the segment 
+ * arguments: none
+ * returns:   a size_t with the file number 
+ * effects:   none 
+*/
+size_t indexSegment::firstFile() const {
+    return first;
+}
+
+/*
+ * name:      endFile 
+ * purpose:   gets one past the last file number in the segment 
+ * arguments: none
+ * returns:   a size_t with the file number 
+ * effects:   none 
+*/
+size_t indexSegment::endFile() const {
+    return end;
+}
+
+/*
+ * name:      bytes 
+ * purpose:   gets the memory used by the segment 
+ * arguments: none
+ * returns:   a size_t with the bytes used by keys, words and locations 
+ * effects:   none 
+*/
+size_t indexSegment::bytes() const {
+    size_t size = keys.capacity() * sizeof(Key) + 
+                  words.capacity() * sizeof(Word);
+    for (size_t i = 0; i < keys.size(); i++) {
+        size += keys[i].text.capacity();
+    }
+    for (size_t i = 0; i < words.size(); i++) {
+        size += words[i].text.capacity() + 
+                words[i].locations.capacity() * sizeof(Instance);
+    }
+    return size;
+}
@@ -0,0 +1,81 @@
+/*
+ *  indexSegment.h
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  indexSegment is a class that holds a frozen, read only index of the words
+ *  in a range of files that were added after the directory was indexed. A 
+ *  segment is made once from a hashTable (which is then thrown away) and 
+ *  never changes, so any number of threads can read it while a new segment 
+ *  is being built or several are being merged into a bigger one. The keys 
+ *  are kept sorted so words are found with a binary search, and each 
+ *  segment covers its own range of file numbers, so the locations of a word
+ *  in segments of later files all come after its locations in earlier ones.
+ *
+*/
+
+#ifndef INDEXSEGMENT_H
+#define INDEXSEGMENT_H
+
+#include "hashTable.h"
+#include "packedLocation.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class indexSegment {
+//public functions available to the client 
+public:
+    indexSegment(hashTable &table, size_t firstFile, size_t endFile);
+    indexSegment(const vector<shared_ptr<const indexSegment>> &parts);
+
+    //function for looking up words 
+    bool find(const string &word, bool insensitive, 
+              vector<LocationList> &lists, size_t &numLines, 
+              size_t &numFiles) const;
+
+    //functions for the size and file range of the segment 
+    size_t numLocations() const;
+    size_t firstFile() const;
+    size_t endFile() const;
+    size_t bytes() const;
+
+private:
+    // 
+    //  Key struct, used to store a lowercase key, its range of case 
+    //  sensitive words, and the number of lines and files with any of them 
+    // 
+    struct Key {
+        string text;
+        size_t firstWord;
+        size_t numWords;
+        size_t numLines;
+        size_t numFiles;
+    };
+
+    // 
+    //  Word struct, used to store a case sensitive word, its sorted 
+    //  locations, and the number of files they are in 
+    // 
+    struct Word {
+        string text;
+        vector<Instance> locations;
+        size_t numFiles;
+    };
+
+    //keys sorted by text, and the words of each key next to each other 
+    vector<Key> keys;
+    vector<Word> words;
+
+    //range of file numbers and number of locations in the segment 
+    size_t first;
+    size_t end;
+    size_t total;
+
+    //helper function for finding a key 
+    const Key *findKey(const string &lower) const;
+};
+
+#endif
@@ -0,0 +1,168 @@
+/*
+ *  lineIndex.cpp
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  Contains an implementation of the lineIndex class.   
+ *
+*/
+
+#include "lineIndex.h"
+#include <unistd.h>
+
+/*
+ * name:      lineIndex constructor 
+ * purpose:   creates an empty line index 
+ * arguments: none
+ * returns:   none 
+ * effects:   none 
+*/
+lineIndex::lineIndex() {
+
+}
+
+/*
+ * name:      addFile 
+ * purpose:   starts recording the lines of a file 
+ * arguments: a size_t with the number of the file 
+ * returns:   none 
+ * effects:   makes room for the file (and any skipped before it, which are 
+ *            left with no lines) and clears its offsets 
+*/
+void lineIndex::addFile(size_t file) {
+    if (offsets.size() <= file) {
+        offsets.resize(file + 1);
+    }
+    offsets[file].clear();
+}
+
+/*
+ * name:      addLine 
+ * purpose:   records where the next line of a file starts 
+ * arguments: a size_t with the number of the file and a uint64_t with the 
+ *            byte offset of the line in the file 
+ * returns:   none 
+ * effects:   adds the offset after the file's other lines 
+*/
+void lineIndex::addLine(size_t file, uint64_t offset) {
+    offsets.at(file).push_back(offset);
+}
+
+/*
+ * name:      finishFile 
+ * purpose:   records where the last line of a file ends 
+ * arguments: a size_t with the number of the file and a uint64_t with the 
+ *            length of the file 
+ * returns:   none 
+ * effects:   adds the length after the file's line offsets and frees any 
+ *            unused room in the list 
+*/
+void lineIndex::finishFile(size_t file, uint64_t length) {
+    offsets.at(file).push_back(length);
+    offsets.at(file).shrink_to_fit();
+}
+
+/*
+ * name:      numLines 
+ * purpose:   gets the number of lines in a file 
+ * arguments: a size_t with the number of the file 
+ * returns:   a size_t with the number of lines recorded for the file 
+ * effects:   none 
+*/
+size_t lineIndex::numLines(size_t file) const {
+    if (file >= offsets.size() or offsets[file].empty()) {
+        return 0;
+    }
+    return offsets[file].size() - 1;
+}
+
+/*
+ * name:      lineBounds 
+ * purpose:   finds where a line starts and ends in its file 
+ * arguments: a size_t with the number of the file, a size_t with the line 
+ *            number, and references to uint64_ts to store the offsets in 
+ * returns:   returns true if the file has that line, false otherwise 
+ * effects:   the end offset is the start of the next line, so it includes 
+ *            the line's newline character (if it has one) 
+*/
+bool lineIndex::lineBounds(size_t file, size_t line, uint64_t &start, 
+                           uint64_t &end) const {
+    if (line == 0 or line > numLines(file)) {
+        return false;
+    }
+
+    start = offsets[file][line - 1];
+    end = offsets[file][line];
+    return true;
+}
+
+/*
+ * name:      readLine 
+ * purpose:   reads one line of a file 
+ * arguments: an int with the file open for reading, a size_t with the 
+ *            number of the file, a size_t with the line number, and a 
+ *            string to store the line in 
+ * returns:   returns true if the line was read, false otherwise 
+ * effects:   reads the line with readLines and drops its newline character
+*/
+bool lineIndex::readLine(int fd, size_t file, size_t line, 
+                         string &text) const {
+    if (not readLines(fd, file, line, line, text)) {
+        return false;
+    }
+
+    //drop the newline character 
+    if (not text.empty() and text.back() == '\n') {
+        text.pop_back();
+    }
+    return true;
+}
+
+/*
+ * name:      readLines 
+ * purpose:   reads a run of lines of a file at once 
+ * arguments: an int with the file open for reading, a size_t with the 
+ *            number of the file, size_ts with the first and last line 
+ *            numbers of the run, and a string to store the lines in 
+ * returns:   returns true if the lines were read, false otherwise 
+ * effects:   reads the bytes from the start of the first line to the end of
+ *            the last one with pread (so the file's position does not matter
+ *            and several threads can share the descriptor), keeping the 
+ *            newline characters between the lines 
+*/
+bool lineIndex::readLines(int fd, size_t file, size_t first, size_t last, 
+                          string &text) const {
+    uint64_t start = 0, end = 0, unused = 0;
+    if (first > last or not lineBounds(file, first, start, unused) or 
+        not lineBounds(file, last, unused, end)) {
+        return false;
+    }
+
+    //read the whole run 
+    text.resize(end - start);
+    size_t done = 0;
+    while (done < text.length()) {
+        ssize_t bytes = pread(fd, &text[done], text.length() - done, 
+                              start + done);
+        if (bytes <= 0) {
+            return false;
+        }
+        done += bytes;
+    }
+    return true;
+}
+
+/*
+ * name:      bytes 
+ * purpose:   gets the memory used by the line index 
+ * arguments: none
+ * returns:   a size_t with the bytes used, including unused capacity 
+ * effects:   none 
+*/
+size_t lineIndex::bytes() const {
+    size_t total = offsets.capacity() * sizeof(vector<uint64_t>);
+    for (size_t i = 0; i < offsets.size(); i++) {
+        total += offsets[i].capacity() * sizeof(uint64_t);
+    }
+    return total;
+}
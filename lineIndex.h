@@ -0,0 +1,49 @@
+/*
+ *  lineIndex.h
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  lineIndex is a class that stores where each line of each file in the 
+ *  directory starts, so that any line can be read straight from its file 
+ *  (with pread) instead of reading through the file from the top. The 
+ *  offsets are recorded while the index is built, when every line of every 
+ *  file is already being looked at. Files are numbered the same way as in 
+ *  the pathTable and lines are numbered from 1. 
+ *
+*/
+
+#ifndef LINEINDEX_H
+#define LINEINDEX_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class lineIndex {
+//public functions available to the client 
+public:
+    lineIndex();
+
+    //functions for recording the lines of a file 
+    void addFile(size_t file);
+    void addLine(size_t file, uint64_t offset);
+    void finishFile(size_t file, uint64_t length);
+
+    //functions for finding and reading lines 
+    size_t numLines(size_t file) const;
+    bool lineBounds(size_t file, size_t line, uint64_t &start, 
+                    uint64_t &end) const;
+    bool readLine(int fd, size_t file, size_t line, string &text) const;
+    bool readLines(int fd, size_t file, size_t first, size_t last, 
+                   string &text) const;
+
+    size_t bytes() const;
+
+private:
+    //for each file, the offset of each line followed by the file's length
+    vector<vector<uint64_t>> offsets;
+};
+
+#endif
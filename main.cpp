@@ -14,32 +14,134 @@
 #include "gerp.h"
 #include <string>
 #include <iostream>
+#include <cstdlib>
+#include <csignal>
 
 using namespace std;
 
+/*
+ * name:      interrupt 
+ * purpose:   handles Ctrl-C 
+ * arguments: an int with the signal number 
+ * returns:   none 
+ * effects:   cancels the running query, so gerp prints what it has and 
+ *            waits for the next one. With no query running, exits the way 
+ *            Ctrl-C always has. 
+*/
+static void interrupt(int signalNumber) {
+    if (queryGuard::running()) {
+        queryGuard::cancel();
+        return;
+    }
+    signal(signalNumber, SIG_DFL);
+    raise(signalNumber);
+}
+
 /*
  * name:      main
  * purpose:   creates and runs a new gerp 
  * arguments: a int with number of arguments and an array with the arguments 
  * returns:   an int of whether the program finished successfully 
  * effects:   prints error if client did not produce correct number of 
- *            arguments or valid zap or unzap commands. Creates a new 
- *            gerp and runs the query loop, prints out error and departing 
- *            messages.  
+ *            arguments or an unknown option. Creates a new gerp (with the 
+ *            parts of the index chosen by the options) and runs the query 
+ *            loop, prints out error and departing messages. Ctrl-C cancels 
+ *            the running query once the index is built. 
 */
 int main(int argc, char *argv[]) {
+    //read the options that come before the directory 
+    gerpOptions options;
+    int arg = 1;
+    while (arg < argc and string(argv[arg]).compare(0, 2, "--") == 0) {
+        string option = argv[arg];
+        if (option == "--trigrams") {
+            options.trigrams = true;
+        } else if (option == "--line-offsets") {
+            options.lineOffsets = true;
+        } else if (option == "--memory" and arg + 1 < argc and 
+                   atol(argv[arg + 1]) > 0) {
+            options.memoryBudget = (size_t) atol(argv[++arg]) << 20;
+        } else if (option == "--temp-dir" and arg + 1 < argc) {
+            options.tempDirectory = argv[++arg];
+        } else if (option == "--watch") {
+            options.watch = true;
+        } else if (option == "--include" and arg + 1 < argc) {
+            options.includes.push_back(argv[++arg]);
+        } else if (option == "--exclude" and arg + 1 < argc) {
+            options.excludes.push_back(argv[++arg]);
+        } else if (option == "--max-file-size" and arg + 1 < argc and 
+                   atol(argv[arg + 1]) > 0) {
+            options.maxFileBytes = (size_t) atol(argv[++arg]) << 10;
+        } else if (option == "--binary") {
+            options.indexBinary = true;
+        } else if (option == "--save-index" and arg + 1 < argc) {
+            options.saveIndex = argv[++arg];
+        } else if (option == "--load-index" and arg + 1 < argc) {
+            options.loadIndex = argv[++arg];
+        } else if (option == "--prefetch") {
+            options.prefetch = true;
+        } else if (option == "--format" and arg + 1 < argc and 
+                   resultWriter::parseFormat(argv[arg + 1], options.format)) {
+            arg++;
+        } else if (option == "--timeout" and arg + 1 < argc and 
+                   atol(argv[arg + 1]) > 0) {
+            options.timeoutMs = atol(argv[++arg]);
+        } else if (option == "--max-results" and arg + 1 < argc and 
+                   atol(argv[arg + 1]) > 0) {
+            options.maxResults = atol(argv[++arg]);
+        } else if (option == "--dump-vocab" and arg + 1 < argc) {
+            options.dumpVocab = argv[++arg];
+        } else {
+            argc = 0;
+            break;
+        }
+        arg++;
+    }
+
+    //a saved index holds no trigrams or line offsets, and is either saved 
+    //or loaded 
+    bool sharing = not options.saveIndex.empty() or 
+                   not options.loadIndex.empty();
+    bool both = not options.saveIndex.empty() and 
+                not options.loadIndex.empty();
+    if (sharing and (options.trigrams or options.lineOffsets or both)) {
+        argc = 0;
+    }
+
+    //only an index built in memory counts every word's occurrences 
+    if (not options.dumpVocab.empty() and 
+        (sharing or options.memoryBudget > 0)) {
+        argc = 0;
+    }
+
     //if client does not input correct arguments, print error message
-    if (argc != 3) {
-        cerr << "Usage: ./gerp inputDirectory outputFile" << endl;
+    if (argc - arg != 2) {
+        cerr << "Usage: ./gerp [--trigrams] [--line-offsets] [--memory MB] "
+             << "[--temp-dir dir] [--watch] [--include glob] "
+             << "[--exclude glob] "
+             << "[--max-file-size KB] [--binary] "
+             << "[--save-index file | --load-index file] [--prefetch] "
+             << "[--format text|json|binary] [--timeout ms] "
+             << "[--max-results N] [--dump-vocab file] "
+             << "inputDirectory outputFile" << endl;
+        cerr << "Building the index fails if there are more than " 
+             << (size_t) Instance::MAX_FILE + 1 << " files, or a file has "
+             << "more than " << (size_t) Instance::MAX_LINE << " lines "
+             << "(see GERP_LOCATION_BITS in packedLocation.h)." << endl;
         exit(EXIT_FAILURE);
     }
 
     //try to create and run new gerp 
     try {
         //create new gerp
-        gerp new_gerp(argv[1], argv[2]);
+        gerp new_gerp(argv[arg], argv[arg + 1], options);
 
-        //run query loop
+        //run query loop, letting Ctrl-C cancel a query instead of exiting 
+        struct sigaction action = {};
+        action.sa_handler = interrupt;
+        action.sa_flags = SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGINT, &action, nullptr);
         new_gerp.handleQuery(cin);
 
         //print departing message
@@ -48,6 +150,7 @@ int main(int argc, char *argv[]) {
 
     //print error message if indexing was not successful 
     catch (const runtime_error &e) {
+        cerr << e.what() << endl;
         cerr << "Could not build index, exiting." << endl;
     }
 
@@ -0,0 +1,161 @@
+/*
+ *  packedLocation.cpp
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  Contains the sorting and merging functions for packed locations.   
+ *
+*/
+
+#include "packedLocation.h"
+
+//definitions of the constants declared in Instance 
+const int Instance::LINE_BITS;
+const int Instance::FILE_BITS;
+const PackedLocation Instance::MAX_LINE;
+const PackedLocation Instance::MAX_FILE;
+
+/*
+ * name:      sortLocations 
+ * purpose:   sorts a vector of locations by file and then by line 
+ * arguments: a reference to a vector of locations 
+ * returns:   none 
+ * effects:   sorts the vector with a least significant byte radix sort over
+ *            the packed values. Bytes that are the same in every location 
+ *            (usually the high bytes of the file number) are skipped. 
+*/
+void sortLocations(vector<Instance> &locations) {
+    size_t size = locations.size();
+    if (size < 2) {
+        return;
+    }
+
+    //find which bits differ anywhere in the vector 
+    PackedLocation orBits = 0, andBits = (PackedLocation) -1;
+    for (size_t i = 0; i < size; i++) {
+        orBits |= locations[i].packed;
+        andBits &= locations[i].packed;
+    }
+    PackedLocation differing = orBits ^ andBits;
+
+    vector<Instance> scratch(size);
+    Instance *from = locations.data(), *to = scratch.data();
+
+    //one counting pass per byte that differs 
+    for (size_t shift = 0; shift < sizeof(PackedLocation) * 8; shift += 8) {
+        if (((differing >> shift) & 0xff) == 0) {
+            continue;
+        }
+
+        //count each byte value, then turn counts into starting positions 
+        size_t counts[256] = {0};
+        for (size_t i = 0; i < size; i++) {
+            counts[(from[i].packed >> shift) & 0xff]++;
+        }
+        size_t position = 0;
+        for (int b = 0; b < 256; b++) {
+            size_t count = counts[b];
+            counts[b] = position;
+            position += count;
+        }
+
+        //scatter into the other buffer, keeping equal bytes in order 
+        for (size_t i = 0; i < size; i++) {
+            to[counts[(from[i].packed >> shift) & 0xff]++] = from[i];
+        }
+        swap(from, to);
+    }
+
+    //copy back if the last pass ended in the scratch buffer 
+    if (from != locations.data()) {
+        locations.swap(scratch);
+    }
+}
+
+/*
+ * name:      mergeLocations 
+ * purpose:   merges two sorted lists of locations without duplicates 
+ * arguments: a pointer to and size of each sorted list, and a pointer to an 
+ *            output buffer with room for aSize + bSize locations 
+ * returns:   a size_t with the number of locations written to out 
+ * effects:   writes the sorted union of the two lists to out. The inner loop
+ *            has no data dependent branches: each step writes the smaller 
+ *            value and only advances the output when it is the first value 
+ *            or differs from the last value written. No value is set aside 
+ *            as a marker, so every location (even MAX_FILE, MAX_LINE) is 
+ *            kept. 
+*/
+size_t mergeLocations(const Instance *a, size_t aSize, 
+                      const Instance *b, size_t bSize, Instance *out) {
+    size_t i = 0, j = 0, written = 0;
+    //last value written, only compared once something has been written 
+    PackedLocation last = 0;
+
+    while (i < aSize and j < bSize) {
+        PackedLocation x = a[i].packed, y = b[j].packed;
+        PackedLocation smaller = x < y ? x : y;
+
+        //always store, but only keep the value if it is new 
+        out[written].packed = smaller;
+        written += (written == 0) | (smaller != last);
+        last = smaller;
+
+        //advance whichever lists held the value (both when equal)
+        i += (x <= y);
+        j += (y <= x);
+    }
+
+    //copy whatever is left of either list 
+    for (; i < aSize; i++) {
+        out[written].packed = a[i].packed;
+        written += (written == 0) | (a[i].packed != last);
+        last = a[i].packed;
+    }
+    for (; j < bSize; j++) {
+        out[written].packed = b[j].packed;
+        written += (written == 0) | (b[j].packed != last);
+        last = b[j].packed;
+    }
+
+    return written;
+}
+
+/*
+ * name:      unionLocations 
+ * purpose:   merges any number of sorted lists of locations 
+ * arguments: a vector of pointers to sorted vectors of locations 
+ * returns:   a sorted vector with every distinct location from the lists 
+ * effects:   merges the lists in pairs, round by round, so that each location
+ *            is copied about log2(number of lists) times 
+*/
+vector<Instance> unionLocations(const vector<const vector<Instance> *> &lists) {
+    //start with a copy of each list 
+    vector<vector<Instance>> round;
+    for (size_t i = 0; i < lists.size(); i++) {
+        round.push_back(*lists[i]);
+    }
+    if (round.empty()) {
+        return vector<Instance>();
+    }
+
+    //merge neighbouring lists until only one is left 
+    while (round.size() > 1) {
+        vector<vector<Instance>> next;
+        for (size_t i = 0; i + 1 < round.size(); i += 2) {
+            vector<Instance> merged(round[i].size() + round[i + 1].size());
+            size_t size = mergeLocations(round[i].data(), round[i].size(),
+                                         round[i + 1].data(), 
+                                         round[i + 1].size(), merged.data());
+            merged.resize(size);
+            next.push_back(merged);
+        }
+
+        //an odd list out moves on to the next round as it is 
+        if (round.size() % 2 == 1) {
+            next.push_back(round.back());
+        }
+        round.swap(next);
+    }
+
+    return round.front();
+}
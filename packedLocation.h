@@ -0,0 +1,122 @@
+/*
+ *  packedLocation.h
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  Instance is a location in the directory (a file index and a line number in
+ *  that file) packed into a single unsigned integer, with the file index in 
+ *  the high bits and the line number in the low bits. Comparing two packed
+ *  values therefore orders locations by file and then by line, which lets 
+ *  vectors of Instances be sorted and merged as plain integers. The width of
+ *  the packed value and the split between file and line bits are set at 
+ *  compile time with GERP_LOCATION_BITS (32 or 64) and GERP_LINE_BITS. 
+ *  Locations that do not fit in the configured bits throw a runtime_error 
+ *  while the index is built rather than silently wrapping around; there is
+ *  no fallback to wider locations, so the build fails (and a file added 
+ *  later is left out). The default of 64 bits is no smaller than the two 
+ *  ints a location used to be; 32 bits halves it.
+ *
+*/
+
+#ifndef PACKEDLOCATION_H
+#define PACKEDLOCATION_H
+
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+//width of a packed location, 64 by default 
+#ifndef GERP_LOCATION_BITS
+#define GERP_LOCATION_BITS 64
+#endif
+
+//bits of the packed location used for the line number, half by default 
+#ifndef GERP_LINE_BITS
+#define GERP_LINE_BITS (GERP_LOCATION_BITS / 2)
+#endif
+
+#if GERP_LOCATION_BITS == 64
+typedef uint64_t PackedLocation;
+#elif GERP_LOCATION_BITS == 32
+typedef uint32_t PackedLocation;
+#else
+#error "GERP_LOCATION_BITS must be 32 or 64"
+#endif
+
+#if GERP_LINE_BITS <= 0 || GERP_LINE_BITS >= GERP_LOCATION_BITS
+#error "GERP_LINE_BITS must leave room for both file and line bits"
+#endif
+
+// 
+//  Instance struct, used to store a specific location in the directory. A 
+//  location is a file number in the directory and a line number in that file,
+//  packed into one integer so that locations sort by (file, line). 
+// 
+struct Instance {
+    //number of bits for each half of the location and the largest values 
+    //that fit in them 
+    static const int LINE_BITS = GERP_LINE_BITS;
+    static const int FILE_BITS = GERP_LOCATION_BITS - GERP_LINE_BITS;
+    static const PackedLocation MAX_LINE = 
+        ((PackedLocation) 1 << LINE_BITS) - 1;
+    static const PackedLocation MAX_FILE = 
+        ((PackedLocation) -1) >> LINE_BITS;
+
+    //packed file number (high bits) and line number (low bits)
+    PackedLocation packed;
+
+    //default constructor, every bit set marks an empty location 
+    Instance() {
+        packed = (PackedLocation) -1;
+    }
+
+    //constructor to pack file and line numbers 
+    Instance(size_t filepath, size_t linenum) {
+        //refuse locations that do not fit in the configured bits 
+        if (filepath > MAX_FILE or linenum > MAX_LINE) {
+            throw runtime_error("Location (" + to_string(filepath) + ", " + 
+                                to_string(linenum) + ") does not fit in " + 
+                                "GERP_LOCATION_BITS/GERP_LINE_BITS");
+        }
+
+        packed = ((PackedLocation) filepath << LINE_BITS) | 
+                 (PackedLocation) linenum;
+    }
+
+    //functions to unpack the file and line numbers 
+    size_t file_path_index() const {
+        return packed >> LINE_BITS;
+    }
+    size_t lineNum() const {
+        return packed & MAX_LINE;
+    }
+
+    //locations compare by file and then by line 
+    bool operator<(const Instance &other) const {
+        return packed < other.packed;
+    }
+    bool operator==(const Instance &other) const {
+        return packed == other.packed;
+    }
+};
+
+// 
+//  LocationList struct, used to refer to a sorted list of locations without 
+//  copying it, whether it is stored in a vector or in a mapped index file 
+// 
+struct LocationList {
+    const Instance *data;
+    size_t size;
+};
+
+//functions for sorting and merging vectors of locations 
+void sortLocations(vector<Instance> &locations);
+size_t mergeLocations(const Instance *a, size_t aSize, 
+                      const Instance *b, size_t bSize, Instance *out);
+vector<Instance> unionLocations(const vector<const vector<Instance> *> &lists);
+
+#endif
@@ -0,0 +1,549 @@
+/*
+ *  pathTable.cpp
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  Contains an implementation of the pathTable class.   
+ *
+*/
+
+#include "pathTable.h"
+#include <cstring>
+#include <stdexcept>
+
+//definitions of the constants declared in the class 
+const size_t pathTable::NO_PARENT;
+const uint64_t pathTable::NOT_FINISHED;
+
+/*
+ * name:      pathTable constructor 
+ * purpose:   creates an empty path table 
+ * arguments: none
+ * returns:   none 
+ * effects:   points the view at the empty vectors 
+*/
+pathTable::pathTable() {
+    mapped = false;
+    refresh();
+}
+
+/*
+ * name:      refresh 
+ * purpose:   points the view at the table's own vectors 
+ * arguments: none
+ * returns:   none 
+ * effects:   called after every change, since the vectors may have moved 
+*/
+void pathTable::refresh() {
+    view.directories = directories.data();
+    view.files = files.data();
+    view.firstFiles = firstFiles.data();
+    view.endFiles = endFiles.data();
+    view.names = names.data();
+    view.numDirectories = directories.size();
+    view.numFiles = files.size();
+    view.namesBytes = names.length();
+}
+
+/*
+ * name:      own 
+ * purpose:   copies a mapped image into the table's own vectors 
+ * arguments: none
+ * returns:   none 
+ * effects:   does nothing unless the table is read from a mapped image, so 
+ *            it is called before every change 
+*/
+void pathTable::own() {
+    if (not mapped) {
+        return;
+    }
+
+    directories.assign(view.directories, 
+                       view.directories + view.numDirectories);
+    files.assign(view.files, view.files + view.numFiles);
+    firstFiles.assign(view.firstFiles, view.firstFiles + view.numDirectories);
+    endFiles.assign(view.endFiles, view.endFiles + view.numDirectories);
+    names.assign(view.names, view.namesBytes);
+    mapped = false;
+    refresh();
+}
+
+/*
+ * name:      makeEntry 
+ * purpose:   creates an entry for a directory or file 
+ * arguments: a size_t with the entry's parent directory and a string with 
+ *            its name 
+ * returns:   the new Entry 
+ * effects:   appends the name to the names buffer. Throws a runtime_error if
+ *            there are more directories than fit in an entry. 
+*/
+pathTable::Entry pathTable::makeEntry(size_t parent, const string &name) {
+    //parents are stored in 32 bits, with every bit set for no parent 
+    if (parent != NO_PARENT and parent >= UINT32_MAX) {
+        throw runtime_error("Too many directories for the path table");
+    }
+
+    own();
+    Entry entry;
+    entry.parent = parent == NO_PARENT ? UINT32_MAX : (uint32_t) parent;
+    entry.length = name.length();
+    entry.offset = names.length();
+    names += name;
+
+    return entry;
+}
+
+/*
+ * name:      addDirectory 
+ * purpose:   adds a directory to the table 
+ * arguments: a size_t with the number of the parent directory (NO_PARENT for 
+ *            the directory being indexed) and a string with the directory's
+ *            name (the whole path as given for the directory being indexed)
+ * returns:   a size_t with the number of the new directory 
+ * effects:   stores the directory's name and parent, and the number of the 
+ *            next file as the start of the files under it 
+*/
+size_t pathTable::addDirectory(size_t parent, const string &name) {
+    directories.push_back(makeEntry(parent, name));
+    firstFiles.push_back(files.size());
+    endFiles.push_back(NOT_FINISHED);
+    refresh();
+    return directories.size() - 1;
+}
+
+/*
+ * name:      startDirectory 
+ * purpose:   marks where the files under a directory start 
+ * arguments: a size_t with the number of the directory 
+ * returns:   none 
+ * effects:   records the number of files so far as the start of the range 
+ *            of files under the directory, for a directory added before the
+ *            files ahead of it 
+*/
+void pathTable::startDirectory(size_t directory) {
+    own();
+    firstFiles.at(directory) = files.size();
+}
+
+/*
+ * name:      finishDirectory 
+ * purpose:   marks that every file under a directory has been added 
+ * arguments: a size_t with the number of the directory 
+ * returns:   none 
+ * effects:   records the number of files so far as the end of the range of
+ *            files under the directory 
+*/
+void pathTable::finishDirectory(size_t directory) {
+    own();
+    endFiles.at(directory) = files.size();
+}
+
+/*
+ * name:      addFile 
+ * purpose:   adds a file to the table 
+ * arguments: a size_t with the number of the directory the file is in and a
+ *            string with the file's name 
+ * returns:   a size_t with the number of the new file, which is also its 
+ *            index for the file's locations in the hashTable 
+ * effects:   stores the file's name and directory 
+*/
+size_t pathTable::addFile(size_t directory, const string &name) {
+    files.push_back(makeEntry(directory, name));
+    refresh();
+    size_t file = files.size() - 1;
+
+    //a file added to a finished directory goes in a later range of it and 
+    //of each directory above it, extending the last range where it can 
+    if (directory < endFiles.size() and endFiles[directory] != NOT_FINISHED) {
+        later.resize(directories.size());
+        for (uint32_t dir = directory; dir != UINT32_MAX; 
+             dir = directories[dir].parent) {
+            vector<pair<size_t, size_t>> &ranges = later[dir];
+            if (not ranges.empty() and ranges.back().second == file) {
+                ranges.back().second++;
+            } else {
+                ranges.push_back(make_pair(file, file + 1));
+            }
+        }
+    }
+
+    return file;
+}
+
+/*
+ * name:      addDirectoryPath 
+ * purpose:   gets the directory of a path, adding it if it is new 
+ * arguments: a string with the path of a directory 
+ * returns:   a size_t with the number of the directory 
+ * effects:   finds the deepest directory in the table that the path is 
+ *            under (as findDirectory reads paths) and adds each directory 
+ *            below it that is missing, finished at once so later files 
+ *            added to it go in its later ranges. A path that is not under 
+ *            the indexed directory gets an entry of its own, with the whole
+ *            path as its name, the first time it is given. 
+*/
+size_t pathTable::addDirectoryPath(const string &dirPath) {
+    size_t directory = 0;
+    if (findDirectory(dirPath, directory)) {
+        return directory;
+    }
+
+    //drop names from the end until the rest of the path is found 
+    vector<string> missing;
+    string rest = dirPath;
+    bool found = false;
+    while (not found) {
+        while (rest.length() > 1 and rest.back() == '/') {
+            rest.pop_back();
+        }
+        size_t slash = rest.rfind('/');
+        if (slash == string::npos or slash == 0) {
+            break;
+        }
+        missing.push_back(rest.substr(slash + 1));
+        rest.resize(slash);
+        found = findDirectory(rest, directory);
+    }
+
+    //a path outside the indexed directory stands on its own 
+    if (not found) {
+        for (size_t i = 0; i < view.numDirectories; i++) {
+            const Entry &dir = view.directories[i];
+            if (dir.parent == UINT32_MAX and dir.length == dirPath.length() 
+                and memcmp(view.names + dir.offset, dirPath.data(), 
+                           dir.length) == 0) {
+                return i;
+            }
+        }
+        directory = addDirectory(NO_PARENT, dirPath);
+        finishDirectory(directory);
+        return directory;
+    }
+
+    //add the missing directories, outermost first 
+    for (size_t i = missing.size(); i > 0; i--) {
+        directory = addDirectory(directory, missing[i - 1]);
+        finishDirectory(directory);
+    }
+    return directory;
+}
+
+/*
+ * name:      appendPath 
+ * purpose:   rebuilds the full path of a file 
+ * arguments: a size_t with the number of a file and a string to add the path
+ *            to 
+ * returns:   none 
+ * effects:   follows the file's parents back to the first directory to find
+ *            the length of the path, then follows them again writing each 
+ *            name, separated by '/', into the end of the buffer. 
+ *            Only reads the table, so it is safe to call from several 
+ *            threads at once. 
+*/
+void pathTable::appendPath(size_t file, string &buffer) const {
+    if (file >= view.numFiles) {
+        throw out_of_range("No file " + to_string(file) + " in path table");
+    }
+    const Entry &entry = view.files[file];
+    const Entry *dirs = view.directories;
+
+    //find the length of the path, one '/' after each directory 
+    size_t length = entry.length;
+    for (uint32_t dir = entry.parent; dir != UINT32_MAX; 
+         dir = dirs[dir].parent) {
+        length += dirs[dir].length + 1;
+    }
+
+    //make room, then fill the path in from the back 
+    size_t end = buffer.length() + length;
+    buffer.resize(end);
+    char *out = &buffer[0] + end;
+
+    out -= entry.length;
+    memcpy(out, view.names + entry.offset, entry.length);
+    for (uint32_t dir = entry.parent; dir != UINT32_MAX; 
+         dir = dirs[dir].parent) {
+        *--out = '/';
+        out -= dirs[dir].length;
+        memcpy(out, view.names + dirs[dir].offset, dirs[dir].length);
+    }
+}
+
+/*
+ * name:      path 
+ * purpose:   gets the full path of a file 
+ * arguments: a size_t with the number of a file 
+ * returns:   a string with the file's path 
+ * effects:   calls appendPath with an empty string 
+*/
+string pathTable::path(size_t file) const {
+    string result;
+    appendPath(file, result);
+    return result;
+}
+
+/*
+ * name:      directoryPath 
+ * purpose:   gets the full path of a directory 
+ * arguments: a size_t with the number of a directory 
+ * returns:   a string with the directory's path 
+ * effects:   follows the directory's parents up to the indexed directory 
+*/
+string pathTable::directoryPath(size_t directory) const {
+    string result;
+    const Entry *dirs = view.directories;
+    for (uint32_t dir = directory; dir != UINT32_MAX; 
+         dir = dirs[dir].parent) {
+        string name(view.names + dirs[dir].offset, dirs[dir].length);
+        result = result.empty() ? name : name + "/" + result;
+    }
+    return result;
+}
+
+/*
+ * name:      findChild 
+ * purpose:   finds a directory by its parent and name 
+ * arguments: a size_t with the parent's number, a string with the name, and
+ *            a reference to a size_t to store the directory's number in 
+ * returns:   returns true if the directory was found, false otherwise 
+ * effects:   scans the directories added after the parent (children are 
+ *            always added after their parent). The cost is the number of 
+ *            directories, which is small next to the number of files. 
+*/
+bool pathTable::findChild(size_t parent, const string &name, 
+                          size_t &child) const {
+    for (size_t i = parent + 1; i < view.numDirectories; i++) {
+        const Entry &dir = view.directories[i];
+        if (dir.parent == parent and dir.length == name.length() and 
+            memcmp(view.names + dir.offset, name.data(), dir.length) == 0) {
+            child = i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * name:      findDirectory 
+ * purpose:   finds a directory by its path 
+ * arguments: a string with a path and a reference to a size_t to store the 
+ *            directory's number in 
+ * returns:   returns true if the directory was found, false otherwise 
+ * effects:   accepts either a path starting with the indexed directory (as 
+ *            printed in results) or a path relative to it. Trailing '/'s, 
+ *            empty names and "." are ignored. 
+*/
+bool pathTable::findDirectory(const string &dirPath, 
+                              size_t &directory) const {
+    if (view.numDirectories == 0) {
+        return false;
+    }
+
+    //drop the indexed directory's own name from the front of the path 
+    const Entry &root = view.directories[0];
+    string rootName(view.names + root.offset, root.length);
+    string rest = dirPath;
+    while (rest.length() > 1 and rest.back() == '/') {
+        rest.pop_back();
+    }
+    while (rootName.length() > 1 and rootName.back() == '/') {
+        rootName.pop_back();
+    }
+    if (rest == rootName) {
+        rest = "";
+    } else if (rest.compare(0, rootName.length() + 1, rootName + "/") == 0) {
+        rest = rest.substr(rootName.length() + 1);
+    }
+
+    //follow each name in the rest of the path down from the root 
+    directory = 0;
+    size_t start = 0;
+    while (start <= rest.length()) {
+        size_t end = rest.find('/', start);
+        if (end == string::npos) {
+            end = rest.length();
+        }
+
+        string name = rest.substr(start, end - start);
+        if (not name.empty() and name != "." and 
+            not findChild(directory, name, directory)) {
+            return false;
+        }
+        start = end + 1;
+    }
+
+    return true;
+}
+
+/*
+ * name:      fileRange 
+ * purpose:   gets the range of file numbers under a directory 
+ * arguments: a size_t with the number of a directory, and references to 
+ *            size_ts to store the first file number and one past the last 
+ *            file number in 
+ * returns:   none 
+ * effects:   a directory that is not finished yet extends to the last file 
+ *            added so far 
+*/
+void pathTable::fileRange(size_t directory, size_t &firstFile, 
+                          size_t &endFile) const {
+    if (directory >= view.numDirectories) {
+        throw out_of_range("No directory " + to_string(directory) + 
+                           " in path table");
+    }
+    firstFile = view.firstFiles[directory];
+    endFile = view.endFiles[directory];
+    if (endFile == NOT_FINISHED) {
+        endFile = view.numFiles;
+    }
+}
+
+/*
+ * name:      laterRanges 
+ * purpose:   gets the ranges of files added under a directory after it was
+ *            finished 
+ * arguments: a size_t with the number of a directory 
+ * returns:   a reference to the ranges of file numbers, each a first file 
+ *            and one past the last, in order 
+ * effects:   none. The reference changes when files are added. 
+*/
+const vector<pair<size_t, size_t>> &pathTable::laterRanges(
+    size_t directory) const {
+    static const vector<pair<size_t, size_t>> none;
+    if (directory >= later.size()) {
+        return none;
+    }
+    return later[directory];
+}
+
+/*
+ * name:      size 
+ * purpose:   gets the number of files in the table 
+ * arguments: none
+ * returns:   a size_t with the number of files 
+ * effects:   none 
+*/
+size_t pathTable::size() const {
+    return view.numFiles;
+}
+
+/*
+ * name:      numDirectories 
+ * purpose:   gets the number of directories in the table 
+ * arguments: none
+ * returns:   a size_t with the number of directories 
+ * effects:   none 
+*/
+size_t pathTable::numDirectories() const {
+    return view.numDirectories;
+}
+
+/*
+ * name:      bytes 
+ * purpose:   gets the memory used by the table 
+ * arguments: none
+ * returns:   a size_t with the bytes used, including unused capacity (0 
+ *            while the table is read from a mapped image, which is shared)
+ * effects:   none 
+*/
+size_t pathTable::bytes() const {
+    if (mapped) {
+        return 0;
+    }
+    return (directories.capacity() + files.capacity()) * sizeof(Entry) + 
+           (firstFiles.capacity() + endFiles.capacity()) * sizeof(uint64_t) +
+           names.capacity();
+}
+
+/*
+ * name:      writeImage 
+ * purpose:   writes the table out so it can be mapped later 
+ * arguments: a reference to the ostream to write to 
+ * returns:   none 
+ * effects:   writes the numbers of directories, files and name bytes as 
+ *            three uint64_ts, then the directory entries, the file entries,
+ *            the first and end files of each directory, and the names. 
+ *            Every part is a multiple of 8 bytes long except the names, so 
+ *            the image holds no pointers and needs only 8 byte alignment. 
+*/
+void pathTable::writeImage(ostream &out) const {
+    uint64_t counts[3] = {view.numDirectories, view.numFiles, 
+                          view.namesBytes};
+    out.write((const char *) counts, sizeof(counts));
+    out.write((const char *) view.directories, 
+              view.numDirectories * sizeof(Entry));
+    out.write((const char *) view.files, view.numFiles * sizeof(Entry));
+    out.write((const char *) view.firstFiles, 
+              view.numDirectories * sizeof(uint64_t));
+    out.write((const char *) view.endFiles, 
+              view.numDirectories * sizeof(uint64_t));
+    out.write(view.names, view.namesBytes);
+}
+
+/*
+ * name:      attach 
+ * purpose:   reads the table from an image written by writeImage 
+ * arguments: a pointer to the image (8 byte aligned) and its length 
+ * returns:   none 
+ * effects:   points the view into the image without copying it, and empties
+ *            the table's own vectors. The image must stay mapped while the 
+ *            table uses it. Throws a runtime_error if the image is too short
+ *            for the counts at its start, or if an entry's name or parent 
+ *            is outside the table (every parent must come before its 
+ *            children, so following parents always ends). 
+*/
+void pathTable::attach(const char *image, size_t length) {
+    uint64_t counts[3];
+    if (length < sizeof(counts)) {
+        throw runtime_error("Path table image is too short");
+    }
+    memcpy(counts, image, sizeof(counts));
+
+    //the parts must fit in the image 
+    uint64_t needed = sizeof(counts) + (counts[0] + counts[1]) * 
+                      sizeof(Entry) + counts[0] * 2 * sizeof(uint64_t) + 
+                      counts[2];
+    if (counts[0] > length or counts[1] > length or counts[2] > length or 
+        needed > length) {
+        throw runtime_error("Path table image is too short");
+    }
+
+    //every name must be in the names, and every parent a directory before 
+    //the entry (the first directory has none) 
+    const Entry *entries = (const Entry *) (image + sizeof(counts));
+    for (uint64_t i = 0; i < counts[0] + counts[1]; i++) {
+        const Entry &entry = entries[i];
+        bool isFile = i >= counts[0];
+        bool goodParent = isFile ? entry.parent < counts[0] : 
+                          (i == 0 ? entry.parent == UINT32_MAX : 
+                                    entry.parent < i);
+        if (not goodParent or entry.offset > counts[2] or 
+            entry.length > counts[2] - entry.offset) {
+            throw runtime_error("Path table image is damaged");
+        }
+    }
+
+    //find each part of the image 
+    const char *part = image + sizeof(counts);
+    view.numDirectories = counts[0];
+    view.numFiles = counts[1];
+    view.namesBytes = counts[2];
+    view.directories = (const Entry *) part;
+    part += counts[0] * sizeof(Entry);
+    view.files = (const Entry *) part;
+    part += counts[1] * sizeof(Entry);
+    view.firstFiles = (const uint64_t *) part;
+    part += counts[0] * sizeof(uint64_t);
+    view.endFiles = (const uint64_t *) part;
+    part += counts[0] * sizeof(uint64_t);
+    view.names = part;
+
+    vector<Entry>().swap(directories);
+    vector<Entry>().swap(files);
+    vector<uint64_t>().swap(firstFiles);
+    vector<uint64_t>().swap(endFiles);
+    string().swap(names);
+    vector<vector<pair<size_t, size_t>>>().swap(later);
+    mapped = true;
+}
@@ -0,0 +1,134 @@
+/*
+ *  pathTable.h
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  pathTable is a class that stores the paths of the files in the directory 
+ *  without repeating their directory prefixes. Each directory is stored once
+ *  as its name and the number of its parent directory, and each file as its
+ *  name and the number of the directory it is in. All names live in one 
+ *  shared character buffer. A file's full path is rebuilt by following its 
+ *  parents back to the directory that was indexed and appending each name to
+ *  a buffer provided by the caller. When directories are added in depth 
+ *  first order (each directory's files before its subdirectories), all of 
+ *  the files under a directory have consecutive numbers, and the table 
+ *  records that range for each directory. Files added to a directory after
+ *  it is finished (such as files that change while gerp is watching) are 
+ *  outside that range, so the table also keeps, for the directory and each
+ *  directory above it, the later ranges of file numbers they were given. 
+ *  The table can be written out as an image with no pointers in it and 
+ *  later read straight from a mapping of that image, shared with other 
+ *  processes; it is only copied into memory of its own if files are added 
+ *  to it after that. 
+ *
+*/
+
+#ifndef PATHTABLE_H
+#define PATHTABLE_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+class pathTable {
+//public functions available to the client 
+public:
+    pathTable();
+
+    //the view points into the table's own vectors, so it is not copied 
+    pathTable(const pathTable &other) = delete;
+    pathTable &operator=(const pathTable &other) = delete;
+
+    //functions for adding directories and files 
+    size_t addDirectory(size_t parent, const string &name);
+    size_t addFile(size_t directory, const string &name);
+    size_t addDirectoryPath(const string &dirPath);
+
+    void startDirectory(size_t directory);
+    void finishDirectory(size_t directory);
+
+    //functions for getting paths back 
+    void appendPath(size_t file, string &buffer) const;
+    string path(size_t file) const;
+    string directoryPath(size_t directory) const;
+
+    //functions for finding the files under a directory 
+    bool findDirectory(const string &dirPath, size_t &directory) const;
+    void fileRange(size_t directory, size_t &firstFile, 
+                   size_t &endFile) const;
+    const vector<pair<size_t, size_t>> &laterRanges(size_t directory) const;
+
+    //functions for the size of the table 
+    size_t size() const;
+    size_t numDirectories() const;
+    size_t bytes() const;
+
+    //functions for writing the table out and reading it from a mapping 
+    void writeImage(ostream &out) const;
+    void attach(const char *image, size_t length);
+
+    //parent of the first directory added 
+    static const size_t NO_PARENT = (size_t) -1;
+
+private:
+    // 
+    //  Entry struct, used to store a directory or file: the number of the
+    //  directory it is in and where its name is in the names buffer 
+    // 
+    struct Entry {
+        uint32_t parent;
+        uint32_t length;
+        uint64_t offset;
+    };
+
+    // 
+    //  View struct, used to read the table from wherever it is: its own 
+    //  vectors, or an image mapped from a file 
+    // 
+    struct View {
+        const Entry *directories;
+        const Entry *files;
+        const uint64_t *firstFiles;
+        const uint64_t *endFiles;
+        const char *names;
+        uint64_t numDirectories;
+        uint64_t numFiles;
+        uint64_t namesBytes;
+    };
+
+    //directories, files, and all of their names back to back 
+    vector<Entry> directories;
+    vector<Entry> files;
+    string names;
+
+    //for each directory, the first file added after it and the number of 
+    //files once it was finished (NOT_FINISHED until then) 
+    vector<uint64_t> firstFiles;
+    vector<uint64_t> endFiles;
+    static const uint64_t NOT_FINISHED = (uint64_t) -1;
+
+    //for each directory, the ranges of files added under it after it was 
+    //finished (empty for most directories, and never in an image) 
+    vector<vector<pair<size_t, size_t>>> later;
+
+    //where the table is read from, and whether that is a mapped image 
+    View view;
+    bool mapped;
+
+    //helper functions for pointing the view at the vectors, and for 
+    //copying a mapped image into them before a change 
+    void refresh();
+    void own();
+
+    //helper function for finding a directory by name 
+    bool findChild(size_t parent, const string &name, size_t &child) const;
+
+    //helper function for adding an entry 
+    Entry makeEntry(size_t parent, const string &name);
+};
+
+#endif
@@ -0,0 +1,371 @@
+/*
+ *  postingCursor.cpp
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  Contains an implementation of the PostingCursor class.   
+ *
+*/
+
+#include "postingCursor.h"
+#include <algorithm>
+
+/*
+ * name:      PostingCursor default constructor 
+ * purpose:   creates a cursor with no results 
+ * arguments: none
+ * returns:   none 
+ * effects:   sets the cursor to be done from the start 
+*/
+PostingCursor::PostingCursor() {
+    isRanked = false;
+    rankedHead = 0;
+    consumed = 0;
+    dead = nullptr;
+}
+
+/*
+ * name:      PostingCursor constructor 
+ * purpose:   creates a cursor over the given sorted lists of locations 
+ * arguments: a vector of pointers to sorted vectors of locations 
+ * returns:   none 
+ * effects:   stores the lists and starts at the front of each one 
+*/
+PostingCursor::PostingCursor(const vector<const vector<Instance> *> 
+                             &locationLists) {
+    for (size_t i = 0; i < locationLists.size(); i++) {
+        LocationList list = {locationLists[i]->data(), 
+                             locationLists[i]->size()};
+        lists.push_back(list);
+        ends.push_back(list.size);
+    }
+    starts.assign(lists.size(), 0);
+    heads.assign(lists.size(), 0);
+    isRanked = false;
+    rankedHead = 0;
+    consumed = 0;
+    dead = nullptr;
+}
+
+/*
+ * name:      PostingCursor constructor 
+ * purpose:   creates a cursor over the given sorted arrays of locations 
+ * arguments: a vector of LocationLists, each a sorted array of locations 
+ *            and its size 
+ * returns:   none 
+ * effects:   stores the lists and starts at the front of each one 
+*/
+PostingCursor::PostingCursor(const vector<LocationList> &locationLists) {
+    lists = locationLists;
+    starts.assign(lists.size(), 0);
+    heads.assign(lists.size(), 0);
+    for (size_t i = 0; i < lists.size(); i++) {
+        ends.push_back(lists[i].size);
+    }
+    isRanked = false;
+    rankedHead = 0;
+    consumed = 0;
+    dead = nullptr;
+}
+
+/*
+ * name:      peek 
+ * purpose:   finds the smallest location that has not been returned yet 
+ * arguments: a reference to a PackedLocation to store the location in 
+ * returns:   returns true if there is a location left, false otherwise 
+ * effects:   looks at the front of each list. There is one list per case 
+ *            variant of a word, so a linear scan beats a heap here. Moves 
+ *            past every location in a deleted file on the way. 
+*/
+bool PostingCursor::peek(PackedLocation &smallest) {
+    while (true) {
+        bool found = false;
+
+        for (size_t i = 0; i < lists.size(); i++) {
+            if (heads[i] < ends[i]) {
+                PackedLocation front = lists[i].data[heads[i]].packed;
+                if (not found or front < smallest) {
+                    smallest = front;
+                    found = true;
+                }
+            }
+        }
+
+        if (not found) {
+            return false;
+        }
+
+        //skip the whole file if it was deleted 
+        size_t file = smallest >> Instance::LINE_BITS;
+        if (dead == nullptr or file >= dead->size() or not (*dead)[file]) {
+            return true;
+        }
+        passFile(file);
+    }
+}
+
+/*
+ * name:      passFile 
+ * purpose:   moves every list past the locations in a file 
+ * arguments: a size_t with the file number 
+ * returns:   none 
+ * effects:   binary searches each list for the first location in a later 
+ *            file 
+*/
+void PostingCursor::passFile(size_t file) {
+    for (size_t i = 0; i < lists.size(); i++) {
+        const Instance *list = lists[i].data;
+
+        if (file == Instance::MAX_FILE) {
+            heads[i] = ends[i];
+            continue;
+        }
+
+        Instance bound(file + 1, 0);
+        heads[i] = lower_bound(list + heads[i], list + ends[i], bound) - 
+                   list;
+    }
+}
+
+/*
+ * name:      next 
+ * purpose:   gets the next result of the query 
+ * arguments: a reference to an Instance to store the result in 
+ * returns:   returns true if a result was stored, false if there are none left
+ * effects:   moves past the result in every list that holds it, so a line 
+ *            found by several case variants is only returned once 
+*/
+bool PostingCursor::next(Instance &location) {
+    //ranked results were already merged by rankByFile 
+    if (isRanked) {
+        if (rankedHead == ranked.size()) {
+            return false;
+        }
+        location = ranked[rankedHead++];
+        consumed++;
+        return true;
+    }
+
+    PackedLocation smallest = 0;
+    if (not peek(smallest)) {
+        return false;
+    }
+
+    //advance every list whose front is the smallest location 
+    for (size_t i = 0; i < lists.size(); i++) {
+        if (heads[i] < ends[i] and 
+            lists[i].data[heads[i]].packed == smallest) {
+            heads[i]++;
+        }
+    }
+
+    location.packed = smallest;
+    consumed++;
+    return true;
+}
+
+/*
+ * name:      nextFile 
+ * purpose:   gets the next file with results and moves past all of them 
+ * arguments: a reference to a size_t to store the file number in 
+ * returns:   returns true if a file was stored, false if there are none left
+ * effects:   finds the file of the next result and binary searches each list
+ *            for the first location in a later file, so the cost depends on
+ *            the number of files rather than the number of results. Does not
+ *            change position(). 
+*/
+bool PostingCursor::nextFile(size_t &file) {
+    //ranked results are grouped by file, step past this file's group 
+    if (isRanked) {
+        if (rankedHead == ranked.size()) {
+            return false;
+        }
+        file = ranked[rankedHead].file_path_index();
+        while (rankedHead < ranked.size() and 
+               ranked[rankedHead].file_path_index() == file) {
+            rankedHead++;
+        }
+        return true;
+    }
+
+    PackedLocation smallest = 0;
+    if (not peek(smallest)) {
+        return false;
+    }
+    file = smallest >> Instance::LINE_BITS;
+
+    //move every list to its first location past this file 
+    passFile(file);
+    return true;
+}
+
+/*
+ * name:      skip 
+ * purpose:   moves past a number of results without returning them 
+ * arguments: a size_t with the number of results to skip 
+ * returns:   a size_t with the number of results actually skipped 
+ * effects:   jumps straight to the position when there is only one list and
+ *            no deleted files (or the results are ranked), otherwise steps 
+ *            through the merge 
+*/
+size_t PostingCursor::skip(size_t count) {
+    size_t skipped = 0;
+
+    //one list (or the ranked results) can be skipped by moving the index 
+    if (isRanked or (lists.size() == 1 and dead == nullptr)) {
+        size_t &head = isRanked ? rankedHead : heads[0];
+        size_t size = isRanked ? ranked.size() : ends[0];
+
+        skipped = min(count, size - head);
+        head += skipped;
+        consumed += skipped;
+        return skipped;
+    }
+
+    //otherwise step through the merge 
+    Instance location;
+    while (skipped < count and next(location)) {
+        skipped++;
+    }
+
+    return skipped;
+}
+
+/*
+ * name:      restart 
+ * purpose:   moves the cursor back to the first result 
+ * arguments: none
+ * returns:   none 
+ * effects:   resets the position in each list (or in the ranked results) 
+ *            to the first result in range 
+*/
+void PostingCursor::restart() {
+    heads = starts;
+    rankedHead = 0;
+    consumed = 0;
+}
+
+/*
+ * name:      done 
+ * purpose:   checks whether every result has been returned 
+ * arguments: none
+ * returns:   returns true if there are no results left, false otherwise 
+ * effects:   none 
+*/
+bool PostingCursor::done() {
+    if (isRanked) {
+        return rankedHead == ranked.size();
+    }
+
+    PackedLocation smallest = 0;
+    return not peek(smallest);
+}
+
+/*
+ * name:      restrictFiles 
+ * purpose:   limits the results to a range of file numbers 
+ * arguments: a size_t with the first file number to keep and a size_t one 
+ *            past the last file number to keep 
+ * returns:   none 
+ * effects:   binary searches each list for the first location in the first
+ *            file and the first location past the last file, so only the 
+ *            locations in between are ever looked at. Restarts the cursor. 
+ *            Must be called before rankByFile. 
+*/
+void PostingCursor::restrictFiles(size_t firstFile, size_t endFile) {
+    for (size_t i = 0; i < lists.size(); i++) {
+        const Instance *list = lists[i].data;
+        size_t size = lists[i].size;
+
+        //first location at or past the first file 
+        starts[i] = size;
+        if (firstFile <= Instance::MAX_FILE) {
+            starts[i] = lower_bound(list, list + size, 
+                                    Instance(firstFile, 0)) - list;
+        }
+
+        //first location at or past the end file 
+        ends[i] = size;
+        if (endFile <= Instance::MAX_FILE) {
+            ends[i] = lower_bound(list + starts[i], list + size, 
+                                  Instance(endFile, 0)) - list;
+        }
+        ends[i] = max(ends[i], starts[i]);
+    }
+
+    restart();
+}
+
+/*
+ * name:      skipFiles 
+ * purpose:   leaves the results in deleted files out 
+ * arguments: a pointer to a vector with true for each deleted file number 
+ *            (files past its end are not deleted), or nullptr for none 
+ * returns:   none 
+ * effects:   the vector is read as the cursor moves, so it must outlive the
+ *            cursor. Must be called before rankByFile. 
+*/
+void PostingCursor::skipFiles(const vector<bool> *deadFiles) {
+    dead = deadFiles;
+}
+
+/*
+ * name:      rankByFile 
+ * purpose:   orders the results so files with the most results come first 
+ * arguments: none
+ * returns:   none 
+ * effects:   merges all of the results into one vector, counts the results 
+ *            in each file and reorders the files by that count (ties and the
+ *            lines within a file stay in file and line order). Restarts the
+ *            cursor at the first result. 
+*/
+void PostingCursor::rankByFile() {
+    //merge every result into one vector 
+    restart();
+    isRanked = false;
+    ranked.clear();
+    Instance location;
+    while (next(location)) {
+        ranked.push_back(location);
+    }
+
+    //find where each file's results start and end 
+    vector<pair<size_t, size_t>> files;
+    for (size_t i = 0; i < ranked.size(); i++) {
+        if (i == 0 or ranked[i].file_path_index() != 
+                      ranked[i - 1].file_path_index()) {
+            files.push_back(make_pair(i, i));
+        }
+        files.back().second = i + 1;
+    }
+
+    //order the files by their number of results, most first 
+    stable_sort(files.begin(), files.end(), 
+                [](const pair<size_t, size_t> &a, 
+                   const pair<size_t, size_t> &b) {
+                    return a.second - a.first > b.second - b.first;
+                });
+
+    //copy each file's results in the new order 
+    vector<Instance> reordered;
+    reordered.reserve(ranked.size());
+    for (size_t i = 0; i < files.size(); i++) {
+        reordered.insert(reordered.end(), ranked.begin() + files[i].first,
+                         ranked.begin() + files[i].second);
+    }
+    ranked.swap(reordered);
+
+    isRanked = true;
+    restart();
+}
+
+/*
+ * name:      position 
+ * purpose:   gets how many results have been returned or skipped 
+ * arguments: none
+ * returns:   a size_t with the number of results passed so far 
+ * effects:   none 
+*/
+size_t PostingCursor::position() {
+    return consumed;
+}
@@ -0,0 +1,113 @@
+/*
+ *  postingCursor.h
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  PostingCursor is a class that streams the locations of a query one at a 
+ *  time. It walks one or more sorted lists of locations (one per case 
+ *  sensitive variant of a word) in step, merging them lazily and skipping
+ *  repeated locations, so the first results of a query can be printed before
+ *  the rest are looked at. The cursor keeps its place between calls, which 
+ *  lets gerp print a query's results a page at a time without starting over.
+ *  Results come out in file and line order, or optionally with the files 
+ *  that have the most matching lines first, and can be limited to a range of
+ *  file numbers (such as the files under one directory). The lists are not 
+ *  copied (they may be vectors or arrays in a mapped index file), so they 
+ *  must not change while the cursor is in use. 
+ *
+*/
+
+#ifndef POSTINGCURSOR_H
+#define POSTINGCURSOR_H
+
+#include "packedLocation.h"
+#include <vector>
+
+using namespace std;
+
+class PostingCursor {
+//public functions available to the client 
+public:
+    PostingCursor();
+    PostingCursor(const vector<const vector<Instance> *> &locationLists);
+    PostingCursor(const vector<LocationList> &locationLists);
+
+    //functions for walking through the results 
+    bool next(Instance &location);
+    bool nextFile(size_t &file);
+    template<typename Visit>
+    void forEach(Visit visit);
+    size_t skip(size_t count);
+    void restart();
+    bool done();
+
+    //functions for limiting results to some files (a range, and leaving out
+    //deleted files) and ordering files by number of results 
+    void restrictFiles(size_t firstFile, size_t endFile);
+    void skipFiles(const vector<bool> *deadFiles);
+    void rankByFile();
+
+    //number of results returned or skipped since the start 
+    size_t position();
+
+private:
+    //the sorted lists being merged, where the results in range start and 
+    //end in each one, and how far into each one we are 
+    vector<LocationList> lists;
+    vector<size_t> starts;
+    vector<size_t> ends;
+    vector<size_t> heads;
+
+    //results reordered by rankByFile, and how far into them we are 
+    vector<Instance> ranked;
+    bool isRanked;
+    size_t rankedHead;
+
+    //number of results returned so far 
+    size_t consumed;
+
+    //files whose results are left out (nullptr for none) 
+    const vector<bool> *dead;
+
+    //helper functions for finding the smallest location left in the lists
+    //and moving every list past a file 
+    bool peek(PackedLocation &smallest);
+    void passFile(size_t file);
+};
+
+/*
+ * name:      forEach 
+ * purpose:   gets every result that is left, or until told to stop 
+ * arguments: a function to call with each result (an Instance), returning 
+ *            true to go on and false to stop 
+ * returns:   none 
+ * effects:   calls the function with each result in order and moves the 
+ *            cursor past each result it was called with. A single list with
+ *            no deleted files (such as a case sensitive word's) is read 
+ *            straight through, without the merge and its checks for 
+ *            repeated lines, which is where a count spends its time; 
+ *            anything else goes through next. 
+*/
+template<typename Visit>
+void PostingCursor::forEach(Visit visit) {
+    //one list has no repeats to merge away 
+    if (not isRanked and lists.size() == 1 and dead == nullptr) {
+        const Instance *list = lists[0].data;
+        size_t start = heads[0], end = ends[0], i = start;
+        while (i < end and visit(list[i])) {
+            i++;
+        }
+        if (i < end) {
+            i++;
+        }
+        consumed += i - start;
+        heads[0] = i;
+        return;
+    }
+
+    Instance location;
+    while (next(location) and visit(location)) {
+    }
+}
+
+#endif
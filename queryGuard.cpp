@@ -0,0 +1,153 @@
+/*
+ *  queryGuard.cpp
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  Contains an implementation of the queryGuard class. 
+ *
+*/
+
+#include "queryGuard.h"
+
+//definitions of the constants and flags declared in the class 
+const size_t queryGuard::CHECK_INTERVAL;
+atomic<bool> queryGuard::active(false);
+atomic<bool> queryGuard::cancelled(false);
+
+/*
+ * name:      queryGuard constructor 
+ * purpose:   creates a guard with no query running 
+ * arguments: none 
+ * returns:   none 
+ * effects:   none 
+*/
+queryGuard::queryGuard() {
+    timed = false;
+    maxResults = 0;
+    checks = 0;
+    stopped = NONE;
+}
+
+/*
+ * name:      start 
+ * purpose:   starts guarding a query 
+ * arguments: a size_t with the most milliseconds the query may run and a 
+ *            size_t with the most results it may give (0 for no limit on 
+ *            either) 
+ * returns:   none 
+ * effects:   sets the deadline, forgets any earlier cancellation and reason 
+ *            for stopping, and marks a query as running 
+*/
+void queryGuard::start(size_t timeoutMs, size_t resultLimit) {
+    timed = timeoutMs > 0;
+    deadline = chrono::steady_clock::now() +
+               chrono::milliseconds(timeoutMs);
+    maxResults = resultLimit;
+    checks = 0;
+    stopped = NONE;
+    cancelled.store(false);
+    active.store(true);
+}
+
+/*
+ * name:      finish 
+ * purpose:   stops guarding a query 
+ * arguments: none 
+ * returns:   none 
+ * effects:   marks no query as running, so a cancellation is no longer for 
+ *            a query 
+*/
+void queryGuard::finish() {
+    active.store(false);
+}
+
+/*
+ * name:      check 
+ * purpose:   asks now whether the query has run out of time or been 
+ *            cancelled 
+ * arguments: none 
+ * returns:   returns true if the query should stop, false otherwise 
+ * effects:   records why the query stopped. Not safe to call from several 
+ *            threads at once. 
+*/
+bool queryGuard::check() {
+    if (stopped != NONE) {
+        return true;
+    }
+    if (cancelled.load(memory_order_relaxed)) {
+        stopped = CANCELLED;
+    } else if (timed and chrono::steady_clock::now() >= deadline) {
+        stopped = TIME_LIMIT;
+    }
+    return stopped != NONE;
+}
+
+/*
+ * name:      late 
+ * purpose:   asks now whether the query has run out of time or been 
+ *            cancelled, for the threads working on one query 
+ * arguments: none 
+ * returns:   returns true if the query should stop, false otherwise 
+ * effects:   none, safe to call from several threads at once: it only reads
+ *            the atomic flag and the deadline (set before the query's 
+ *            threads start), not the reason the query's own thread records.
+ *            A query stopped for its time or by a cancellation still has 
+ *            its deadline passed or its flag set, so the answer is the same.
+*/
+bool queryGuard::late() const {
+    return cancelled.load(memory_order_relaxed) or
+           (timed and chrono::steady_clock::now() >= deadline);
+}
+
+/*
+ * name:      reason 
+ * purpose:   gets why the query was stopped 
+ * arguments: none 
+ * returns:   the Reason, NONE if it was not stopped 
+ * effects:   none 
+*/
+queryGuard::Reason queryGuard::reason() const {
+    return stopped;
+}
+
+/*
+ * name:      describe 
+ * purpose:   gets the name of a reason for stopping, for the output 
+ * arguments: the Reason 
+ * returns:   a pointer to its name 
+ * effects:   none 
+*/
+const char *queryGuard::describe(Reason why) {
+    if (why == TIME_LIMIT) {
+        return "time limit";
+    } else if (why == RESULT_LIMIT) {
+        return "result limit";
+    } else if (why == CANCELLED) {
+        return "cancelled";
+    }
+    return "none";
+}
+
+/*
+ * name:      cancel 
+ * purpose:   cancels the running query 
+ * arguments: none 
+ * returns:   none 
+ * effects:   sets the flag the query checks, which it sees within 
+ *            CHECK_INTERVAL locations or before its next file. Only touches 
+ *            a lock free atomic, so it is safe in a signal handler. 
+*/
+void queryGuard::cancel() {
+    cancelled.store(true);
+}
+
+/*
+ * name:      running 
+ * purpose:   checks whether a query is running 
+ * arguments: none 
+ * returns:   returns true if a query is running, false otherwise 
+ * effects:   none, safe in a signal handler 
+*/
+bool queryGuard::running() {
+    return active.load();
+}
@@ -0,0 +1,110 @@
+/*
+ *  queryGuard.h
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  queryGuard is a class that bounds how long one query runs and how many 
+ *  results it gives, so one query for a very common word cannot hold up 
+ *  everything after it. A query is given a deadline and a cap on its 
+ *  results when it starts, and can also be cancelled while it runs, by a 
+ *  signal handler or by another thread. Nothing is interrupted: the loops 
+ *  that walk a query's locations ask the guard whether to stop (looking at 
+ *  the clock only once every CHECK_INTERVAL questions), and the threads 
+ *  that read files for a query ask it before each file. Once a query is 
+ *  stopped, the guard keeps the reason, so the query can say where and why 
+ *  its output was cut short. 
+ *
+*/
+
+#ifndef QUERYGUARD_H
+#define QUERYGUARD_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+using namespace std;
+
+class queryGuard {
+//public functions available to the client 
+public:
+    enum Reason { NONE, TIME_LIMIT, RESULT_LIMIT, CANCELLED };
+
+    //number of calls to expired between looks at the clock 
+    static const size_t CHECK_INTERVAL = 256;
+
+    queryGuard();
+
+    //functions for starting and finishing a query 
+    void start(size_t timeoutMs, size_t resultLimit);
+    void finish();
+
+    //functions for asking whether a query should stop (expired and full are
+    //defined below, so the loops that call them once per location inline 
+    //them) 
+    inline bool expired();
+    bool check();
+    bool late() const;
+    inline bool full(size_t results);
+    Reason reason() const;
+    static const char *describe(Reason why);
+
+    //functions for cancelling the running query, safe to call from a 
+    //signal handler or any thread 
+    static void cancel();
+    static bool running();
+
+private:
+    //the deadline of the query (if timed), the most results it may give 
+    //(0 for no limit), the calls to expired since the clock was last read, 
+    //and why the query was stopped 
+    chrono::steady_clock::time_point deadline;
+    bool timed;
+    size_t maxResults;
+    size_t checks;
+    Reason stopped;
+
+    //whether a query is running, and whether it has been cancelled 
+    static atomic<bool> active;
+    static atomic<bool> cancelled;
+};
+
+/*
+ * name:      expired 
+ * purpose:   asks cheaply whether the query has run out of time or been 
+ *            cancelled, for loops that run once per location 
+ * arguments: none 
+ * returns:   returns true if the query should stop, false otherwise 
+ * effects:   only checks once every CHECK_INTERVAL calls (or once the query 
+ *            was stopped), so the clock is read rarely. Not safe to call 
+ *            from several threads at once. 
+*/
+inline bool queryGuard::expired() {
+    if (stopped != NONE) {
+        return true;
+    }
+    if (++checks < CHECK_INTERVAL) {
+        return false;
+    }
+    checks = 0;
+    return check();
+}
+
+/*
+ * name:      full 
+ * purpose:   asks whether the query has given as many results as it may 
+ * arguments: a size_t with the number of results given so far 
+ * returns:   returns true if the query should give no more, false otherwise
+ * effects:   records that the query stopped at its limit 
+*/
+inline bool queryGuard::full(size_t results) {
+    if (maxResults > 0 and results >= maxResults) {
+        if (stopped == NONE) {
+            stopped = RESULT_LIMIT;
+        }
+        return true;
+    }
+    return false;
+}
+
+#endif
@@ -0,0 +1,461 @@
+/*
+ *  resultWriter.cpp
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  Contains an implementation of the resultWriter class. 
+ *
+*/
+
+#include "resultWriter.h"
+
+//definitions of the constants declared in the class 
+const char resultWriter::PATH_RECORD;
+const char resultWriter::MATCH_RECORD;
+const char resultWriter::CONTEXT_RECORD;
+const char resultWriter::COUNT_RECORD;
+const char resultWriter::MESSAGE_RECORD;
+const char resultWriter::TRUNCATED_RECORD;
+const char resultWriter::KEY_RECORD;
+const char resultWriter::VARIANT_RECORD;
+
+/*
+ * name:      resultWriter constructor 
+ * purpose:   creates a resultWriter that writes one format 
+ * arguments: the Format to write (TEXT if none is given) 
+ * returns:   none 
+ * effects:   none 
+*/
+resultWriter::resultWriter(Format type) {
+    kind = type;
+}
+
+/*
+ * name:      parseFormat 
+ * purpose:   reads the name of a format 
+ * arguments: a string with the name ("text", "json" or "binary") and a 
+ *            reference to a Format to store it in 
+ * returns:   returns true if the name is a format, false otherwise 
+ * effects:   leaves the Format alone if the name is not a format 
+*/
+bool resultWriter::parseFormat(const string &name, Format &type) {
+    if (name == "text") {
+        type = TEXT;
+    } else if (name == "json") {
+        type = JSON;
+    } else if (name == "binary") {
+        type = BINARY;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/*
+ * name:      format 
+ * purpose:   gets the format the writer writes 
+ * arguments: none 
+ * returns:   the Format 
+ * effects:   none 
+*/
+resultWriter::Format resultWriter::format() const {
+    return kind;
+}
+
+/*
+ * name:      fileStart 
+ * purpose:   starts the lines of a file 
+ * arguments: a string to append to, the path of the file and its number 
+ * returns:   none 
+ * effects:   appends a path record in the binary format, so the lines that 
+ *            follow can be matched to their path; nothing in the others, 
+ *            where each line carries its path 
+*/
+void resultWriter::fileStart(string &buffer, const string &path,
+                             size_t file) const {
+    if (kind == BINARY) {
+        buffer += PATH_RECORD;
+        appendVarint(buffer, file);
+        appendBytes(buffer, path.data(), path.length());
+    }
+}
+
+/*
+ * name:      line 
+ * purpose:   writes one line of a file 
+ * arguments: a string to append to, the path and number of the file, the 
+ *            line number, the byte offset of the line in the file, a 
+ *            pointer to the text of the line (without its newline) and its 
+ *            length, and whether the line is only context around a match 
+ * returns:   none 
+ * effects:   appends "path:line: text" (or "path-line- text" for context) 
+ *            in the text format, a match or context object in JSON, or a 
+ *            match or context record in the binary format 
+*/
+void resultWriter::line(string &buffer, const string &path, size_t file,
+                        size_t number, uint64_t offset, const char *text,
+                        size_t length, bool context) const {
+    if (kind == TEXT) {
+        char mark = context ? '-' : ':';
+        buffer += path;
+        buffer += mark;
+        appendNumber(buffer, number);
+        buffer += mark;
+        buffer += ' ';
+        buffer.append(text, length);
+        buffer += '\n';
+    } else if (kind == JSON) {
+        buffer += context ? "{\"type\":\"context\",\"path\":" :
+                            "{\"type\":\"match\",\"path\":";
+        appendJson(buffer, path.data(), path.length());
+        buffer += ",\"file\":";
+        appendNumber(buffer, file);
+        buffer += ",\"line\":";
+        appendNumber(buffer, number);
+        buffer += ",\"offset\":";
+        appendNumber(buffer, offset);
+        buffer += ",\"text\":";
+        appendJson(buffer, text, length);
+        buffer += "}\n";
+    } else {
+        buffer += context ? CONTEXT_RECORD : MATCH_RECORD;
+        appendVarint(buffer, file);
+        appendVarint(buffer, number);
+        appendVarint(buffer, offset);
+        appendBytes(buffer, text, length);
+    }
+}
+
+/*
+ * name:      gap 
+ * purpose:   separates groups of lines that are not next to each other 
+ * arguments: a string to append to 
+ * returns:   none 
+ * effects:   appends a "--" line in the text format; nothing in the others, 
+ *            where the line numbers show the gaps 
+*/
+void resultWriter::gap(string &buffer) const {
+    if (kind == TEXT) {
+        buffer += "--\n";
+    }
+}
+
+/*
+ * name:      listFile 
+ * purpose:   writes a file listed by a query 
+ * arguments: a string to append to, the path of the file and its number 
+ * returns:   none 
+ * effects:   appends the path on its own line in the text format, a file 
+ *            object in JSON, or a path record in the binary format 
+*/
+void resultWriter::listFile(string &buffer, const string &path,
+                            size_t file) const {
+    if (kind == TEXT) {
+        buffer += path;
+        buffer += '\n';
+    } else if (kind == JSON) {
+        buffer += "{\"type\":\"file\",\"path\":";
+        appendJson(buffer, path.data(), path.length());
+        buffer += ",\"file\":";
+        appendNumber(buffer, file);
+        buffer += "}\n";
+    } else {
+        fileStart(buffer, path, file);
+    }
+}
+
+/*
+ * name:      count 
+ * purpose:   writes the number of lines and files with a word 
+ * arguments: a string to append to, the word, and its numbers of lines and 
+ *            files 
+ * returns:   none 
+ * effects:   appends "word: lines lines in files files" in the text format 
+ *            (singular for a count of one), a count object in JSON, or a 
+ *            count record in the binary format 
+*/
+void resultWriter::count(string &buffer, const string &word, size_t lines,
+                         size_t files) const {
+    if (kind == TEXT) {
+        buffer += word;
+        buffer += ": ";
+        appendCounted(buffer, lines, "line");
+        buffer += " in ";
+        appendCounted(buffer, files, "file");
+        buffer += "\n";
+    } else if (kind == JSON) {
+        buffer += "{\"type\":\"count\",\"word\":";
+        appendJson(buffer, word.data(), word.length());
+        buffer += ",\"lines\":";
+        appendNumber(buffer, lines);
+        buffer += ",\"files\":";
+        appendNumber(buffer, files);
+        buffer += "}\n";
+    } else {
+        buffer += COUNT_RECORD;
+        appendVarint(buffer, lines);
+        appendVarint(buffer, files);
+        appendBytes(buffer, word.data(), word.length());
+    }
+}
+
+/*
+ * name:      message 
+ * purpose:   writes any other output, such as a word not being found 
+ * arguments: a string to append to and the text of the message, ending 
+ *            with a newline 
+ * returns:   none 
+ * effects:   appends the text as it is in the text format, or a message 
+ *            object or record (without the newline) in the others 
+*/
+void resultWriter::message(string &buffer, const string &text) const {
+    size_t length = text.length();
+    if (kind == TEXT) {
+        buffer += text;
+        return;
+    }
+
+    //the newline only ends the text format's line 
+    if (length > 0 and text[length - 1] == '\n') {
+        length--;
+    }
+    if (kind == JSON) {
+        buffer += "{\"type\":\"message\",\"text\":";
+        appendJson(buffer, text.data(), length);
+        buffer += "}\n";
+    } else {
+        buffer += MESSAGE_RECORD;
+        appendBytes(buffer, text.data(), length);
+    }
+}
+
+/*
+ * name:      truncated 
+ * purpose:   writes that a query was stopped before it finished 
+ * arguments: a string to append to, the reason it was stopped, and the 
+ *            number of results it gave 
+ * returns:   none 
+ * effects:   appends "-- stopped after N results: reason --" in the text 
+ *            format, a truncated object in JSON, or a truncated record in 
+ *            the binary format 
+*/
+void resultWriter::truncated(string &buffer, const char *reason, 
+                             size_t results) const {
+    string why = reason;
+    if (kind == TEXT) {
+        buffer += "-- stopped after ";
+        appendNumber(buffer, results);
+        buffer += " results: ";
+        buffer += why;
+        buffer += " --\n";
+    } else if (kind == JSON) {
+        buffer += "{\"type\":\"truncated\",\"reason\":";
+        appendJson(buffer, why.data(), why.length());
+        buffer += ",\"results\":";
+        appendNumber(buffer, results);
+        buffer += "}\n";
+    } else {
+        buffer += TRUNCATED_RECORD;
+        appendVarint(buffer, results);
+        appendBytes(buffer, why.data(), why.length());
+    }
+}
+
+/*
+ * name:      term 
+ * purpose:   writes the statistics of a lowercase key or of one of its case
+ *            variants 
+ * arguments: a string to append to, the key or variant, its numbers of 
+ *            occurrences, lines and files, and whether it is a variant 
+ * returns:   none 
+ * effects:   appends "word: N occurrences on L lines in F files" in the text
+ *            format (each noun singular for a count of one, and indented 
+ *            for a variant, so it reads under its key), a key or variant 
+ *            object in JSON, or a key or variant record in the binary 
+ *            format 
+*/
+void resultWriter::term(string &buffer, const string &word, 
+                        size_t occurrences, size_t lines, size_t files, 
+                        bool variant) const {
+    if (kind == TEXT) {
+        buffer += variant ? "    " : "";
+        buffer += word;
+        buffer += ": ";
+        appendCounted(buffer, occurrences, "occurrence");
+        buffer += " on ";
+        appendCounted(buffer, lines, "line");
+        buffer += " in ";
+        appendCounted(buffer, files, "file");
+        buffer += "\n";
+    } else if (kind == JSON) {
+        buffer += variant ? "{\"type\":\"variant\",\"word\":" :
+                            "{\"type\":\"key\",\"word\":";
+        appendJson(buffer, word.data(), word.length());
+        buffer += ",\"occurrences\":";
+        appendNumber(buffer, occurrences);
+        buffer += ",\"lines\":";
+        appendNumber(buffer, lines);
+        buffer += ",\"files\":";
+        appendNumber(buffer, files);
+        buffer += "}\n";
+    } else {
+        buffer += variant ? VARIANT_RECORD : KEY_RECORD;
+        appendVarint(buffer, occurrences);
+        appendVarint(buffer, lines);
+        appendVarint(buffer, files);
+        appendBytes(buffer, word.data(), word.length());
+    }
+}
+
+/*
+ * name:      appendNumber 
+ * purpose:   writes a number in decimal 
+ * arguments: a string to append to and the number 
+ * returns:   none 
+ * effects:   appends the digits without making a temporary string 
+*/
+void resultWriter::appendNumber(string &buffer, uint64_t value) {
+    char digits[20];
+    size_t count = 0;
+    do {
+        digits[count++] = '0' + value % 10;
+        value /= 10;
+    } while (value > 0);
+
+    while (count > 0) {
+        buffer += digits[--count];
+    }
+}
+
+/*
+ * name:      appendCounted 
+ * purpose:   writes a number followed by what it counts 
+ * arguments: a string to append to, the number, and the singular noun 
+ * returns:   none 
+ * effects:   appends the number, a space and the noun, with an "s" unless 
+ *            the number is one 
+*/
+void resultWriter::appendCounted(string &buffer, uint64_t value, 
+                                 const char *noun) {
+    appendNumber(buffer, value);
+    buffer += ' ';
+    buffer += noun;
+    if (value != 1) {
+        buffer += 's';
+    }
+}
+
+/*
+ * name:      appendVarint 
+ * purpose:   writes a number as a variable length integer 
+ * arguments: a string to append to and the number 
+ * returns:   none 
+ * effects:   appends 7 bits of the number a byte, low bits first, with the 
+ *            high bit set on every byte but the last 
+*/
+void resultWriter::appendVarint(string &buffer, uint64_t value) {
+    while (value >= 0x80) {
+        buffer += (char) (value | 0x80);
+        value >>= 7;
+    }
+    buffer += (char) value;
+}
+
+/*
+ * name:      appendBytes 
+ * purpose:   writes a string in the binary format 
+ * arguments: a string to append to, a pointer to the bytes and their number 
+ * returns:   none 
+ * effects:   appends the length as a variable length integer, then the bytes 
+*/
+void resultWriter::appendBytes(string &buffer, const char *text,
+                               size_t length) {
+    appendVarint(buffer, length);
+    buffer.append(text, length);
+}
+
+/*
+ * name:      appendJson 
+ * purpose:   writes a string as a JSON string 
+ * arguments: a string to append to, a pointer to the bytes and their number 
+ * returns:   none 
+ * effects:   appends the bytes in quotes, escaping quotes, backslashes and 
+ *            control characters, and replacing each byte that is not part 
+ *            of a valid UTF-8 character with U+FFFD 
+*/
+void resultWriter::appendJson(string &buffer, const char *text,
+                              size_t length) {
+    static const char HEX[] = "0123456789abcdef";
+    const unsigned char *bytes = (const unsigned char *) text;
+    buffer += '"';
+
+    size_t i = 0;
+    while (i < length) {
+        //copy a run of plain characters at once 
+        size_t plain = i;
+        while (plain < length and bytes[plain] >= 0x20 and 
+               bytes[plain] < 0x80 and bytes[plain] != '"' and 
+               bytes[plain] != '\\') {
+            plain++;
+        }
+        buffer.append(text + i, plain - i);
+        i = plain;
+        if (i == length) {
+            break;
+        }
+
+        //characters with short escapes 
+        unsigned char byte = bytes[i];
+        if (byte < 0x80) {
+            buffer += '\\';
+            if (byte == '"' or byte == '\\') {
+                buffer += (char) byte;
+            } else if (byte == '\n') {
+                buffer += 'n';
+            } else if (byte == '\t') {
+                buffer += 't';
+            } else if (byte == '\r') {
+                buffer += 'r';
+            } else {
+                buffer += "u00";
+                buffer += HEX[byte >> 4];
+                buffer += HEX[byte & 0xf];
+            }
+            i++;
+            continue;
+        }
+
+        //find the length of a UTF-8 character and the range of its second 
+        //byte, which rules out overlong forms, surrogates and values past 
+        //U+10FFFF 
+        size_t size = 0;
+        unsigned char low = 0x80, high = 0xbf;
+        if (byte >= 0xc2 and byte <= 0xdf) {
+            size = 2;
+        } else if (byte >= 0xe0 and byte <= 0xef) {
+            size = 3;
+            low = (byte == 0xe0) ? 0xa0 : 0x80;
+            high = (byte == 0xed) ? 0x9f : 0xbf;
+        } else if (byte >= 0xf0 and byte <= 0xf4) {
+            size = 4;
+            low = (byte == 0xf0) ? 0x90 : 0x80;
+            high = (byte == 0xf4) ? 0x8f : 0xbf;
+        }
+
+        //check the bytes after the first 
+        bool valid = size > 0 and i + size <= length and
+                     bytes[i + 1] >= low and bytes[i + 1] <= high;
+        for (size_t j = 2; valid and j < size; j++) {
+            valid = bytes[i + j] >= 0x80 and bytes[i + j] <= 0xbf;
+        }
+
+        if (valid) {
+            buffer.append(text + i, size);
+            i += size;
+        } else {
+            buffer += "\\ufffd";
+            i++;
+        }
+    }
+    buffer += '"';
+}
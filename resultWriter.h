@@ -0,0 +1,95 @@
+/*
+ *  resultWriter.h
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  resultWriter is a class that formats what gerp writes to its output file 
+ *  in one of three formats: the text that gerp has always written 
+ *  ("path:line: text"), JSON Lines (one JSON object per line), or a compact 
+ *  binary format of records. Each record is appended to a buffer the caller 
+ *  keeps and reuses, so writing a record allocates nothing once the buffer 
+ *  has grown, and the rendering threads can each fill their own buffer with 
+ *  the same writer. 
+ *
+ *  Every JSON object has a "type": "match" or "context" for a line (with 
+ *  its "path", "file" number, "line" number, byte "offset" of the line in 
+ *  the file and "text"), "file" for a file listed by @files, "count" for 
+ *  the answer to @count, "truncated" (with the "reason" and number of 
+ *  "results") when a query is stopped before it finishes, "key" and 
+ *  "variant" for the statistics of a lowercase key and of each of its case 
+ *  variants (the "word" and its "occurrences", "lines" and "files"), and 
+ *  "message" for anything else. Text that is not valid UTF-8 has each bad 
+ *  byte replaced by U+FFFD. 
+ *
+ *  A binary record is one byte with its type followed by its fields as 
+ *  variable length integers (7 bits a byte, low bits first, the high bit 
+ *  set on every byte but the last) and strings (their length, then their 
+ *  bytes): 
+ *      'P' path:      file, path 
+ *      'L' match:     file, line, offset, text 
+ *      'C' context:   file, line, offset, text 
+ *      'N' count:     lines, files, word 
+ *      'M' message:   text 
+ *      'T' truncated: results, reason 
+ *      'K' key:       occurrences, lines, files, word 
+ *      'V' variant:   occurrences, lines, files, word 
+ *  The lines of a file are preceded by a path record for it, so the lines 
+ *  only carry the file's number. 
+ *
+*/
+
+#ifndef RESULTWRITER_H
+#define RESULTWRITER_H
+
+#include <cstdint>
+#include <string>
+
+using namespace std;
+
+class resultWriter {
+//public functions available to the client 
+public:
+    enum Format { TEXT, JSON, BINARY };
+
+    //record types of the binary format 
+    static const char PATH_RECORD = 'P';
+    static const char MATCH_RECORD = 'L';
+    static const char CONTEXT_RECORD = 'C';
+    static const char COUNT_RECORD = 'N';
+    static const char MESSAGE_RECORD = 'M';
+    static const char TRUNCATED_RECORD = 'T';
+    static const char KEY_RECORD = 'K';
+    static const char VARIANT_RECORD = 'V';
+
+    resultWriter(Format type = TEXT);
+
+    static bool parseFormat(const string &name, Format &type);
+    Format format() const;
+
+    //functions for appending records to a buffer 
+    void fileStart(string &buffer, const string &path, size_t file) const;
+    void line(string &buffer, const string &path, size_t file, size_t number,
+              uint64_t offset, const char *text, size_t length,
+              bool context) const;
+    void gap(string &buffer) const;
+    void listFile(string &buffer, const string &path, size_t file) const;
+    void count(string &buffer, const string &word, size_t lines,
+               size_t files) const;
+    void message(string &buffer, const string &text) const;
+    void truncated(string &buffer, const char *reason, size_t results) const;
+    void term(string &buffer, const string &word, size_t occurrences, 
+              size_t lines, size_t files, bool variant) const;
+
+private:
+    Format kind;
+
+    //helper functions for writing fields 
+    static void appendNumber(string &buffer, uint64_t value);
+    static void appendCounted(string &buffer, uint64_t value, 
+                              const char *noun);
+    static void appendVarint(string &buffer, uint64_t value);
+    static void appendBytes(string &buffer, const char *text, size_t length);
+    static void appendJson(string &buffer, const char *text, size_t length);
+};
+
+#endif
@@ -0,0 +1,256 @@
+/*
+ *  roaringBitmap.cpp
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  Contains an implementation of the roaringBitmap class.   
+ *
+*/
+
+#include "roaringBitmap.h"
+#include <algorithm>
+#include <iterator>
+
+const size_t roaringBitmap::ARRAY_LIMIT;
+const size_t roaringBitmap::BITMAP_WORDS;
+
+/*
+ * name:      roaringBitmap constructor 
+ * purpose:   creates an empty bitmap 
+ * arguments: none
+ * returns:   none 
+ * effects:   none 
+*/
+roaringBitmap::roaringBitmap() {
+
+}
+
+/*
+ * name:      add 
+ * purpose:   adds a number to the bitmap 
+ * arguments: a uint32_t with the number 
+ * returns:   none 
+ * effects:   adds the low 16 bits to the container of the high 16 bits, 
+ *            making the container if needed. Adding numbers in ascending 
+ *            order only ever touches the last container and the end of its
+ *            array. Adding a number that is already there does nothing. 
+*/
+void roaringBitmap::add(uint32_t value) {
+    addToContainer(containerFor(value >> 16), value & 0xffff);
+}
+
+/*
+ * name:      unionWith 
+ * purpose:   adds every number of another bitmap to this one 
+ * arguments: a reference to the other bitmap 
+ * returns:   none 
+ * effects:   merges the two lists of containers by their high bits, unioning
+ *            the containers that both have 
+*/
+void roaringBitmap::unionWith(const roaringBitmap &other) {
+    vector<Container> merged;
+    merged.reserve(containers.size() + other.containers.size());
+
+    size_t i = 0, j = 0;
+    while (i < containers.size() or j < other.containers.size()) {
+        //take the container with the lower high bits, or union the two 
+        if (j == other.containers.size() or (i < containers.size() and 
+            containers[i].key < other.containers[j].key)) {
+            merged.push_back(move(containers[i++]));
+        } else if (i == containers.size() or 
+                   other.containers[j].key < containers[i].key) {
+            merged.push_back(other.containers[j++]);
+        } else {
+            merged.push_back(move(containers[i++]));
+            unionContainers(merged.back(), other.containers[j++]);
+        }
+    }
+
+    containers.swap(merged);
+}
+
+/*
+ * name:      cardinality 
+ * purpose:   gets how many numbers are in the bitmap 
+ * arguments: none
+ * returns:   a size_t with the number of numbers 
+ * effects:   adds up the count kept by each container 
+*/
+size_t roaringBitmap::cardinality() const {
+    size_t total = 0;
+    for (size_t i = 0; i < containers.size(); i++) {
+        total += containers[i].count;
+    }
+    return total;
+}
+
+/*
+ * name:      contains 
+ * purpose:   checks whether a number is in the bitmap 
+ * arguments: a uint32_t with the number 
+ * returns:   returns true if the number is in the bitmap, false otherwise 
+ * effects:   binary searches the containers and then the array, or tests the
+ *            bit 
+*/
+bool roaringBitmap::contains(uint32_t value) const {
+    uint16_t high = value >> 16, low = value & 0xffff;
+    vector<Container>::const_iterator container = 
+        lower_bound(containers.begin(), containers.end(), high, 
+                    [](const Container &c, uint16_t key) {
+                        return c.key < key;
+                    });
+    if (container == containers.end() or container->key != high) {
+        return false;
+    }
+
+    if (container->bits.empty()) {
+        return binary_search(container->array.begin(), 
+                             container->array.end(), low);
+    }
+    return (container->bits[low / 64] >> (low % 64)) & 1;
+}
+
+/*
+ * name:      bytes 
+ * purpose:   gets the memory used by the bitmap 
+ * arguments: none
+ * returns:   a size_t with the number of bytes 
+ * effects:   counts the containers and their arrays and bitmaps, including 
+ *            unused vector capacity 
+*/
+size_t roaringBitmap::bytes() const {
+    size_t total = containers.capacity() * sizeof(Container);
+    for (size_t i = 0; i < containers.size(); i++) {
+        total += containers[i].array.capacity() * sizeof(uint16_t) + 
+                 containers[i].bits.capacity() * sizeof(uint64_t);
+    }
+    return total;
+}
+
+/*
+ * name:      containerFor 
+ * purpose:   finds the container of some high bits 
+ * arguments: a uint16_t with the high 16 bits of a number 
+ * returns:   a reference to the container 
+ * effects:   checks the last container first, then binary searches. Makes 
+ *            an empty container in order if there is none. 
+*/
+roaringBitmap::Container &roaringBitmap::containerFor(uint16_t high) {
+    if (not containers.empty() and containers.back().key == high) {
+        return containers.back();
+    }
+    if (containers.empty() or containers.back().key < high) {
+        containers.push_back(Container(high));
+        return containers.back();
+    }
+
+    vector<Container>::iterator container = 
+        lower_bound(containers.begin(), containers.end(), high, 
+                    [](const Container &c, uint16_t key) {
+                        return c.key < key;
+                    });
+    if (container->key != high) {
+        container = containers.insert(container, Container(high));
+    }
+    return *container;
+}
+
+/*
+ * name:      addToContainer 
+ * purpose:   adds low bits to a container 
+ * arguments: a reference to the container and a uint16_t with the low bits
+ * returns:   none 
+ * effects:   sets the bit, or inserts the low bits in order into the array 
+ *            (appending when they are the largest yet), and turns the array
+ *            into a bitmap once it holds more than ARRAY_LIMIT numbers 
+*/
+void roaringBitmap::addToContainer(Container &container, uint16_t low) {
+    //a bitmap only needs its bit set 
+    if (not container.bits.empty()) {
+        uint64_t bit = (uint64_t) 1 << (low % 64);
+        if ((container.bits[low / 64] & bit) == 0) {
+            container.bits[low / 64] |= bit;
+            container.count++;
+        }
+        return;
+    }
+
+    //an array keeps its numbers sorted and distinct 
+    vector<uint16_t> &array = container.array;
+    if (array.empty() or array.back() < low) {
+        array.push_back(low);
+    } else {
+        vector<uint16_t>::iterator place = lower_bound(array.begin(), 
+                                                       array.end(), low);
+        if (*place == low) {
+            return;
+        }
+        array.insert(place, low);
+    }
+    container.count++;
+
+    if (container.count > ARRAY_LIMIT) {
+        toBitmap(container);
+    }
+}
+
+/*
+ * name:      toBitmap 
+ * purpose:   turns an array container into a bitmap container 
+ * arguments: a reference to the container 
+ * returns:   none 
+ * effects:   sets the bit of each number in the array and frees the array 
+*/
+void roaringBitmap::toBitmap(Container &container) {
+    container.bits.assign(BITMAP_WORDS, 0);
+    for (size_t i = 0; i < container.array.size(); i++) {
+        uint16_t low = container.array[i];
+        container.bits[low / 64] |= (uint64_t) 1 << (low % 64);
+    }
+    vector<uint16_t>().swap(container.array);
+}
+
+/*
+ * name:      unionContainers 
+ * purpose:   adds the numbers of one container to another with the same 
+ *            high bits 
+ * arguments: a reference to the container to add to and a reference to the
+ *            container to add 
+ * returns:   none 
+ * effects:   merges two arrays if the result fits in an array, otherwise 
+ *            makes the result a bitmap and ORs in the other's bits (or sets
+ *            the other's numbers), then recounts it 
+*/
+void roaringBitmap::unionContainers(Container &into, const Container &from) {
+    //two small arrays stay an array 
+    if (into.bits.empty() and from.bits.empty() and 
+        into.count + from.count <= ARRAY_LIMIT) {
+        vector<uint16_t> merged;
+        merged.reserve(into.count + from.count);
+        set_union(into.array.begin(), into.array.end(), from.array.begin(), 
+                  from.array.end(), back_inserter(merged));
+        into.array.swap(merged);
+        into.count = into.array.size();
+        return;
+    }
+
+    //otherwise the result is a bitmap 
+    if (into.bits.empty()) {
+        toBitmap(into);
+    }
+    if (from.bits.empty()) {
+        for (size_t i = 0; i < from.array.size(); i++) {
+            uint16_t low = from.array[i];
+            into.bits[low / 64] |= (uint64_t) 1 << (low % 64);
+        }
+    } else {
+        for (size_t i = 0; i < BITMAP_WORDS; i++) {
+            into.bits[i] |= from.bits[i];
+        }
+    }
+
+    into.count = 0;
+    for (size_t i = 0; i < BITMAP_WORDS; i++) {
+        into.count += __builtin_popcountll(into.bits[i]);
+    }
+}
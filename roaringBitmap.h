@@ -0,0 +1,109 @@
+/*
+ *  roaringBitmap.h
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  roaringBitmap is a class that stores a set of 32 bit numbers (here, the 
+ *  line ids of the lines a common word is on) as a Roaring bitmap. The 
+ *  numbers are split by their high 16 bits into containers of up to 65536 
+ *  numbers each. A container with at most ARRAY_LIMIT numbers stores their 
+ *  low 16 bits in a sorted array; a fuller one stores a plain bitmap of 
+ *  65536 bits (8KB). Each container therefore takes at most 2 bytes per 
+ *  number and at most 8KB, whichever is smaller, and two bitmaps are 
+ *  unioned a container at a time, with whole words of bits ORed together 
+ *  where both are full. Numbers are visited in ascending order. 
+ *
+*/
+
+#ifndef ROARINGBITMAP_H
+#define ROARINGBITMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+class roaringBitmap {
+//public functions available to the client 
+public:
+    roaringBitmap();
+
+    //functions for adding numbers 
+    void add(uint32_t value);
+    void unionWith(const roaringBitmap &other);
+
+    //functions for reading the numbers 
+    size_t cardinality() const;
+    bool contains(uint32_t value) const;
+    template<typename Visit>
+    void forEach(Visit visit) const;
+
+    //function for the memory used 
+    size_t bytes() const;
+
+    //most numbers a container holds in an array before it becomes a bitmap
+    static const size_t ARRAY_LIMIT = 4096;
+
+private:
+    //number of 64 bit words in a full container's bitmap 
+    static const size_t BITMAP_WORDS = 1024;
+
+    // 
+    //  Container struct, used to store the numbers that share their high 16 
+    //  bits, either as a sorted array of low bits or as a bitmap 
+    // 
+    struct Container {
+        uint16_t key;
+        size_t count;
+        vector<uint16_t> array;
+        vector<uint64_t> bits;
+
+        Container() : key(0), count(0) {}
+        explicit Container(uint16_t high) : key(high), count(0) {}
+    };
+
+    //containers, in order of their high bits 
+    vector<Container> containers;
+
+    //helper functions for containers 
+    Container &containerFor(uint16_t high);
+    static void addToContainer(Container &container, uint16_t low);
+    static void toBitmap(Container &container);
+    static void unionContainers(Container &into, const Container &from);
+};
+
+/*
+ * name:      forEach 
+ * purpose:   visits every number in the bitmap 
+ * arguments: a function to call with each number 
+ * returns:   none 
+ * effects:   calls the function with each number in ascending order, 
+ *            finding the set bits of bitmap containers a word at a time 
+*/
+template<typename Visit>
+void roaringBitmap::forEach(Visit visit) const {
+    for (size_t i = 0; i < containers.size(); i++) {
+        const Container &container = containers[i];
+        uint32_t high = (uint32_t) container.key << 16;
+
+        //an array lists its numbers 
+        if (container.bits.empty()) {
+            for (size_t j = 0; j < container.array.size(); j++) {
+                visit(high | container.array[j]);
+            }
+            continue;
+        }
+
+        //a bitmap is read a set bit at a time 
+        for (size_t word = 0; word < BITMAP_WORDS; word++) {
+            uint64_t bits = container.bits[word];
+            while (bits != 0) {
+                visit(high | (uint32_t) (word * 64 + __builtin_ctzll(bits)));
+                bits &= bits - 1;
+            }
+        }
+    }
+}
+
+#endif
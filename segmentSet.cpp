@@ -0,0 +1,254 @@
+/*
+ *  segmentSet.cpp
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  Contains an implementation of the segmentSet class.   
+ *
+*/
+
+#include "segmentSet.h"
+
+const size_t segmentSet::TIER_FACTOR;
+const size_t segmentSet::BASE_SIZE;
+
+/*
+ * name:      segmentSet constructor 
+ * purpose:   creates an empty set of segments 
+ * arguments: none
+ * returns:   none 
+ * effects:   the compaction thread is only started when the first segment 
+ *            is added 
+*/
+segmentSet::segmentSet() {
+    hasHead = false;
+    merging = false;
+    stopping = false;
+    compactions = 0;
+}
+
+/*
+ * name:      segmentSet destructor 
+ * purpose:   stops the compaction thread 
+ * arguments: none
+ * returns:   none 
+ * effects:   tells the thread to stop and waits for it; a merge in progress 
+ *            finishes first 
+*/
+segmentSet::~segmentSet() {
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (compactor.joinable()) {
+        compactor.join();
+    }
+}
+
+/*
+ * name:      add 
+ * purpose:   adds a new segment after the others 
+ * arguments: a shared pointer to a segment of files numbered after every 
+ *            other segment's 
+ * returns:   none 
+ * effects:   merges the segment into the head if both fit in BASE_SIZE 
+ *            locations together (building the new head without the lock, 
+ *            which is safe since only add changes the head and segments are
+ *            added one at a time). Otherwise appends the segment, making it
+ *            the head if it is small, starts the compaction thread if it is
+ *            not running, and wakes it to check for segments to merge. 
+*/
+void segmentSet::add(shared_ptr<const indexSegment> segment) {
+    //get the head, if there is one 
+    shared_ptr<const indexSegment> head;
+    {
+        lock_guard<mutex> guard(lock);
+        if (hasHead) {
+            head = segments.back();
+        }
+    }
+
+    //merge a small segment into the head and swap the new head in 
+    if (head != nullptr and 
+        head->numLocations() + segment->numLocations() <= BASE_SIZE) {
+        vector<shared_ptr<const indexSegment>> parts;
+        parts.push_back(head);
+        parts.push_back(segment);
+        shared_ptr<const indexSegment> merged = 
+            make_shared<const indexSegment>(parts);
+        lock_guard<mutex> guard(lock);
+        segments.back() = merged;
+        return;
+    }
+
+    //or leave the head as it is and add the segment after it 
+    {
+        lock_guard<mutex> guard(lock);
+        segments.push_back(segment);
+        hasHead = segment->numLocations() < BASE_SIZE;
+        if (not compactor.joinable()) {
+            compactor = thread(&segmentSet::compactLoop, this);
+        }
+    }
+    wake.notify_all();
+}
+
+/*
+ * name:      snapshot 
+ * purpose:   gets the current segments for a query 
+ * arguments: none
+ * returns:   a vector of shared pointers to the segments, in file order 
+ * effects:   only holds the lock long enough to copy the pointers. The 
+ *            segments stay valid as long as the snapshot is kept, even if 
+ *            they are merged away in the meantime. 
+*/
+vector<shared_ptr<const indexSegment>> segmentSet::snapshot() const {
+    lock_guard<mutex> guard(lock);
+    return segments;
+}
+
+/*
+ * name:      numSegments 
+ * purpose:   gets the number of segments 
+ * arguments: none
+ * returns:   a size_t with the number of segments 
+ * effects:   none 
+*/
+size_t segmentSet::numSegments() const {
+    lock_guard<mutex> guard(lock);
+    return segments.size();
+}
+
+/*
+ * name:      numCompactions 
+ * purpose:   gets the number of merges done so far 
+ * arguments: none
+ * returns:   a size_t with the number of merges 
+ * effects:   none 
+*/
+size_t segmentSet::numCompactions() const {
+    lock_guard<mutex> guard(lock);
+    return compactions;
+}
+
+/*
+ * name:      waitForCompaction 
+ * purpose:   waits until there is nothing left to merge 
+ * arguments: none
+ * returns:   none 
+ * effects:   blocks until the compaction thread is idle and no segments 
+ *            need merging 
+*/
+void segmentSet::waitForCompaction() {
+    unique_lock<mutex> guard(lock);
+    size_t firstSegment = 0, count = 0;
+    idle.wait(guard, [&]() {
+        return not merging and not pickMerge(firstSegment, count);
+    });
+}
+
+/*
+ * name:      tier 
+ * purpose:   gets the tier of a segment from its size 
+ * arguments: a size_t with the segment's number of locations 
+ * returns:   a size_t with the tier, 0 for segments up to BASE_SIZE 
+ * effects:   each tier holds segments TIER_FACTOR times bigger than the last
+*/
+size_t segmentSet::tier(size_t locations) {
+    size_t level = 0;
+    size_t limit = BASE_SIZE;
+    while (locations > limit) {
+        level++;
+        limit *= TIER_FACTOR;
+    }
+    return level;
+}
+
+/*
+ * name:      numSealed 
+ * purpose:   gets the number of segments that may be merged 
+ * arguments: none
+ * returns:   a size_t with the number of segments before the head 
+ * effects:   must be called with the lock held 
+*/
+size_t segmentSet::numSealed() const {
+    return hasHead ? segments.size() - 1 : segments.size();
+}
+
+/*
+ * name:      pickMerge 
+ * purpose:   finds segments to merge 
+ * arguments: references to size_ts to store the first segment and number 
+ *            of segments to merge in 
+ * returns:   returns true if there are segments to merge, false otherwise 
+ * effects:   looks, from the newest segment before the head back, for 
+ *            TIER_FACTOR neighboring segments in the same tier. Must be 
+ *            called with the lock held. 
+*/
+bool segmentSet::pickMerge(size_t &firstSegment, size_t &count) const {
+    size_t runEnd = numSealed();
+    while (runEnd >= TIER_FACTOR) {
+        //find how far back the newest segment's tier goes 
+        size_t level = tier(segments[runEnd - 1]->numLocations());
+        size_t runStart = runEnd - 1;
+        while (runStart > 0 and 
+               tier(segments[runStart - 1]->numLocations()) == level) {
+            runStart--;
+        }
+
+        //merge the oldest TIER_FACTOR of them 
+        if (runEnd - runStart >= TIER_FACTOR) {
+            firstSegment = runStart;
+            count = TIER_FACTOR;
+            return true;
+        }
+        runEnd = runStart;
+    }
+    return false;
+}
+
+/*
+ * name:      compactLoop 
+ * purpose:   merges segments in the background until told to stop 
+ * arguments: none
+ * returns:   none 
+ * effects:   waits for segments to merge, copies the pointers of the chosen
+ *            ones, builds the merged segment without the lock (queries and 
+ *            new segments carry on meanwhile), then replaces the chosen 
+ *            segments with it. New segments only ever go after the others, 
+ *            and the head is never chosen, so the chosen ones are still in 
+ *            the same place. 
+*/
+void segmentSet::compactLoop() {
+    unique_lock<mutex> guard(lock);
+    while (true) {
+        size_t firstSegment = 0, count = 0;
+        wake.wait(guard, [&]() {
+            return stopping or pickMerge(firstSegment, count);
+        });
+        if (stopping) {
+            break;
+        }
+
+        //merge a copy of the chosen segments without the lock 
+        vector<shared_ptr<const indexSegment>> parts(
+            segments.begin() + firstSegment, 
+            segments.begin() + firstSegment + count);
+        merging = true;
+        guard.unlock();
+        shared_ptr<const indexSegment> merged = 
+            make_shared<const indexSegment>(parts);
+        guard.lock();
+
+        //swap the merged segment in for the parts 
+        segments.erase(segments.begin() + firstSegment, 
+                       segments.begin() + firstSegment + count);
+        segments.insert(segments.begin() + firstSegment, merged);
+        compactions++;
+        merging = false;
+        idle.notify_all();
+    }
+    merging = false;
+    idle.notify_all();
+}
@@ -0,0 +1,85 @@
+/*
+ *  segmentSet.h
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  segmentSet is a class that holds the indexSegments of files added after 
+ *  the directory was indexed, ordered by their file numbers, and merges 
+ *  small segments into bigger ones on a background thread (compaction). 
+ *  Segments are sorted into tiers by size, each tier TIER_FACTOR times 
+ *  bigger than the one below; once TIER_FACTOR neighboring segments are in 
+ *  the same tier they are merged into one segment of the next tier, so 
+ *  every location is copied about once per tier and the number of segments
+ *  stays logarithmic in the number of locations. Queries take a snapshot of
+ *  the segments (shared pointers, so a segment lives as long as any query 
+ *  uses it) and never wait for a merge: the merge is built without the lock
+ *  and only swapped in under it. 
+ *  The newest segment is the head while it has fewer than BASE_SIZE 
+ *  locations: each small segment added after it is merged into it (a new 
+ *  head replaces the old one, which queries may still be reading) instead 
+ *  of being kept on its own, so many small additions leave one small 
+ *  segment rather than many. The head is never compacted; once the next 
+ *  addition would make it bigger than BASE_SIZE it is left as it is, and 
+ *  the segment added becomes the head. 
+ *
+*/
+
+#ifndef SEGMENTSET_H
+#define SEGMENTSET_H
+
+#include "indexSegment.h"
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+class segmentSet {
+//public functions available to the client 
+public:
+    segmentSet();
+    ~segmentSet();
+
+    //functions for adding segments and reading them 
+    void add(shared_ptr<const indexSegment> segment);
+    vector<shared_ptr<const indexSegment>> snapshot() const;
+
+    //functions for the state of the segments and their compaction 
+    size_t numSegments() const;
+    size_t numCompactions() const;
+    void waitForCompaction();
+
+    //number of same tier segments merged at once, and the most locations 
+    //in a segment of the lowest tier 
+    static const size_t TIER_FACTOR = 4;
+    static const size_t BASE_SIZE = 4096;
+
+private:
+    //segments ordered by their file numbers, and whether the last one is 
+    //the head, which takes in small segments added after it 
+    vector<shared_ptr<const indexSegment>> segments;
+    bool hasHead;
+
+    //lock for the segments and the variables below, and conditions for 
+    //waking the compaction thread and for waiting until it is idle 
+    mutable mutex lock;
+    condition_variable wake;
+    condition_variable idle;
+
+    //compaction thread, whether it is merging, whether it should stop, and
+    //how many merges it has done 
+    thread compactor;
+    bool merging;
+    bool stopping;
+    size_t compactions;
+
+    //helper functions for compacting 
+    void compactLoop();
+    bool pickMerge(size_t &firstSegment, size_t &count) const;
+    size_t numSealed() const;
+    static size_t tier(size_t locations);
+};
+
+#endif
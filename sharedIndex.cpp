@@ -0,0 +1,267 @@
+/*
+ *  sharedIndex.cpp
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  Contains an implementation of the sharedIndex class. 
+ *
+*/
+
+#include "sharedIndex.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+//definitions of the constants declared in the class 
+const char sharedIndex::MAGIC[8] = {'G', 'E', 'R', 'P', 'S', 'H', 'R', '1'};
+const size_t sharedIndex::ALIGNMENT;
+
+/*
+ * name:      sharedIndex constructor 
+ * purpose:   creates a sharedIndex with no file mapped 
+ * arguments: none 
+ * returns:   none 
+ * effects:   none 
+*/
+sharedIndex::sharedIndex() {
+    base = nullptr;
+    length = 0;
+    header = nullptr;
+}
+
+/*
+ * name:      sharedIndex destructor 
+ * purpose:   unmaps the file 
+ * arguments: none 
+ * returns:   none 
+ * effects:   calls close 
+*/
+sharedIndex::~sharedIndex() {
+    close();
+}
+
+/*
+ * name:      save 
+ * purpose:   writes a whole index to a file 
+ * arguments: a string with the path to write, a string with the path of 
+ *            the index file of the words (written by spimiBuilder), the 
+ *            path table, a vector with the (first file, copy) pairs of files 
+ *            with the same contents, and the Bloom filter of the words 
+ * returns:   none 
+ * effects:   writes the header, then each part aligned to ALIGNMENT bytes, 
+ *            to a temporary file next to path and renames it to path. 
+ *            Throws a runtime_error if the file cannot be written. 
+*/
+void sharedIndex::save(const string &path, const string &wordsFile,
+                       const pathTable &table, const vector<uint64_t> &pairs,
+                       const bloomFilter &wordFilter) {
+    string temporary = path + ".tmp." + to_string(getpid());
+    ofstream out(temporary, ios::binary | ios::trunc);
+    ifstream words(wordsFile, ios::binary);
+    if (not out.is_open() or not words.is_open()) {
+        throw runtime_error("Unable to write index " + path);
+    }
+
+    //room for the header, which is written last 
+    Header written;
+    memset(&written, 0, sizeof(written));
+    out.write((const char *) &written, sizeof(written));
+
+    //each part, recording where it starts and how long it is 
+    written.wordsOffset = align(out);
+    out << words.rdbuf();
+    written.wordsBytes = (uint64_t) out.tellp() - written.wordsOffset;
+
+    written.pathsOffset = align(out);
+    table.writeImage(out);
+    written.pathsBytes = (uint64_t) out.tellp() - written.pathsOffset;
+
+    written.aliasesOffset = align(out);
+    written.numAliases = pairs.size() / 2;
+    out.write((const char *) pairs.data(), pairs.size() * sizeof(uint64_t));
+
+    written.filterOffset = align(out);
+    wordFilter.writeImage(out);
+    written.filterBytes = (uint64_t) out.tellp() - written.filterOffset;
+
+    //the header goes in once everything else is there 
+    memcpy(written.magic, MAGIC, sizeof(MAGIC));
+    out.seekp(0);
+    out.write((const char *) &written, sizeof(written));
+    out.close();
+
+    if (out.fail() or rename(temporary.c_str(), path.c_str()) != 0) {
+        unlink(temporary.c_str());
+        throw runtime_error("Unable to write index " + path);
+    }
+}
+
+/*
+ * name:      align 
+ * purpose:   pads a file being written to the next multiple of ALIGNMENT 
+ * arguments: a reference to the ostream being written 
+ * returns:   a uint64_t with the offset the next part starts at 
+ * effects:   writes zero bytes up to that offset 
+*/
+uint64_t sharedIndex::align(ostream &out) {
+    uint64_t offset = out.tellp();
+    while (offset % ALIGNMENT != 0) {
+        out.put('\0');
+        offset++;
+    }
+    return offset;
+}
+
+/*
+ * name:      open 
+ * purpose:   maps a file written by save 
+ * arguments: a string with the path of the file 
+ * returns:   none 
+ * effects:   maps the whole file read only and shared, and checks that 
+ *            every part lies inside it. Nothing is read until a part is 
+ *            used. Throws a runtime_error if the file cannot be mapped or 
+ *            was not written by save. 
+*/
+void sharedIndex::open(const string &path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw runtime_error("Unable to open index " + path);
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 or (size_t) info.st_size < sizeof(Header)) {
+        ::close(fd);
+        throw runtime_error("Not a shared index " + path);
+    }
+
+    //map the file, the mapping stays valid after the descriptor is closed 
+    void *mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        throw runtime_error("Unable to map index " + path);
+    }
+    base = (const char *) mapped;
+    length = info.st_size;
+    header = (const Header *) base;
+
+    //every part must be aligned and inside the file (compared so that no 
+    //sum of a damaged offset and length can wrap around) 
+    bool valid = memcmp(header->magic, MAGIC, sizeof(MAGIC)) == 0 and
+                 fits(header->wordsOffset, header->wordsBytes) and
+                 fits(header->pathsOffset, header->pathsBytes) and
+                 header->numAliases <= length / (2 * sizeof(uint64_t)) and
+                 fits(header->aliasesOffset, 
+                      header->numAliases * 2 * sizeof(uint64_t)) and
+                 fits(header->filterOffset, header->filterBytes);
+    if (not valid) {
+        close();
+        throw runtime_error("Not a shared index " + path);
+    }
+}
+
+/*
+ * name:      fits 
+ * purpose:   checks that a part of the mapped file lies inside it 
+ * arguments: the offset of the part and its length in bytes 
+ * returns:   returns true if the part starts on an ALIGNMENT boundary and 
+ *            ends inside the file, false otherwise 
+ * effects:   none 
+*/
+bool sharedIndex::fits(uint64_t offset, uint64_t bytes) const {
+    return offset % ALIGNMENT == 0 and offset <= length and 
+           bytes <= length - offset;
+}
+
+/*
+ * name:      close 
+ * purpose:   unmaps the file, if one is mapped 
+ * arguments: none 
+ * returns:   none 
+ * effects:   any parts handed out become invalid 
+*/
+void sharedIndex::close() {
+    if (base != nullptr) {
+        munmap((void *) base, length);
+    }
+    base = nullptr;
+    length = 0;
+    header = nullptr;
+}
+
+/*
+ * name:      isOpen 
+ * purpose:   checks whether a file is mapped 
+ * arguments: none 
+ * returns:   returns true if a file is mapped, false otherwise 
+ * effects:   none 
+*/
+bool sharedIndex::isOpen() const {
+    return base != nullptr;
+}
+
+/*
+ * name:      words 
+ * purpose:   gets the index of the words in the mapped file 
+ * arguments: none 
+ * returns:   a Section with the bytes of the index, for diskIndex::attach 
+ * effects:   none 
+*/
+sharedIndex::Section sharedIndex::words() const {
+    Section section = {base + header->wordsOffset, header->wordsBytes};
+    return section;
+}
+
+/*
+ * name:      paths 
+ * purpose:   gets the path table in the mapped file 
+ * arguments: none 
+ * returns:   a Section with the image of the table, for pathTable::attach 
+ * effects:   none 
+*/
+sharedIndex::Section sharedIndex::paths() const {
+    Section section = {base + header->pathsOffset, header->pathsBytes};
+    return section;
+}
+
+/*
+ * name:      filter 
+ * purpose:   gets the Bloom filter in the mapped file 
+ * arguments: none 
+ * returns:   a Section with the filter's blocks, for bloomFilter::attach 
+ * effects:   none 
+*/
+sharedIndex::Section sharedIndex::filter() const {
+    Section section = {base + header->filterOffset, header->filterBytes};
+    return section;
+}
+
+/*
+ * name:      aliases 
+ * purpose:   gets the files with the same contents as earlier files 
+ * arguments: a reference to a size_t to store the number of pairs in 
+ * returns:   a pointer to the pairs, each the number of the first file with 
+ *            some contents followed by the number of a later copy 
+ * effects:   none 
+*/
+const uint64_t *sharedIndex::aliases(size_t &numPairs) const {
+    numPairs = header->numAliases;
+    return (const uint64_t *) (base + header->aliasesOffset);
+}
+
+/*
+ * name:      bytes 
+ * purpose:   gets the size of the mapped file 
+ * arguments: none 
+ * returns:   a size_t with the number of bytes mapped 
+ * effects:   none 
+*/
+size_t sharedIndex::bytes() const {
+    return length;
+}
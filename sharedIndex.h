@@ -0,0 +1,95 @@
+/*
+ *  sharedIndex.h
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  sharedIndex is a class that saves a whole index to one file that any 
+ *  number of gerp processes can then map read only, instead of each one 
+ *  walking the directory and building a private copy. The file holds the 
+ *  words and their locations (an index file written by spimiBuilder), the 
+ *  path table, the pairs of files with the same contents, and the blocks of 
+ *  the Bloom filter, one after another and each aligned to ALIGNMENT bytes. 
+ *  Like the parts inside it, the file holds offsets from its start and no 
+ *  pointers, so it can be mapped at any address; the parts are read 
+ *  straight from the mapping, and the pages of a mapped file are shared 
+ *  through the page cache by every process that maps it. The file is 
+ *  written under a temporary name and renamed into place, so a process 
+ *  never maps half of one, and a process that mapped an older file keeps 
+ *  it until it exits. 
+ *
+*/
+
+#ifndef SHAREDINDEX_H
+#define SHAREDINDEX_H
+
+#include "pathTable.h"
+#include "bloomFilter.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class sharedIndex {
+//public functions available to the client 
+public:
+    // 
+    //  Header struct, used to find each part of the file: its offset from 
+    //  the start of the file and its length in bytes (or number of pairs) 
+    // 
+    struct Header {
+        char magic[8];
+        uint64_t wordsOffset;
+        uint64_t wordsBytes;
+        uint64_t pathsOffset;
+        uint64_t pathsBytes;
+        uint64_t aliasesOffset;
+        uint64_t numAliases;
+        uint64_t filterOffset;
+        uint64_t filterBytes;
+    };
+
+    // 
+    //  Section struct, used to hand back a part of the mapped file 
+    // 
+    struct Section {
+        const char *data;
+        size_t length;
+    };
+
+    static const char MAGIC[8];
+    static const size_t ALIGNMENT = 64;
+
+    sharedIndex();
+    ~sharedIndex();
+
+    //function for writing a file 
+    static void save(const string &path, const string &wordsFile,
+                     const pathTable &table, const vector<uint64_t> &pairs,
+                     const bloomFilter &wordFilter);
+
+    //functions for mapping a file 
+    void open(const string &path);
+    void close();
+    bool isOpen() const;
+
+    //functions for the parts of the mapped file 
+    Section words() const;
+    Section paths() const;
+    Section filter() const;
+    const uint64_t *aliases(size_t &numPairs) const;
+    size_t bytes() const;
+
+private:
+    //the mapped file, its length, and its header 
+    const char *base;
+    size_t length;
+    const Header *header;
+
+    //helper functions for aligning the next part of a file being written, 
+    //and for checking a part of a mapped file 
+    static uint64_t align(ostream &out);
+    bool fits(uint64_t offset, uint64_t bytes) const;
+};
+
+#endif
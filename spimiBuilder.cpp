@@ -0,0 +1,667 @@
+/*
+ *  spimiBuilder.cpp
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  Contains an implementation of the spimiBuilder class.   
+ *
+*/
+
+#include "spimiBuilder.h"
+#include "stringProcessing.h"
+#include "postingCursor.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const size_t spimiBuilder::MIN_BUDGET;
+
+//estimated bytes used by the hash table node of each word, on top of the 
+//word's text and its locations 
+static const size_t WORD_OVERHEAD = sizeof(string) + 
+                                    sizeof(vector<PackedLocation>) + 32;
+
+//number of locations copied at a time while merging 
+static const size_t COPY_CHUNK = 4096;
+
+/*
+ * name:      makeKey 
+ * purpose:   gets the lowercase key of a word 
+ * arguments: a reference to a string with a word 
+ * returns:   a string with the word in lowercase 
+ * effects:   lowercases the same way as the hashTable's keys 
+*/
+static string makeKey(const string &word) {
+    string key = word;
+    makeLowerInPlace(key);
+    return key;
+}
+
+// 
+//  RunReader struct, used to read the words of one run file in order while
+//  the runs are merged. Only the current word is kept in memory; its 
+//  locations are read a chunk at a time. 
+// 
+struct RunReader {
+    ifstream input;
+    string word;
+    string key;
+    uint64_t remaining;
+
+    //reads the next word and its number of locations 
+    bool nextWord() {
+        uint32_t length = 0;
+        if (not input.read((char *) &length, sizeof(length))) {
+            return false;
+        }
+        word.resize(length);
+        input.read(&word[0], length);
+        input.read((char *) &remaining, sizeof(remaining));
+        if (not input) {
+            throw runtime_error("Run file is cut short");
+        }
+        key = makeKey(word);
+        return true;
+    }
+
+    //reads up to count of the current word's locations 
+    size_t readLocations(PackedLocation *buffer, size_t count) {
+        count = min((uint64_t) count, remaining);
+        input.read((char *) buffer, count * sizeof(PackedLocation));
+        if (not input) {
+            throw runtime_error("Run file is cut short");
+        }
+        remaining -= count;
+        return count;
+    }
+};
+
+/*
+ * name:      writeOrDie 
+ * purpose:   writes bytes to a stream 
+ * arguments: an output stream, a pointer to the bytes, and how many 
+ * returns:   none 
+ * effects:   throws a runtime_error if the write fails (such as when the 
+ *            disk is full) 
+*/
+static void writeOrDie(ofstream &output, const void *data, size_t bytes) {
+    if (not output.write((const char *) data, bytes)) {
+        throw runtime_error("Unable to write index file");
+    }
+}
+
+/*
+ * name:      appendFile 
+ * purpose:   copies the contents of one file onto the end of a stream 
+ * arguments: a string with the path of the file and the stream to copy to
+ * returns:   none 
+ * effects:   copies in fixed size chunks. Throws a runtime_error if the file
+ *            cannot be read or the stream cannot be written. 
+*/
+static void appendFile(const string &path, ofstream &output) {
+    ifstream input(path, ios::binary);
+    if (not input.is_open()) {
+        throw runtime_error("Unable to open file " + path);
+    }
+
+    char chunk[65536];
+    while (input.read(chunk, sizeof(chunk)) or input.gcount() > 0) {
+        writeOrDie(output, chunk, input.gcount());
+    }
+}
+
+/*
+ * name:      spimiBuilder constructor 
+ * purpose:   creates a builder that has not been started 
+ * arguments: none
+ * returns:   none 
+ * effects:   none 
+*/
+spimiBuilder::spimiBuilder() {
+    used = 0;
+    memoryBudget = 0;
+}
+
+/*
+ * name:      spimiBuilder destructor 
+ * purpose:   removes the builder's temporary files 
+ * arguments: none
+ * returns:   none 
+ * effects:   deletes the run files, the index file, and the temporary 
+ *            directory. An index that is still mapped stays readable until
+ *            it is unmapped. 
+*/
+spimiBuilder::~spimiBuilder() {
+    removeFiles();
+}
+
+/*
+ * name:      start 
+ * purpose:   gets ready to build an index 
+ * arguments: a size_t with the most bytes of words and locations to hold in
+ *            memory and a string with the directory to put temporary files 
+ *            in 
+ * returns:   none 
+ * effects:   creates a new temporary directory inside the given one. Budgets
+ *            under a megabyte are raised to a megabyte so runs are not 
+ *            absurdly small. Throws a runtime_error if the directory cannot 
+ *            be created. 
+*/
+void spimiBuilder::start(size_t budget, const string &tempDirectory) {
+    removeFiles();
+    memoryBudget = max(budget, MIN_BUDGET);
+    used = 0;
+
+    //make a directory only this build uses 
+    string name = tempDirectory + "/gerp-XXXXXX";
+    if (mkdtemp(&name[0]) == nullptr) {
+        throw runtime_error("Unable to create a directory in " + 
+                            tempDirectory);
+    }
+    directory = name;
+    indexPath = directory + "/index";
+}
+
+/*
+ * name:      insert 
+ * purpose:   adds a location of a word 
+ * arguments: a string with the word and size_ts with the file and line 
+ *            numbers of the location 
+ * returns:   none 
+ * effects:   adds the location after the word's other locations unless it 
+ *            is the same line, then writes a run if the words in memory use
+ *            more than the budget. Throws a runtime_error if the location 
+ *            does not fit in a packed location. 
+*/
+void spimiBuilder::insert(const string &word, size_t file, size_t line) {
+    PackedLocation packed = Instance(file, line).packed;
+
+    //find the word, counting its memory if it is new 
+    unordered_map<string, vector<PackedLocation>>::iterator found = 
+        words.find(word);
+    if (found == words.end()) {
+        found = words.emplace(word, vector<PackedLocation>()).first;
+        used += found->first.capacity() + WORD_OVERHEAD;
+    }
+
+    //skip repeats of the word on the same line 
+    vector<PackedLocation> &locations = found->second;
+    if (not locations.empty() and locations.back() == packed) {
+        return;
+    }
+
+    size_t before = locations.capacity();
+    locations.push_back(packed);
+    used += (locations.capacity() - before) * sizeof(PackedLocation);
+
+    if (used + words.bucket_count() * sizeof(void *) > memoryBudget) {
+        writeRun();
+    }
+}
+
+/*
+ * name:      writeRun 
+ * purpose:   writes the words in memory to a new run file 
+ * arguments: none
+ * returns:   none 
+ * effects:   sorts the words by their lowercase key and then by their case 
+ *            sensitive text, writes each one's length, text, number of 
+ *            locations, and locations, then frees the words. Throws a 
+ *            runtime_error if the file cannot be written. 
+*/
+void spimiBuilder::writeRun() {
+    if (words.empty()) {
+        return;
+    }
+
+    //order the words the way the index stores them 
+    typedef unordered_map<string, vector<PackedLocation>>::value_type Word;
+    vector<pair<string, const Word *>> order;
+    order.reserve(words.size());
+    for (unordered_map<string, vector<PackedLocation>>::const_iterator it = 
+             words.begin(); it != words.end(); ++it) {
+        order.push_back(make_pair(makeKey(it->first), &*it));
+    }
+    sort(order.begin(), order.end(), 
+         [](const pair<string, const Word *> &a, 
+            const pair<string, const Word *> &b) {
+             if (a.first != b.first) {
+                 return a.first < b.first;
+             }
+             return a.second->first < b.second->first;
+         });
+
+    //write each word and its locations 
+    string path = directory + "/run" + to_string(runs.size());
+    ofstream output(path, ios::binary);
+    if (not output.is_open()) {
+        throw runtime_error("Unable to open file " + path);
+    }
+    runs.push_back(path);
+
+    for (size_t i = 0; i < order.size(); i++) {
+        const string &word = order[i].second->first;
+        const vector<PackedLocation> &locations = order[i].second->second;
+        uint32_t length = word.length();
+        uint64_t count = locations.size();
+
+        writeOrDie(output, &length, sizeof(length));
+        writeOrDie(output, word.data(), length);
+        writeOrDie(output, &count, sizeof(count));
+        writeOrDie(output, locations.data(), 
+                   count * sizeof(PackedLocation));
+    }
+    output.close();
+
+    //free the words (clear alone would keep the buckets) 
+    order.clear();
+    words = unordered_map<string, vector<PackedLocation>>();
+    used = 0;
+}
+
+/*
+ * name:      finish 
+ * purpose:   finishes the index once every file has been read 
+ * arguments: none
+ * returns:   a string with the path of the finished index file 
+ * effects:   writes the last run, merges the runs into the index file, 
+ *            deletes the runs, and fills in the line and file counts of keys
+ *            with several case sensitive words. Throws a runtime_error if 
+ *            any file cannot be read or written. 
+*/
+string spimiBuilder::finish() {
+    writeRun();
+    mergeRuns();
+
+    //the runs are no longer needed (their names are kept for numRuns) 
+    for (size_t i = 0; i < runs.size(); i++) {
+        unlink(runs[i].c_str());
+    }
+
+    countKeys();
+    return indexPath;
+}
+
+/*
+ * name:      mergeRuns 
+ * purpose:   merges the run files into the index file 
+ * arguments: none
+ * returns:   none 
+ * effects:   reads the runs in step, always taking the smallest word next 
+ *            (earlier runs first for the same word), and appends each 
+ *            word's locations from every run to the locations part of the 
+ *            index, dropping a line repeated across two runs. The key table,
+ *            word table, and names are written to their own temporary files
+ *            and appended after the locations, then the header is written. 
+*/
+void spimiBuilder::mergeRuns() {
+    //open every run at its first word 
+    vector<RunReader> readers(runs.size());
+    for (size_t i = 0; i < runs.size(); i++) {
+        readers[i].input.open(runs[i], ios::binary);
+        if (not readers[i].input.is_open()) {
+            throw runtime_error("Unable to open file " + runs[i]);
+        }
+    }
+
+    //the run with the smallest (key, word, run number) is on top 
+    auto later = [&readers](size_t a, size_t b) {
+        if (readers[a].key != readers[b].key) {
+            return readers[a].key > readers[b].key;
+        }
+        if (readers[a].word != readers[b].word) {
+            return readers[a].word > readers[b].word;
+        }
+        return a > b;
+    };
+    priority_queue<size_t, vector<size_t>, decltype(later)> heap(later);
+    for (size_t i = 0; i < readers.size(); i++) {
+        if (readers[i].nextWord()) {
+            heap.push(i);
+        }
+    }
+
+    //open the index and the files for the tables and names 
+    ofstream index(indexPath, ios::binary | ios::trunc);
+    ofstream keyFile(directory + "/keys", ios::binary | ios::trunc);
+    ofstream wordFile(directory + "/words", ios::binary | ios::trunc);
+    ofstream nameFile(directory + "/names", ios::binary | ios::trunc);
+    if (not index.is_open() or not keyFile.is_open() or 
+        not wordFile.is_open() or not nameFile.is_open()) {
+        throw runtime_error("Unable to create index in " + directory);
+    }
+
+    //leave room for the header, which is written last 
+    diskIndex::Header header;
+    memset(&header, 0, sizeof(header));
+    writeOrDie(index, &header, sizeof(header));
+    header.locationsOffset = sizeof(header);
+
+    diskIndex::KeyEntry key;
+    memset(&key, 0, sizeof(key));
+    string keyText;
+    bool haveKey = false;
+    vector<PackedLocation> buffer(COPY_CHUNK);
+
+    //the key directory, and the keys with the most lines so far (fewest on
+    //top; a line with several variants counts once for each, since 
+    //countKeys fixes the counts later) 
+    vector<diskIndex::DirectoryEntry> directoryTable;
+    string directoryNames;
+    priority_queue<pair<uint64_t, uint64_t>, vector<pair<uint64_t, uint64_t>>,
+                   greater<pair<uint64_t, uint64_t>>> hot;
+    auto writeKey = [&]() {
+        writeOrDie(keyFile, &key, sizeof(key));
+        hot.push(make_pair(key.numLines, header.numKeys));
+        if (hot.size() > diskIndex::HOT_KEYS) {
+            hot.pop();
+        }
+        header.numKeys++;
+    };
+
+    while (not heap.empty()) {
+        RunReader &top = readers[heap.top()];
+
+        //start a new key when the lowercase word changes 
+        if (not haveKey or top.key != keyText) {
+            if (haveKey) {
+                writeKey();
+            }
+            keyText = top.key;
+
+            //every KEY_STRIDE-th key goes in the directory 
+            if (header.numKeys % diskIndex::KEY_STRIDE == 0) {
+                diskIndex::DirectoryEntry sample;
+                memset(&sample, 0, sizeof(sample));
+                sample.nameOffset = directoryNames.length();
+                sample.nameLength = keyText.length();
+                directoryTable.push_back(sample);
+                directoryNames += keyText;
+            }
+            key.nameOffset = header.namesBytes;
+            key.nameLength = keyText.length();
+            key.numWords = 0;
+            key.firstWord = header.numWords;
+            key.numLines = 0;
+            key.numFiles = 0;
+            writeOrDie(nameFile, keyText.data(), keyText.length());
+            header.namesBytes += keyText.length();
+            haveKey = true;
+        }
+
+        //store the word's text, unless it is the same as the key's 
+        string word = top.word;
+        diskIndex::WordEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        entry.nameOffset = key.nameOffset;
+        entry.nameLength = word.length();
+        entry.firstLocation = header.numLocations;
+        if (word != keyText) {
+            entry.nameOffset = header.namesBytes;
+            writeOrDie(nameFile, word.data(), word.length());
+            header.namesBytes += word.length();
+        }
+
+        //append the word's locations from each run that has it 
+        PackedLocation last = 0;
+        while (not heap.empty() and readers[heap.top()].word == word) {
+            size_t run = heap.top();
+            heap.pop();
+
+            size_t count;
+            while ((count = readers[run].readLocations(buffer.data(), 
+                                                       COPY_CHUNK)) > 0) {
+                size_t kept = 0;
+                for (size_t i = 0; i < count; i++) {
+                    PackedLocation location = buffer[i];
+                    if (entry.numLocations > 0 and location == last) {
+                        continue;
+                    }
+                    if (entry.numLocations == 0 or 
+                        (location >> Instance::LINE_BITS) != 
+                        (last >> Instance::LINE_BITS)) {
+                        entry.numFiles++;
+                    }
+                    buffer[kept++] = location;
+                    last = location;
+                    entry.numLocations++;
+                }
+                writeOrDie(index, buffer.data(), 
+                           kept * sizeof(PackedLocation));
+            }
+
+            if (readers[run].nextWord()) {
+                heap.push(run);
+            }
+        }
+
+        writeOrDie(wordFile, &entry, sizeof(entry));
+        header.numWords++;
+        header.numLocations += entry.numLocations;
+
+        //exact for a key with one word, countKeys fixes the others 
+        key.numWords++;
+        key.numLines += entry.numLocations;
+        key.numFiles += entry.numFiles;
+    }
+    if (haveKey) {
+        writeKey();
+    }
+    keyFile.close();
+    wordFile.close();
+    nameFile.close();
+
+    //pad the locations so the tables after them are aligned 
+    uint64_t offset = header.locationsOffset + 
+                      header.numLocations * sizeof(PackedLocation);
+    uint64_t padding = (8 - offset % 8) % 8;
+    writeOrDie(index, "\0\0\0\0\0\0\0", padding);
+    offset += padding;
+
+    //append the tables and names 
+    header.keysOffset = offset;
+    appendFile(directory + "/keys", index);
+    header.wordsOffset = header.keysOffset + 
+                         header.numKeys * sizeof(diskIndex::KeyEntry);
+    appendFile(directory + "/words", index);
+    header.namesOffset = header.wordsOffset + 
+                         header.numWords * sizeof(diskIndex::WordEntry);
+    appendFile(directory + "/names", index);
+    unlink((directory + "/keys").c_str());
+    unlink((directory + "/words").c_str());
+    unlink((directory + "/names").c_str());
+
+    //append the key directory and the hot keys, most lines first, after 
+    //padding the names 
+    offset = header.namesOffset + header.namesBytes;
+    padding = (8 - offset % 8) % 8;
+    writeOrDie(index, "\0\0\0\0\0\0\0", padding);
+    header.directoryOffset = offset + padding;
+    header.numDirectory = directoryTable.size();
+    writeOrDie(index, directoryTable.data(), 
+               directoryTable.size() * sizeof(diskIndex::DirectoryEntry));
+    vector<uint64_t> hotKeys(hot.size());
+    for (size_t i = hotKeys.size(); i > 0; i--) {
+        hotKeys[i - 1] = hot.top().second;
+        hot.pop();
+    }
+    header.hotOffset = header.directoryOffset + 
+                       header.numDirectory * sizeof(diskIndex::DirectoryEntry);
+    header.numHot = hotKeys.size();
+    writeOrDie(index, hotKeys.data(), hotKeys.size() * sizeof(uint64_t));
+    header.directoryNamesOffset = header.hotOffset + 
+                                  header.numHot * sizeof(uint64_t);
+    header.directoryNamesBytes = directoryNames.length();
+    writeOrDie(index, directoryNames.data(), directoryNames.length());
+
+    //write the header now that every part's place is known 
+    memcpy(header.magic, diskIndex::MAGIC, sizeof(header.magic));
+    index.seekp(0);
+    writeOrDie(index, &header, sizeof(header));
+    index.close();
+    if (not index) {
+        throw runtime_error("Unable to write index file");
+    }
+}
+
+/*
+ * name:      countKeys 
+ * purpose:   fills in the line and file counts of keys with several words 
+ * arguments: none
+ * returns:   none 
+ * effects:   maps the index file for writing and, for each key with more 
+ *            than one case sensitive word, walks the merged locations of its
+ *            words to count the distinct lines and files. Pages are read 
+ *            from the file as needed and dropped again once they are passed,
+ *            so the locations are never all in memory at once. Throws a 
+ *            runtime_error if the file cannot be mapped.
+*/
+void spimiBuilder::countKeys() {
+    int fd = open(indexPath.c_str(), O_RDWR);
+    struct stat info;
+    if (fd < 0 or fstat(fd, &info) != 0) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        throw runtime_error("Unable to open index " + indexPath);
+    }
+
+    size_t length = info.st_size;
+    void *mapped = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED,
+                        fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        throw runtime_error("Unable to map index " + indexPath);
+    }
+
+    //find the tables from the header 
+    char *base = (char *) mapped;
+    const diskIndex::Header *header = (const diskIndex::Header *) base;
+    diskIndex::KeyEntry *keys = 
+        (diskIndex::KeyEntry *) (base + header->keysOffset);
+    const diskIndex::WordEntry *wordTable = 
+        (const diskIndex::WordEntry *) (base + header->wordsOffset);
+    const Instance *locations = 
+        (const Instance *) (base + header->locationsOffset);
+
+    //keys, words, and locations are all read in order, so the pages behind
+    //the current key in each table are dropped from memory once they add up
+    //to the budget 
+    size_t pageSize = sysconf(_SC_PAGESIZE);
+    size_t released[3] = {header->locationsOffset / pageSize * pageSize, 
+                          header->keysOffset / pageSize * pageSize, 
+                          header->wordsOffset / pageSize * pageSize};
+
+    for (uint64_t i = 0; i < header->numKeys; i++) {
+        const diskIndex::WordEntry &first = wordTable[keys[i].firstWord];
+        size_t reached[3] = {header->locationsOffset + first.firstLocation *
+                                                    sizeof(PackedLocation), 
+                             (size_t) ((char *) &keys[i] - base), 
+                             (size_t) ((char *) &first - base)};
+        for (int part = 0; part < 3; part++) {
+            size_t page = reached[part] / pageSize * pageSize;
+            if (page > released[part] and 
+                page - released[part] > memoryBudget / 4) {
+                madvise(base + released[part], page - released[part], 
+                        MADV_DONTNEED);
+                released[part] = page;
+            }
+        }
+
+        if (keys[i].numWords < 2) {
+            continue;
+        }
+
+        //merge the locations of the key's words 
+        vector<LocationList> lists;
+        for (uint32_t j = 0; j < keys[i].numWords; j++) {
+            const diskIndex::WordEntry &word = 
+                wordTable[keys[i].firstWord + j];
+            LocationList list = {locations + word.firstLocation, 
+                                 (size_t) word.numLocations};
+            lists.push_back(list);
+        }
+
+        //count the distinct lines, then the distinct files 
+        PostingCursor cursor(lists);
+        Instance location;
+        size_t lines = 0, files = 0, file = 0;
+        while (cursor.next(location)) {
+            lines++;
+        }
+        cursor.restart();
+        while (cursor.nextFile(file)) {
+            files++;
+        }
+        keys[i].numLines = lines;
+        keys[i].numFiles = files;
+    }
+
+    munmap(mapped, length);
+}
+
+/*
+ * name:      removeFiles 
+ * purpose:   deletes the builder's temporary files 
+ * arguments: none
+ * returns:   none 
+ * effects:   deletes any run files, the index file, and the temporary 
+ *            directory, if the builder was started 
+*/
+void spimiBuilder::removeFiles() {
+    if (directory.empty()) {
+        return;
+    }
+
+    for (size_t i = 0; i < runs.size(); i++) {
+        unlink(runs[i].c_str());
+    }
+    runs.clear();
+    unlink((directory + "/keys").c_str());
+    unlink((directory + "/words").c_str());
+    unlink((directory + "/names").c_str());
+    unlink(indexPath.c_str());
+    rmdir(directory.c_str());
+    directory.clear();
+    indexPath.clear();
+}
+
+/*
+ * name:      numRuns 
+ * purpose:   gets the number of runs written so far 
+ * arguments: none
+ * returns:   a size_t with the number of run files 
+ * effects:   none 
+*/
+size_t spimiBuilder::numRuns() const {
+    return runs.size();
+}
+
+/*
+ * name:      bytesInMemory 
+ * purpose:   gets the estimated memory used by the words not yet in a run 
+ * arguments: none
+ * returns:   a size_t with the estimated bytes 
+ * effects:   none 
+*/
+size_t spimiBuilder::bytesInMemory() const {
+    return used;
+}
+
+/*
+ * name:      budget 
+ * purpose:   gets the memory budget of the build 
+ * arguments: none
+ * returns:   a size_t with the budget in bytes 
+ * effects:   none 
+*/
+size_t spimiBuilder::budget() const {
+    return memoryBudget;
+}
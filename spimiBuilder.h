@@ -0,0 +1,70 @@
+/*
+ *  spimiBuilder.h
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  spimiBuilder is a class that builds an index file for diskIndex while 
+ *  using no more than a fixed amount of memory for locations, so 
+ *  directories larger than memory can be indexed (single pass in-memory 
+ *  indexing, or SPIMI). Words and their locations are collected in memory 
+ *  until they use more than the budget; then they are sorted and written to 
+ *  a run file on disk and memory is freed. Once every file has been read, 
+ *  the runs are merged, a word at a time, into the final index file. Since 
+ *  files are read in order, a word's locations in an earlier run all come 
+ *  before its locations in a later run, so merging them is just appending. 
+ *  The run files and the index are kept in a temporary directory that is 
+ *  removed when the builder is destroyed. 
+ *
+*/
+
+#ifndef SPIMIBUILDER_H
+#define SPIMIBUILDER_H
+
+#include "diskIndex.h"
+#include "packedLocation.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+class spimiBuilder {
+//public functions available to the client 
+public:
+    spimiBuilder();
+    ~spimiBuilder();
+
+    //functions for building the index 
+    void start(size_t memoryBudget, const string &tempDirectory);
+    void insert(const string &word, size_t file, size_t line);
+    string finish();
+
+    //functions for the state of the build 
+    size_t numRuns() const;
+    size_t bytesInMemory() const;
+    size_t budget() const;
+
+private:
+    //words collected since the last run and their locations, in order 
+    unordered_map<string, vector<PackedLocation>> words;
+
+    //estimated bytes used by words, the budget, and the smallest budget 
+    size_t used;
+    size_t memoryBudget;
+    static const size_t MIN_BUDGET = 1 << 20;
+
+    //the temporary directory and the run and index files in it 
+    string directory;
+    vector<string> runs;
+    string indexPath;
+
+    //helper functions for writing runs and merging them 
+    void writeRun();
+    void mergeRuns();
+    void countKeys();
+    void removeFiles();
+};
+
+#endif
@@ -23,35 +23,56 @@
  *              
 */
 string stripNonAlphaNum(string input) {
-    //bool to contain whether we reached alphanumeric char 
-    bool alpha = false;
-
-    //find index of first alphanumeric char 
-    int index_front = 0;
-    while (not alpha and index_front < input.length()){ 
-        if (isalnum(input[index_front])) 
-            alpha = true;
-        
-        else 
-            index_front++;
-    }
+    size_t start = 0;
+    size_t length = trimNonAlphaNum(input.data(), input.length(), start);
 
-    //if all chars are non alphanumeric, return empty string 
-    if (index_front == input.length()) 
-        return "";
+    //remove leading and trailing non alphanumeric chars and return new string 
+    return input.substr(start, length);
+}
 
-    //set bool back to false 
-    alpha = false;
-    //find index of last alphanumeric char 
-    int index_back = input.length() - 1;
-    while (not alpha) {
-        if (isalnum(input[index_back]))
-            alpha = true;
+/*
+ * name:      trimNonAlphaNum 
+ * purpose:   finds the part of some characters that stripNonAlphaNum keeps, 
+ *            without copying them 
+ * arguments: a pointer to the characters, their number, and a reference to 
+ *            a size_t to store where the kept part starts 
+ * returns:   a size_t with the length of the kept part, 0 if every 
+ *            character is non alphanumeric 
+ * effects:   steps in from each end past non alphanumeric characters, one 
+ *            table lookup per character 
+*/
+size_t trimNonAlphaNum(const char *text, size_t length, size_t &start) {
+    //find the first alphanumeric char 
+    size_t front = 0;
+    while (front < length and not isAlphaNumChar(text[front])) {
+        front++;
+    }
+    start = front;
 
-        else 
-            index_back--;
+    //if all chars are non alphanumeric, nothing is kept 
+    if (front == length) {
+        return 0;
     }
 
-    //remove leading and trailing non alphanumeric chars and return new string 
-    return input.substr(index_front, index_back - index_front + 1);
-}
\ No newline at end of file
+    //find the last alphanumeric char, there is at least one 
+    size_t back = length - 1;
+    while (not isAlphaNumChar(text[back])) {
+        back--;
+    }
+    return back - front + 1;
+}
+
+/*
+ * name:      makeLowerInPlace 
+ * purpose:   makes a word all lowercase 
+ * arguments: a reference to a string with the word 
+ * returns:   none 
+ * effects:   replaces each character with its lowercase form from CHARS 
+*/
+void makeLowerInPlace(string &word) {
+    char *text = &word[0];
+    size_t length = word.length();
+    for (size_t i = 0; i < length; i++) {
+        text[i] = lowerChar(text[i]);
+    }
+}
@@ -8,12 +8,86 @@
  *  alphanumeric characters and nonalphanumeric characters that are within,
  *  but not leading nor trailing.   
  *
+ *  Every byte is classified (whitespace, alphanumeric) and lowercased with 
+ *  one lookup in CHARS, a 256 entry table built at compile time with the 
+ *  rules of the C locale, so the tokenizer, stripNonAlphaNum, and every 
+ *  place that lowercases a key agree with each other whatever the locale 
+ *  is. trimNonAlphaNum and makeLowerInPlace work on characters in place, 
+ *  for the tokenizer, which runs once per word of every file. 
+ *
 */
 
+#ifndef STRINGPROCESSING_H
+#define STRINGPROCESSING_H
+
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <iostream>
 
 using namespace std;
 
-//function declaration 
-string stripNonAlphaNum(string input);
\ No newline at end of file
+// 
+//  CharTable struct, used to store the class bits and the lowercase form of
+//  every byte 
+// 
+struct CharTable {
+    uint8_t classes[256];
+    char lower[256];
+};
+
+//class bits of a byte in a CharTable 
+const uint8_t CHAR_SPACE = 1;
+const uint8_t CHAR_ALNUM = 2;
+
+/*
+ * name:      makeCharTable 
+ * purpose:   builds the table of classes and lowercase forms 
+ * arguments: none
+ * returns:   a CharTable for the C locale: spaces are ' ', '\t', '\n', 
+ *            '\v', '\f' and '\r', alphanumerics are the ASCII letters and 
+ *            digits, and only 'A' to 'Z' have a different lowercase form 
+ * effects:   none, it is run by the compiler 
+*/
+constexpr CharTable makeCharTable() {
+    CharTable table = {};
+    for (int c = 0; c < 256; c++) {
+        bool upper = c >= 'A' and c <= 'Z';
+        bool letter = upper or (c >= 'a' and c <= 'z');
+        bool digit = c >= '0' and c <= '9';
+        bool space = c == ' ' or (c >= '\t' and c <= '\r');
+        table.classes[c] = (space ? CHAR_SPACE : 0) | 
+                           (letter or digit ? CHAR_ALNUM : 0);
+        table.lower[c] = (char) (upper ? c - 'A' + 'a' : c);
+    }
+    return table;
+}
+
+constexpr CharTable CHARS = makeCharTable();
+
+/*
+ * name:      isSpaceChar, isAlphaNumChar, lowerChar 
+ * purpose:   classify or lowercase one byte 
+ * arguments: a char 
+ * returns:   whether it is whitespace, whether it is a letter or digit, or 
+ *            its lowercase form 
+ * effects:   none, one lookup in CHARS 
+*/
+inline bool isSpaceChar(char c) {
+    return CHARS.classes[(unsigned char) c] & CHAR_SPACE;
+}
+
+inline bool isAlphaNumChar(char c) {
+    return CHARS.classes[(unsigned char) c] & CHAR_ALNUM;
+}
+
+inline char lowerChar(char c) {
+    return CHARS.lower[(unsigned char) c];
+}
+
+//function declarations 
+string stripNonAlphaNum(string input);
+size_t trimNonAlphaNum(const char *text, size_t length, size_t &start);
+void makeLowerInPlace(string &word);
+
+#endif
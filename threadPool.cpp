@@ -0,0 +1,157 @@
+/*
+ *  threadPool.cpp
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  Contains an implementation of the threadPool class.   
+ *
+*/
+
+#include "threadPool.h"
+
+/*
+ * name:      threadPool constructor 
+ * purpose:   starts the worker threads 
+ * arguments: a size_t with the total number of threads to run tasks on, 
+ *            including the thread that calls run 
+ * returns:   none 
+ * effects:   starts numThreads - 1 workers, which sleep until there is work 
+*/
+threadPool::threadPool(size_t numThreads) {
+    job = nullptr;
+    nextTask = numTasks = tasksDone = 0;
+    generation = 0;
+    stopping = false;
+
+    //the calling thread is one of the threads 
+    for (size_t i = 1; i < numThreads; i++) {
+        workers.push_back(thread(&threadPool::work, this));
+    }
+}
+
+/*
+ * name:      destructor 
+ * purpose:   stops the worker threads 
+ * arguments: none
+ * returns:   none 
+ * effects:   wakes every worker, tells it to stop and waits for it to exit 
+*/
+threadPool::~threadPool() {
+    {
+        unique_lock<mutex> held(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+}
+
+/*
+ * name:      size 
+ * purpose:   gets the number of threads that run tasks 
+ * arguments: none
+ * returns:   a size_t with the number of workers plus the calling thread 
+ * effects:   none 
+*/
+size_t threadPool::size() {
+    return workers.size() + 1;
+}
+
+/*
+ * name:      run 
+ * purpose:   runs tasks 0 to count - 1 in parallel and waits for them 
+ * arguments: a size_t with the number of tasks and the function to call 
+ *            with each task number 
+ * returns:   none 
+ * effects:   hands out the tasks to the workers and the calling thread, 
+ *            returns once all of them are done. Rethrows the first 
+ *            exception a task threw. 
+*/
+void threadPool::run(size_t count, const function<void(size_t)> &task) {
+    //nothing to share, run the tasks right here 
+    if (workers.empty() or count < 2) {
+        for (size_t i = 0; i < count; i++) {
+            task(i);
+        }
+        return;
+    }
+
+    unique_lock<mutex> held(lock);
+
+    //publish the job and wake the workers 
+    job = &task;
+    nextTask = 0;
+    numTasks = count;
+    tasksDone = 0;
+    error = nullptr;
+    generation++;
+    wake.notify_all();
+
+    //help out, then wait for the tasks other threads are still running 
+    runTasks(held);
+    finished.wait(held, [this] { return tasksDone == numTasks; });
+
+    job = nullptr;
+    if (error) {
+        rethrow_exception(error);
+    }
+}
+
+/*
+ * name:      runTasks 
+ * purpose:   runs tasks of the current job until none are left to hand out 
+ * arguments: a reference to the held lock 
+ * returns:   none 
+ * effects:   takes the next task number under the lock, runs it without the
+ *            lock, records any exception and counts it as done 
+*/
+void threadPool::runTasks(unique_lock<mutex> &held) {
+    while (nextTask < numTasks) {
+        size_t task = nextTask++;
+
+        held.unlock();
+        exception_ptr thrown = nullptr;
+        try {
+            (*job)(task);
+        } catch (...) {
+            thrown = current_exception();
+        }
+        held.lock();
+
+        //keep the first exception and report the task as done 
+        if (thrown and not error) {
+            error = thrown;
+        }
+        tasksDone++;
+        if (tasksDone == numTasks) {
+            finished.notify_all();
+        }
+    }
+}
+
+/*
+ * name:      work 
+ * purpose:   the loop each worker thread runs 
+ * arguments: none
+ * returns:   none 
+ * effects:   sleeps until a new job is published (or the pool is stopping) 
+ *            and runs tasks of that job 
+*/
+void threadPool::work() {
+    unique_lock<mutex> held(lock);
+    size_t seen = generation;
+
+    while (true) {
+        wake.wait(held, [this, seen] { 
+            return stopping or generation != seen; 
+        });
+        if (stopping) {
+            return;
+        }
+
+        seen = generation;
+        runTasks(held);
+    }
+}
@@ -0,0 +1,63 @@
+/*
+ *  threadPool.h
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  threadPool is a class that keeps a fixed set of worker threads and uses 
+ *  them to run a number of independent tasks in parallel. run() hands out 
+ *  task numbers 0 to numTasks - 1 to the workers and the calling thread, and
+ *  returns once every task has finished. If a task throws, the first 
+ *  exception is rethrown by run() after the rest of the tasks are done. 
+ *  With no workers (or a single task) the tasks simply run in order on the
+ *  calling thread. 
+ *
+*/
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+class threadPool {
+//public functions available to the client 
+public:
+    threadPool(size_t numThreads);
+    ~threadPool();
+
+    void run(size_t numTasks, const function<void(size_t)> &task);
+    size_t size();
+
+private:
+    //worker threads, not counting the thread that calls run 
+    vector<thread> workers;
+
+    //lock and signals for handing out tasks and reporting they are done 
+    mutex lock;
+    condition_variable wake;
+    condition_variable finished;
+
+    //the current job: its task, the next task number to hand out, how many
+    //tasks there are and how many have finished 
+    const function<void(size_t)> *job;
+    size_t nextTask, numTasks, tasksDone;
+
+    //incremented for each job so sleeping workers know there is new work 
+    size_t generation;
+    bool stopping;
+
+    //first exception thrown by a task of the current job 
+    exception_ptr error;
+
+    //helper functions for the workers 
+    void work();
+    void runTasks(unique_lock<mutex> &held);
+};
+
+#endif
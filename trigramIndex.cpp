@@ -0,0 +1,364 @@
+/*
+ *  trigramIndex.cpp
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  Contains an implementation of the trigramIndex class.   
+ *
+*/
+
+#include "trigramIndex.h"
+#include "stringProcessing.h"
+#include <algorithm>
+#include <cctype>
+
+/*
+ * name:      trigramIndex constructor 
+ * purpose:   creates an empty trigram index 
+ * arguments: none
+ * returns:   none 
+ * effects:   none 
+*/
+trigramIndex::trigramIndex() {
+
+}
+
+/*
+ * name:      makeTrigram 
+ * purpose:   turns three characters into a trigram key 
+ * arguments: a pointer to the first of three characters 
+ * returns:   a uint32_t with the three lowercase bytes, first byte highest 
+ * effects:   none 
+*/
+uint32_t trigramIndex::makeTrigram(const char *text) {
+    uint32_t key = 0;
+    for (int i = 0; i < 3; i++) {
+        key = (key << 8) | (uint8_t) lowerChar(text[i]);
+    }
+    return key;
+}
+
+/*
+ * name:      addLine 
+ * purpose:   adds each trigram of a line to the index 
+ * arguments: a pointer to the line's text, its length, and its location 
+ * returns:   none 
+ * effects:   finds the distinct trigrams of the line and appends the line's
+ *            location to each of their lists, as the difference from the 
+ *            last location in the list. Lines must be added in file and line
+ *            order. 
+*/
+void trigramIndex::addLine(const char *text, size_t length, 
+                           Instance location) {
+    if (length < 3) {
+        return;
+    }
+
+    //find the distinct trigrams of the line 
+    lineTrigrams.clear();
+    for (size_t i = 0; i + 3 <= length; i++) {
+        lineTrigrams.push_back(makeTrigram(text + i));
+    }
+    sort(lineTrigrams.begin(), lineTrigrams.end());
+    lineTrigrams.erase(unique(lineTrigrams.begin(), lineTrigrams.end()),
+                       lineTrigrams.end());
+
+    //append the line to each trigram's list 
+    for (size_t i = 0; i < lineTrigrams.size(); i++) {
+        Postings &postings = trigrams[lineTrigrams[i]];
+        if (postings.encoded.empty()) {
+            postings.last = 0;
+            postings.count = 0;
+        }
+
+        //write the difference 7 bits at a time, low bits first 
+        PackedLocation delta = location.packed - postings.last;
+        while (delta >= 0x80) {
+            postings.encoded.push_back((uint8_t) (delta | 0x80));
+            delta >>= 7;
+        }
+        postings.encoded.push_back((uint8_t) delta);
+
+        postings.last = location.packed;
+        postings.count++;
+    }
+}
+
+/*
+ * name:      decode 
+ * purpose:   expands a trigram's compressed list of lines 
+ * arguments: a reference to the trigram's postings and a vector to store the
+ *            lines in 
+ * returns:   none 
+ * effects:   replaces the contents of the vector with the trigram's lines, 
+ *            in file and line order 
+*/
+void trigramIndex::decode(const Postings &postings, vector<Instance> &lines) {
+    lines.clear();
+    lines.reserve(postings.count);
+
+    PackedLocation value = 0;
+    size_t i = 0, size = postings.encoded.size();
+    while (i < size) {
+        //read one difference, 7 bits at a time 
+        PackedLocation delta = 0;
+        int shift = 0;
+        uint8_t byte;
+        do {
+            byte = postings.encoded[i++];
+            delta |= (PackedLocation) (byte & 0x7f) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+
+        value += delta;
+        Instance location;
+        location.packed = value;
+        lines.push_back(location);
+    }
+}
+
+/*
+ * name:      candidates 
+ * purpose:   finds the lines that contain every trigram of some literals 
+ * arguments: a vector of literal strings that a matching line must contain
+ *            and a vector to store the candidate lines in 
+ * returns:   returns true if the literals had any trigrams (and lines holds
+ *            the candidates), false if they had none and every line is a 
+ *            candidate 
+ * effects:   intersects the lists of every trigram of the literals, starting
+ *            with the shortest list so the intermediate results stay small.
+ *            Stops early once the intersection is empty. 
+*/
+bool trigramIndex::candidates(const vector<string> &literals, 
+                              vector<Instance> &lines) const {
+    //collect the distinct trigrams of the literals 
+    vector<uint32_t> needed;
+    for (size_t i = 0; i < literals.size(); i++) {
+        for (size_t j = 0; j + 3 <= literals[i].length(); j++) {
+            needed.push_back(makeTrigram(literals[i].data() + j));
+        }
+    }
+    sort(needed.begin(), needed.end());
+    needed.erase(unique(needed.begin(), needed.end()), needed.end());
+
+    lines.clear();
+    if (needed.empty()) {
+        return false;
+    }
+
+    //find each trigram's list, any missing trigram means no candidates 
+    vector<const Postings *> lists;
+    for (size_t i = 0; i < needed.size(); i++) {
+        unordered_map<uint32_t, Postings>::const_iterator found = 
+            trigrams.find(needed[i]);
+        if (found == trigrams.end()) {
+            return true;
+        }
+        lists.push_back(&found->second);
+    }
+
+    //intersect from the shortest list up 
+    sort(lists.begin(), lists.end(), 
+         [](const Postings *a, const Postings *b) {
+             return a->count < b->count;
+         });
+    decode(*lists[0], lines);
+
+    vector<Instance> other, kept;
+    for (size_t i = 1; i < lists.size() and not lines.empty(); i++) {
+        decode(*lists[i], other);
+
+        kept.clear();
+        set_intersection(lines.begin(), lines.end(), other.begin(), 
+                         other.end(), back_inserter(kept));
+        lines.swap(kept);
+    }
+
+    return true;
+}
+
+/*
+ * name:      requiredLiterals 
+ * purpose:   finds strings that every match of a regular expression contains
+ * arguments: a string with a regular expression (ECMAScript syntax) 
+ * returns:   a vector of literal strings; empty if none could be found 
+ * effects:   collects runs of plain characters, cutting a run at any special
+ *            character and dropping a character that a quantifier makes 
+ *            optional. Groups and character classes are skipped entirely, 
+ *            and a pattern with alternation ('|') gives no literals, since 
+ *            either side may match without the other's text. 
+*/
+vector<string> trigramIndex::requiredLiterals(const string &pattern) {
+    vector<string> literals;
+    if (pattern.find('|') != string::npos) {
+        return literals;
+    }
+
+    string run;
+    size_t i = 0, size = pattern.length();
+    while (i < size) {
+        char c = pattern[i];
+
+        //escapes are either a literal character, or a class like \w, a 
+        //code like \x41, or a backreference, which end the run 
+        if (c == '\\') {
+            if (i + 1 < size and not isAlphaNumChar(pattern[i + 1])) {
+                run += pattern[i + 1];
+                i += 2;
+            } else {
+                literals.push_back(run);
+                run.clear();
+                i = skipEscape(pattern, i);
+            }
+        }
+        //skip a character class or group, which may match many things 
+        else if (c == '[' or c == '(') {
+            i = (c == '[') ? skipClass(pattern, i) : skipGroup(pattern, i);
+            literals.push_back(run);
+            run.clear();
+        }
+        //a quantifier that allows zero repeats makes the last character 
+        //optional, so it cannot be part of a required run 
+        else if (c == '*' or c == '?' or c == '{') {
+            if (not run.empty()) {
+                run.pop_back();
+            }
+            literals.push_back(run);
+            run.clear();
+            if (c == '{') {
+                i = pattern.find('}', i);
+                i = (i == string::npos) ? size : i;
+            }
+            i++;
+        }
+        //any other special character ends the run 
+        else if (c == '+' or c == '.' or c == '^' or c == '$' or c == ')' or
+                 c == ']' or c == '}') {
+            literals.push_back(run);
+            run.clear();
+            i++;
+        }
+        else {
+            run += c;
+            i++;
+        }
+    }
+    literals.push_back(run);
+
+    //keep only the runs long enough to have a trigram 
+    vector<string> useful;
+    for (size_t j = 0; j < literals.size(); j++) {
+        if (literals[j].length() >= 3) {
+            useful.push_back(literals[j]);
+        }
+    }
+    return useful;
+}
+
+/*
+ * name:      skipEscape 
+ * purpose:   finds the end of an escape in a regular expression 
+ * arguments: the pattern, and the index of the escape's backslash 
+ * returns:   a size_t with the index just past the escape 
+ * effects:   takes the digits of \xHH, \uHHHH, and \cX along with the 
+ *            letter, and every digit of a backreference or \0 
+*/
+size_t trigramIndex::skipEscape(const string &pattern, size_t i) {
+    size_t size = pattern.length();
+    if (i + 1 >= size) {
+        return size;
+    }
+
+    char escaped = pattern[i + 1];
+    size_t end = i + 2;
+    if (escaped == 'x') {
+        end += 2;
+    } else if (escaped == 'u') {
+        end += 4;
+    } else if (escaped == 'c') {
+        end += 1;
+    } else if (isdigit((unsigned char) escaped)) {
+        while (end < size and isdigit((unsigned char) pattern[end])) {
+            end++;
+        }
+    }
+    return min(end, size);
+}
+
+/*
+ * name:      skipClass 
+ * purpose:   finds the end of a character class in a regular expression 
+ * arguments: the pattern, and the index of the class's '[' 
+ * returns:   a size_t with the index just past the closing ']' 
+ * effects:   the first ']' that is not escaped closes the class, as in 
+ *            ECMAScript, where "[]" is an empty class 
+*/
+size_t trigramIndex::skipClass(const string &pattern, size_t i) {
+    size_t size = pattern.length();
+    i++;
+    while (i < size) {
+        if (pattern[i] == '\\') {
+            i = skipEscape(pattern, i);
+        } else if (pattern[i] == ']') {
+            return i + 1;
+        } else {
+            i++;
+        }
+    }
+    return size;
+}
+
+/*
+ * name:      skipGroup 
+ * purpose:   finds the end of a group in a regular expression 
+ * arguments: the pattern, and the index of the group's '(' 
+ * returns:   a size_t with the index just past the matching ')' 
+ * effects:   skips escapes and character classes whole, so a ')' or 
+ *            '(' inside them does not count 
+*/
+size_t trigramIndex::skipGroup(const string &pattern, size_t i) {
+    size_t size = pattern.length();
+    int depth = 0;
+    while (i < size) {
+        if (pattern[i] == '\\') {
+            i = skipEscape(pattern, i);
+        } else if (pattern[i] == '[') {
+            i = skipClass(pattern, i);
+        } else {
+            if (pattern[i] == '(') {
+                depth++;
+            } else if (pattern[i] == ')' and --depth == 0) {
+                return i + 1;
+            }
+            i++;
+        }
+    }
+    return size;
+}
+
+/*
+ * name:      numTrigrams 
+ * purpose:   gets the number of distinct trigrams in the index 
+ * arguments: none
+ * returns:   a size_t with the number of trigrams 
+ * effects:   none 
+*/
+size_t trigramIndex::numTrigrams() const {
+    return trigrams.size();
+}
+
+/*
+ * name:      bytes 
+ * purpose:   gets the memory used by the compressed lists 
+ * arguments: none
+ * returns:   a size_t with the bytes used by the lists and their entries 
+ * effects:   none 
+*/
+size_t trigramIndex::bytes() const {
+    size_t total = trigrams.size() * (sizeof(uint32_t) + sizeof(Postings));
+    for (unordered_map<uint32_t, Postings>::const_iterator it = 
+             trigrams.begin(); it != trigrams.end(); ++it) {
+        total += it->second.encoded.capacity();
+    }
+    return total;
+}
@@ -0,0 +1,74 @@
+/*
+ *  trigramIndex.h
+ *  Rolando Ortega and Mateusz Zubrzycki 
+ *  12/11/23
+ *
+ *  trigramIndex is a class that maps every three character sequence (a 
+ *  trigram) found in the directory to the lines that contain it, so that 
+ *  substring and regular expression searches only have to look at lines 
+ *  that could possibly match. Trigrams are folded to lowercase, which lets 
+ *  the same index serve case sensitive and insensitive searches. Each 
+ *  trigram's lines are stored as a compressed list: the difference between
+ *  each packed location and the one before it, written as a variable length
+ *  integer (7 bits per byte), which takes one or two bytes for most lines.
+ *  The index only narrows down the candidates; callers check each candidate
+ *  line against the actual pattern. 
+ *
+*/
+
+#ifndef TRIGRAMINDEX_H
+#define TRIGRAMINDEX_H
+
+#include "packedLocation.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+class trigramIndex {
+//public functions available to the client 
+public:
+    trigramIndex();
+
+    //function for adding a line of text 
+    void addLine(const char *text, size_t length, Instance location);
+
+    //functions for finding the lines that could contain a pattern 
+    bool candidates(const vector<string> &literals, 
+                    vector<Instance> &lines) const;
+    static vector<string> requiredLiterals(const string &pattern);
+
+    //functions for the size of the index 
+    size_t numTrigrams() const;
+    size_t bytes() const;
+
+private:
+    // 
+    //  Postings struct, used to store the compressed lines of one trigram 
+    //  and the last location added (the base for the next difference) 
+    // 
+    struct Postings {
+        vector<uint8_t> encoded;
+        PackedLocation last;
+        size_t count;
+    };
+
+    //postings of each trigram, keyed by its three lowercase bytes 
+    unordered_map<uint32_t, Postings> trigrams;
+
+    //scratch space for the trigrams of the line being added 
+    vector<uint32_t> lineTrigrams;
+
+    //helper functions for encoding and decoding 
+    static uint32_t makeTrigram(const char *text);
+    static void decode(const Postings &postings, vector<Instance> &lines);
+
+    //helper functions for reading the parts of a regular expression 
+    static size_t skipEscape(const string &pattern, size_t i);
+    static size_t skipClass(const string &pattern, size_t i);
+    static size_t skipGroup(const string &pattern, size_t i);
+};
+
+#endif
@@ -11,11 +11,14 @@
 #include "stringProcessing.h"
 #include "hashTable.h"
 #include "gerp.h"
-#include "FSTree.h"
-#include "DirNode.h"
 #include <cassert>
+#include <cctype>
+#include <cstring>
 #include <iostream>
+#include <sstream>
+#include <iterator>
 #include <functional>
+#include <regex>
 
 using namespace std;
 
@@ -68,6 +71,28 @@ void allAlphaNumeric() {
 }
 
 
+//Testing the character table by comparing every byte's class and lowercase 
+//form to the C library's in the C locale, and trimming a word in place 
+//with bytes outside of ASCII around it 
+void charTableTest() {
+    for (int c = 0; c < 256; c++) {
+        assert(isSpaceChar((char) c) == (isspace(c) != 0));
+        assert(isAlphaNumChar((char) c) == (isalnum(c) != 0));
+        assert(lowerChar((char) c) == (char) tolower(c));
+    }
+
+    //Assert that the kept part is found without copying 
+    string test = "\xc3\xa9(COMP-15)\xc3\xa9";
+    size_t start = 0;
+    assert(trimNonAlphaNum(test.data(), test.length(), start) == 7);
+    assert(test.substr(start, 7) == "COMP-15");
+    assert(trimNonAlphaNum("!?", 2, start) == 0);
+
+    makeLowerInPlace(test);
+    assert(test == "\xc3\xa9(comp-15)\xc3\xa9");
+}
+
+
 //Testing the hashTable constructor to ensure that initial values are
 //assigned correctly
 void hashTableConstructorTest() {
@@ -152,8 +177,8 @@ void checkWordLocationAndInstanceInsertion() {
     WordLocations wordLocation = bucket.nodes.at(0).entries.at(0);
 
     assert(wordLocation.word == "the");
-    assert(wordLocation.location.at(0).file_path_index == 1);
-    assert(wordLocation.location.at(0).lineNum == 9);
+    assert(wordLocation.location.at(0).file_path_index() == 1);
+    assert(wordLocation.location.at(0).lineNum() == 9);
 
 }
 
@@ -233,8 +258,8 @@ void checkDuplicateChecker() {
     assert(bucket.nodes.at(0).entries.at(0).word == "the");
 
     //Assert correct file_path_index and lineNum
-    assert(wordLocation.location.at(0).file_path_index == 1);
-    assert(wordLocation.location.at(0).lineNum == 9);
+    assert(wordLocation.location.at(0).file_path_index() == 1);
+    assert(wordLocation.location.at(0).lineNum() == 9);
 }
 
 
@@ -453,8 +478,8 @@ void getSensitiveWordTest() {
 
     //Assert that correct corresponding WordLocations struct was found
     assert(happWordLocation.word == "Happiness");
-    assert(happWordLocation.location.at(0).file_path_index == 12);
-    assert(happWordLocation.location.at(0).lineNum == 20);
+    assert(happWordLocation.location.at(0).file_path_index() == 12);
+    assert(happWordLocation.location.at(0).lineNum() == 20);
 
 }
 
@@ -576,14 +601,1515 @@ void testInsertion() {
 
 //Testing the treeTraversal function by creating a directory with one file in
 //it and calling the gerp constructor (which calls the treeTraversal function),
-//ensuring that the filepaths string vector in the gerp class is updated with
+//ensuring that the paths table in the gerp class is updated with
 //the correct number of possible filepaths: 1
 void treeTraversalTest() {
 
     //dir is a directory with one file in it
-    //Constructor appends all filepaths into a string vector
+    //Constructor adds all filepaths into a path table
     gerp the_gerp("dir", "output.txt");
 
-    //Assert that size of filepaths vector is 1 (corresponding to the 1 file)
-    assert(the_gerp.filepaths.size() == 1);
-}
\ No newline at end of file
+    //Assert that size of paths table is 1 (corresponding to the 1 file)
+    assert(the_gerp.paths.size() == 1);
+}
+
+//Testing @in after files change under --watch, by applying a batch that 
+//edits a file, creates one beside it and creates one in a new directory, 
+//and ensuring that queries of both directories find the new files 
+void watchScopeTest() {
+
+    string root = "/tmp/gerp_watch_scope_test." + to_string(getpid());
+    string output = root + ".out";
+    mkdir(root.c_str(), 0700);
+    mkdir((root + "/a").c_str(), 0700);
+    mkdir((root + "/b").c_str(), 0700);
+    ofstream(root + "/a/x.txt") << "the old\n";
+    ofstream(root + "/b/z.txt") << "the other\n";
+
+    {
+        gerp the_gerp(root, output);
+        for (size_t i = 0; i < the_gerp.paths.size(); i++) {
+            the_gerp.fileIds[the_gerp.paths.path(i)] = i;
+        }
+
+        //edit a/x.txt, create a/new.txt and d/y.txt in a new directory 
+        mkdir((root + "/d").c_str(), 0700);
+        ofstream(root + "/a/x.txt") << "the edit\n";
+        ofstream(root + "/a/new.txt") << "the fresh\n";
+        ofstream(root + "/d/y.txt") << "the deep\n";
+        vector<string> changed = {root + "/a/x.txt", root + "/a/new.txt", 
+                                  root + "/d/y.txt"};
+        the_gerp.applyChanges(changed, vector<string>());
+
+        istringstream queries("@in " + root + "/a @i the\n@in " + root + 
+                              "/d the\n@in b the\n@q\n");
+        the_gerp.handleQuery(queries);
+    }
+
+    //Assert that each directory gives only its own, current files 
+    ifstream results(output);
+    string text((istreambuf_iterator<char>(results)), 
+                istreambuf_iterator<char>());
+    assert(text == root + "/a/new.txt:1: the fresh\n" + 
+                   root + "/a/x.txt:1: the edit\n" + 
+                   root + "/d/y.txt:1: the deep\n" + 
+                   root + "/b/z.txt:1: the other\n");
+
+    unlink(output.c_str());
+    unlink((root + "/a/x.txt").c_str());
+    unlink((root + "/a/new.txt").c_str());
+    unlink((root + "/b/z.txt").c_str());
+    unlink((root + "/d/y.txt").c_str());
+    rmdir((root + "/a").c_str());
+    rmdir((root + "/b").c_str());
+    rmdir((root + "/d").c_str());
+    rmdir(root.c_str());
+}
+
+//Testing the copies of files found while indexing, by ensuring that a file
+//with the same bytes as an earlier one becomes its alias and is counted, 
+//and that a file whose hash matches an earlier one's but whose bytes do not
+//is kept apart
+void duplicateContentsTest() {
+
+    string root = "/tmp/gerp_duplicate_test." + to_string(getpid());
+    string output = root + ".out";
+    mkdir(root.c_str(), 0700);
+    ofstream(root + "/a.txt") << "the same\n";
+    ofstream(root + "/b.txt") << "the same\n";
+    ofstream(root + "/c.txt") << "the other\n";
+
+    {
+        gerp the_gerp(root, output);
+        size_t first = the_gerp.paths.size(), other = first;
+        for (size_t i = 0; i < the_gerp.paths.size(); i++) {
+            string path = the_gerp.paths.path(i);
+            if (path == root + "/c.txt") {
+                other = i;
+            } else if (first == the_gerp.paths.size()) {
+                first = i;
+            }
+        }
+
+        //Assert that one of the same two files is a copy of the other 
+        assert(the_gerp.numAliases == 1);
+        assert(the_gerp.aliases.size() == 1 and 
+               the_gerp.aliases.begin()->first == first);
+
+        //Assert that the bytes are compared once the hashes match 
+        assert(the_gerp.sameContents(first, "the same\n"));
+        assert(not the_gerp.sameContents(first, "the some\n"));
+        the_gerp.contentFiles[42] = first;
+        assert(not the_gerp.isDuplicate(other, 42, "the other\n"));
+        assert(the_gerp.numAliases == 1);
+
+        //Assert that the copy's lines are in the stored counts, so they 
+        //are still used 
+        assert(the_gerp.copiesCounted);
+        assert(the_gerp.copyWords["same"].lines == 1 and 
+               the_gerp.copyKeys["the"].files == 1);
+        istringstream queries("@count the\n@count @i SAME\n@q\n");
+        the_gerp.handleQuery(queries);
+    }
+
+    ifstream results(output);
+    string text((istreambuf_iterator<char>(results)), 
+                istreambuf_iterator<char>());
+    assert(text == "the: 3 lines in 3 files\nSAME: 2 lines in 2 files\n");
+
+    unlink(output.c_str());
+    unlink((root + "/a.txt").c_str());
+    unlink((root + "/b.txt").c_str());
+    unlink((root + "/c.txt").c_str());
+    rmdir(root.c_str());
+}
+
+//Testing getDiagnostics by inserting two case variants of one key and one
+//other key and ensuring that keys, variants, and locations are counted
+//separately from numItemsInTable
+void getDiagnosticsTest() {
+
+    hashTable table;
+
+    table.insert("the", 1, 1);
+    table.insert("The", 1, 2);
+    table.insert("the", 2, 5);
+    table.insert("dog", 1, 1);
+
+    hashTable::Diagnostics stats = table.getDiagnostics(nullptr);
+
+    //Assert that the counts match what was inserted
+    assert(stats.numBuckets == 100);
+    assert(stats.numKeys == 2);
+    assert(stats.numVariants == 3);
+    assert(stats.numPostings == 4);
+    assert(stats.numItemsInTable == 3);
+
+    //Assert that one key has 2 variants and one key has 1 variant
+    assert(stats.variantsPerKey.at(1) == 1);
+    assert(stats.variantsPerKey.at(2) == 1);
+
+    //Assert that the two length-1 postings and one length-2 posting are
+    //counted in the log2 histogram
+    assert(stats.postingLengths.at(0) == 2);
+    assert(stats.postingLengths.at(1) == 1);
+
+    //Assert that a variant whose locations were moved out of its vector is
+    //counted with the length it is given
+    hashTable::Diagnostics moved = table.getDiagnostics(
+        [](const WordLocations &entry) {
+            return entry.word == "The" ? (size_t) 40 : entry.location.size();
+        });
+    assert(moved.numPostings == 43);
+    assert(moved.postingLengths.at(0) == 1);
+    assert(moved.postingLengths.at(5) == 1);
+
+    //Assert that the bytes of the moved locations are counted apart 
+    moved = table.getDiagnostics(nullptr, [](const WordLocations &entry) {
+        return entry.word == "The" ? (size_t) 100 : (size_t) 0;
+    });
+    assert(moved.movedBytes == 100 and moved.numPostings == 4);
+}
+
+//Testing buildDenseWords by indexing a word on every line of a long file 
+//and one on every line of a short file, and ensuring that only the long 
+//list becomes a bitmap, which is smaller than its vector was 
+void denseWordsTest() {
+
+    string root = "/tmp/gerp_dense_test." + to_string(getpid());
+    mkdir(root.c_str(), 0700);
+    {
+        ofstream many(root + "/many.txt");
+        for (int i = 0; i < 500; i++) {
+            many << "the line\n";
+        }
+        ofstream few(root + "/few.txt");
+        for (int i = 0; i < 11; i++) {
+            few << "Few\n";
+        }
+    }
+
+    {
+        gerp the_gerp(root, root + ".out");
+        string common = "the", rare = "Few";
+        const WordLocations *the = the_gerp.table.findSensitiveWord(common);
+        const WordLocations *few = the_gerp.table.findSensitiveWord(rare);
+
+        //Assert that the short list keeps its vector, though it is on 
+        //more than one line in 64 
+        assert(the_gerp.denseWords.count(the) == 1);
+        assert(the_gerp.denseWords.count(few) == 0);
+        assert(few->location.size() == 11);
+        assert(the_gerp.denseWords[the].cardinality() == 500);
+        assert(the_gerp.denseWords[the].bytes() < 500 * sizeof(Instance));
+    }
+
+    unlink((root + ".out").c_str());
+    unlink((root + "/many.txt").c_str());
+    unlink((root + "/few.txt").c_str());
+    rmdir(root.c_str());
+}
+
+//Testing getTopKeys by inserting more keys than the heap keeps and 
+//ensuring occurrences count repeats on a line, the keys that rise past 
+//others are kept, and the keys come out with the most occurrences first 
+void getTopKeysTest() {
+
+    hashTable table;
+
+    //"the" twice on one line and "The" once, then one key per line with 
+    //fewer occurrences the later it comes 
+    table.insert("the", 1, 1);
+    table.insert("the", 1, 1);
+    table.insert("The", 1, 2);
+    for (size_t i = 0; i < 2 * hashTable::TOP_KEYS; i++) {
+        string key = "k" + to_string(i);
+        for (size_t j = 0; j < 2 * hashTable::TOP_KEYS - i; j++) {
+            table.insert(key, 2, j + 1);
+        }
+    }
+
+    //"late" comes last, but passes every other key 
+    for (size_t j = 0; j < 3 * hashTable::TOP_KEYS; j++) {
+        table.insert("late", 3, j / 2 + 1);
+    }
+
+    //Assert that occurrences count the repeat but locations do not 
+    string word = "the";
+    const hashTable::Node *node = table.findInsensitiveWord(word);
+    assert(node->occurrences == 3);
+    assert(node->numLines == 2);
+    assert(node->entries.at(0).occurrences == 2);
+    assert(node->entries.at(0).location.size() == 1);
+
+    //Assert that the most frequent keys come out in order, with "late" 
+    //first and the keys it passed pushed down 
+    vector<const hashTable::Node *> nodes;
+    table.getTopKeys(nodes);
+    assert(nodes.size() == hashTable::TOP_KEYS);
+    assert(nodes.at(0)->key == "late");
+    for (size_t i = 1; i < nodes.size(); i++) {
+        assert(nodes.at(i)->key == "k" + to_string(i - 1));
+        assert(nodes.at(i)->occurrences == 2 * hashTable::TOP_KEYS - i + 1);
+    }
+}
+
+
+//Testing that an Instance packs and unpacks its file and line numbers and
+//that packed Instances order by file before line
+void packedLocationTest() {
+
+    Instance first(2, 500);
+    Instance second(3, 1);
+
+    assert(first.file_path_index() == 2);
+    assert(first.lineNum() == 500);
+    assert(first < second);
+}
+
+
+//Testing that an Instance that does not fit in the configured bits throws
+//instead of wrapping around, and that the inserts the build makes pass the
+//error on rather than storing a wrapped location 
+void packedLocationOverflowTest() {
+
+    bool thrown = false;
+
+    try {
+        Instance tooBig(0, (size_t) Instance::MAX_LINE + 1);
+    } catch (const runtime_error &e) {
+        thrown = true;
+    }
+
+    assert(thrown);
+
+    //Assert that the largest location still fits 
+    Instance largest(Instance::MAX_FILE, Instance::MAX_LINE);
+    assert(largest.file_path_index() == Instance::MAX_FILE and 
+           largest.lineNum() == Instance::MAX_LINE);
+
+    //Assert that a file number past the last one fails the hashTable and 
+    //the spimiBuilder, which build the index 
+    hashTable table;
+    spimiBuilder builder;
+    builder.start(0, "/tmp");
+    size_t tooManyFiles = (size_t) Instance::MAX_FILE + 1;
+    for (int into = 0; into < 2; into++) {
+        thrown = false;
+        try {
+            if (into == 0) {
+                table.insert("word", tooManyFiles, 1);
+            } else {
+                builder.insert("word", tooManyFiles, 1);
+            }
+        } catch (const runtime_error &e) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    KeyType word = "word";
+    assert(table.findSensitiveWord(word) == nullptr);
+}
+
+
+//Testing sortLocations by sorting out of order locations and ensuring they
+//come back ordered by file and then by line
+void sortLocationsTest() {
+
+    vector<Instance> locations;
+    locations.push_back(Instance(7, 2));
+    locations.push_back(Instance(1, 900));
+    locations.push_back(Instance(7, 1));
+    locations.push_back(Instance(1, 3));
+
+    sortLocations(locations);
+
+    assert(locations.at(0) == Instance(1, 3));
+    assert(locations.at(1) == Instance(1, 900));
+    assert(locations.at(2) == Instance(7, 1));
+    assert(locations.at(3) == Instance(7, 2));
+}
+
+
+//Testing unionLocations by merging three sorted lists which share some
+//locations and ensuring the result is sorted with no repeated locations
+void unionLocationsTest() {
+
+    vector<Instance> a, b, c;
+    a.push_back(Instance(1, 1));
+    a.push_back(Instance(2, 4));
+    b.push_back(Instance(1, 1));
+    b.push_back(Instance(1, 5));
+    c.push_back(Instance(2, 4));
+    c.push_back(Instance(3, 1));
+
+    vector<const vector<Instance> *> lists;
+    lists.push_back(&a);
+    lists.push_back(&b);
+    lists.push_back(&c);
+
+    vector<Instance> merged = unionLocations(lists);
+
+    assert(merged.size() == 4);
+    assert(merged.at(0) == Instance(1, 1));
+    assert(merged.at(1) == Instance(1, 5));
+    assert(merged.at(2) == Instance(2, 4));
+    assert(merged.at(3) == Instance(3, 1));
+
+    //Assert that the largest location is kept, even as the first one 
+    Instance largest(Instance::MAX_FILE, Instance::MAX_LINE);
+    Instance out[2];
+    assert(mergeLocations(&largest, 1, &largest, 1, out) == 1);
+    assert(out[0] == largest);
+}
+
+
+//Testing PostingCursor by streaming two lists that share a location and
+//ensuring results come out in order, once each, and that skip and restart
+//move the cursor correctly
+void postingCursorTest() {
+
+    vector<Instance> lower, upper;
+    lower.push_back(Instance(1, 2));
+    lower.push_back(Instance(3, 4));
+    upper.push_back(Instance(1, 2));
+    upper.push_back(Instance(2, 1));
+
+    vector<const vector<Instance> *> lists;
+    lists.push_back(&lower);
+    lists.push_back(&upper);
+    PostingCursor cursor(lists);
+
+    Instance location;
+    assert(cursor.next(location) and location == Instance(1, 2));
+    assert(cursor.next(location) and location == Instance(2, 1));
+    assert(cursor.position() == 2);
+
+    //Skip past the last result and ensure the cursor is done
+    assert(cursor.skip(5) == 1);
+    assert(cursor.done());
+    assert(not cursor.next(location));
+
+    //Restart and ensure the first result comes back
+    cursor.restart();
+    assert(cursor.next(location) and location == Instance(1, 2));
+}
+
+
+//Testing rankByFile by ranking results where the second file has the most
+//lines and ensuring its lines come first, still in line order
+void postingCursorRankTest() {
+
+    vector<Instance> locations;
+    locations.push_back(Instance(1, 1));
+    locations.push_back(Instance(2, 3));
+    locations.push_back(Instance(2, 8));
+
+    vector<const vector<Instance> *> lists;
+    lists.push_back(&locations);
+    PostingCursor cursor(lists);
+    cursor.rankByFile();
+
+    Instance location;
+    assert(cursor.next(location) and location == Instance(2, 3));
+    assert(cursor.next(location) and location == Instance(2, 8));
+    assert(cursor.next(location) and location == Instance(1, 1));
+    assert(cursor.done());
+}
+
+
+//Testing that insert keeps line and file counts for each word and each Node
+//by inserting variants that share a line and ensuring the shared line is
+//only counted once for the Node
+void lineAndFileCountsTest() {
+
+    hashTable table;
+
+    table.insert("the", 1, 1);
+    table.insert("The", 1, 1);
+    table.insert("the", 1, 4);
+    table.insert("the", 1, 4);
+    table.insert("THE", 3, 2);
+
+    string lower = "the";
+    const WordLocations *entry = table.findSensitiveWord(lower);
+    const hashTable::Node *node = table.findInsensitiveWord(lower);
+
+    //Assert the counts of the exact word "the"
+    assert(entry->location.size() == 2);
+    assert(entry->numFiles == 1);
+
+    //Assert the counts of every variation: lines (1,1), (1,4), (3,2)
+    assert(node->numLines == 3);
+    assert(node->numFiles == 2);
+}
+
+
+//Testing threadPool by running more tasks than threads and ensuring every
+//task ran exactly once before run returned
+void threadPoolRunTest() {
+
+    threadPool pool(4);
+    vector<int> ran(100, 0);
+
+    pool.run(ran.size(), [&](size_t task) {
+        ran.at(task)++;
+    });
+
+    for (size_t i = 0; i < ran.size(); i++) {
+        assert(ran.at(i) == 1);
+    }
+}
+
+
+//Testing that an exception thrown by a task is rethrown by run
+void threadPoolExceptionTest() {
+
+    threadPool pool(4);
+    bool thrown = false;
+
+    try {
+        pool.run(10, [](size_t task) {
+            if (task == 7) {
+                throw runtime_error("task failed");
+            }
+        });
+    } catch (const runtime_error &e) {
+        thrown = true;
+    }
+
+    assert(thrown);
+}
+
+
+//Testing dirWalker on a directory with one file in it and ensuring the file
+//is visited once with the directory name at the front of its path
+void dirWalkerTest() {
+
+    //dir is a directory with one file in it
+    pathTable table;
+    dirWalker walker("dir", table);
+
+    assert(walker.next());
+    assert(walker.path() == "dir/" + walker.name());
+
+    //Assert that the directory was added to the path table
+    assert(table.numDirectories() == 1);
+    assert(walker.directory() == 0);
+
+    int fd = walker.openFile();
+    assert(fd >= 0);
+    close(fd);
+
+    assert(not walker.next());
+}
+
+
+//Testing dirWalker on a tree deeper than it keeps descriptors open for, 
+//with a file and a second subdirectory at each level, and ensuring every 
+//file is still found and opened 
+void dirWalkerDeepTest() {
+
+    const size_t depth = 40;
+    string root = "/tmp/gerp_deep_test." + to_string(getpid());
+    vector<string> files, directories;
+    string path = root;
+    for (size_t i = 0; i < depth; i++) {
+        mkdir(path.c_str(), 0700);
+        directories.push_back(path);
+        mkdir((path + "/side").c_str(), 0700);
+        directories.push_back(path + "/side");
+        files.push_back(path + "/f.txt");
+        files.push_back(path + "/side/g.txt");
+        path += "/down";
+    }
+    for (size_t i = 0; i < files.size(); i++) {
+        ofstream(files[i]) << "word\n";
+    }
+
+    //Assert that every file is handed out once and can be opened 
+    pathTable table;
+    size_t found = 0;
+    {
+        dirWalker walker(root, table);
+        while (walker.next()) {
+            int fd = walker.openFile();
+            assert(fd >= 0);
+            close(fd);
+            found++;
+        }
+    }
+    assert(found == files.size());
+    assert(table.numDirectories() == directories.size());
+
+    for (size_t i = 0; i < files.size(); i++) {
+        unlink(files[i].c_str());
+    }
+    for (size_t i = directories.size(); i > 0; i--) {
+        rmdir(directories[i - 1].c_str());
+    }
+}
+
+
+//Testing pathTable by adding files in nested directories and ensuring each
+//full path is rebuilt from its directories
+void pathTableTest() {
+
+    pathTable table;
+
+    size_t root = table.addDirectory(pathTable::NO_PARENT, "/comp/15");
+    size_t inner = table.addDirectory(root, "files");
+    size_t first = table.addFile(root, "a.txt");
+    size_t second = table.addFile(inner, "b.txt");
+
+    assert(table.size() == 2);
+    assert(table.path(first) == "/comp/15/a.txt");
+    assert(table.path(second) == "/comp/15/files/b.txt");
+
+    //Assert that appendPath adds to the end of the buffer
+    string buffer = "> ";
+    table.appendPath(second, buffer);
+    assert(buffer == "> /comp/15/files/b.txt");
+}
+
+
+//Testing findDirectory and fileRange by adding directories and files in
+//depth first order and ensuring each directory's files have a contiguous
+//range of file numbers
+void pathTableDirectoryRangeTest() {
+
+    pathTable table;
+
+    size_t root = table.addDirectory(pathTable::NO_PARENT, "files");
+    table.addFile(root, "a.txt");
+    size_t inner = table.addDirectory(root, "inner");
+    table.addFile(inner, "b.txt");
+    table.addFile(inner, "c.txt");
+    table.finishDirectory(inner);
+    size_t other = table.addDirectory(root, "other");
+    table.addFile(other, "d.txt");
+    table.finishDirectory(other);
+    table.finishDirectory(root);
+
+    size_t found = 0, first = 0, end = 0;
+
+    //Assert that both relative and full paths find the directory
+    assert(table.findDirectory("inner/", found) and found == inner);
+    assert(table.findDirectory("files/inner", found) and found == inner);
+    assert(not table.findDirectory("missing", found));
+
+    //Assert that inner holds files 1 and 2 and the root holds all 4
+    table.fileRange(inner, first, end);
+    assert(first == 1 and end == 3);
+    table.fileRange(root, first, end);
+    assert(first == 0 and end == 4);
+
+    //Assert that files added later to a finished directory, or to a new one
+    //under it, are kept in later ranges of it and of the root 
+    assert(table.addDirectoryPath("files/inner") == inner);
+    table.addFile(inner, "e.txt");
+    size_t added = table.addDirectoryPath("files/inner/new/deeper");
+    assert(table.findDirectory("inner/new/deeper", found) and found == added);
+    table.addFile(added, "f.txt");
+    table.addFile(other, "g.txt");
+    assert(table.path(5) == "files/inner/new/deeper/f.txt");
+    assert(table.laterRanges(inner).size() == 1);
+    assert(table.laterRanges(inner)[0] == make_pair((size_t) 4, (size_t) 6));
+    assert(table.laterRanges(root).size() == 1);
+    assert(table.laterRanges(root)[0] == make_pair((size_t) 4, (size_t) 7));
+    assert(table.laterRanges(other)[0] == make_pair((size_t) 6, (size_t) 7));
+    table.fileRange(added, first, end);
+    assert(first == end);
+}
+
+
+//Testing restrictFiles by limiting a cursor to the middle file and
+//ensuring only that file's locations are returned
+void postingCursorRestrictTest() {
+
+    vector<Instance> locations;
+    locations.push_back(Instance(1, 1));
+    locations.push_back(Instance(2, 3));
+    locations.push_back(Instance(2, 8));
+    locations.push_back(Instance(3, 1));
+
+    vector<const vector<Instance> *> lists;
+    lists.push_back(&locations);
+    PostingCursor cursor(lists);
+    cursor.restrictFiles(2, 3);
+
+    Instance location;
+    assert(cursor.next(location) and location == Instance(2, 3));
+    assert(cursor.next(location) and location == Instance(2, 8));
+    assert(cursor.done());
+
+    //Assert that restart goes back to the start of the range
+    cursor.restart();
+    assert(cursor.next(location) and location == Instance(2, 3));
+}
+
+
+//Testing lineIndex by recording the lines of a small file and ensuring 
+//each line is read back without its newline
+void lineIndexTest() {
+
+    string path = "/tmp/gerp_line_index_test.txt";
+    ofstream file(path);
+    file << "first line\nsecond\nno newline";
+    file.close();
+
+    lineIndex lines;
+    size_t index = 0;
+    lines.addFile(index);
+    lines.addLine(index, 0);
+    lines.addLine(index, 11);
+    lines.addLine(index, 18);
+    lines.finishFile(index, 28);
+    assert(lines.numLines(index) == 3);
+
+    int fd = open(path.c_str(), O_RDONLY);
+    string text;
+    assert(lines.readLine(fd, index, 2, text) and text == "second");
+    assert(lines.readLine(fd, index, 3, text) and text == "no newline");
+    assert(lines.readLine(fd, index, 1, text) and text == "first line");
+
+    //Assert that lines past the end are not read
+    assert(not lines.readLine(fd, index, 4, text));
+    close(fd);
+    remove(path.c_str());
+}
+
+
+//Testing lineIndex by reading runs of lines at once, as @ctx does, and 
+//ensuring each run keeps the newlines between its lines 
+void lineIndexReadLinesTest() {
+
+    string path = "/tmp/gerp_line_index_runs_test.txt";
+    ofstream file(path);
+    file << "first line\nsecond\nno newline";
+    file.close();
+
+    lineIndex lines;
+    size_t index = 0;
+    lines.addFile(index);
+    lines.addLine(index, 0);
+    lines.addLine(index, 11);
+    lines.addLine(index, 18);
+    lines.finishFile(index, 28);
+
+    int fd = open(path.c_str(), O_RDONLY);
+    string text;
+    assert(lines.readLines(fd, index, 1, 2, text) and 
+           text == "first line\nsecond\n");
+    assert(lines.readLines(fd, index, 2, 3, text) and 
+           text == "second\nno newline");
+    assert(lines.readLines(fd, index, 3, 3, text) and text == "no newline");
+
+    //Assert that runs past the end or backwards are not read
+    assert(not lines.readLines(fd, index, 2, 4, text));
+    assert(not lines.readLines(fd, index, 3, 2, text));
+    close(fd);
+    remove(path.c_str());
+}
+
+
+//Testing trigramIndex by adding a few lines and ensuring only the lines
+//with every trigram of a literal are candidates, regardless of case
+void trigramIndexTest() {
+
+    trigramIndex trigrams;
+    string lines[3] = {"The General License", "generally fine", "licensed"};
+    for (size_t i = 0; i < 3; i++) {
+        trigrams.addLine(lines[i].data(), lines[i].length(), 
+                         Instance(0, i + 1));
+    }
+
+    vector<Instance> found;
+    vector<string> literals;
+    literals.push_back("GENERAL");
+    assert(trigrams.candidates(literals, found));
+    assert(found.size() == 2);
+    assert(found[0] == Instance(0, 1) and found[1] == Instance(0, 2));
+
+    //Assert that two literals give the lines that have both
+    literals.push_back("licen");
+    assert(trigrams.candidates(literals, found));
+    assert(found.size() == 1 and found[0] == Instance(0, 1));
+
+    //Assert that a literal too short for a trigram gives no filter
+    literals.clear();
+    literals.push_back("li");
+    assert(not trigrams.candidates(literals, found));
+
+    //Assert that the required literals of a regular expression skip the
+    //optional and variable parts, and alternation gives none
+    vector<string> required = 
+        trigramIndex::requiredLiterals("abcd*ef[gh]ijkl");
+    assert(required.size() == 2);
+    assert(required[0] == "abc" and required[1] == "ijkl");
+    assert(trigramIndex::requiredLiterals("license|copy").empty());
+
+    //Assert that a code escape ends the run with its digits, and that a
+    //')' in a class does not close the group around it 
+    required = trigramIndex::requiredLiterals("\\x41bcdef");
+    assert(required.size() == 1 and required[0] == "bcdef");
+    required = trigramIndex::requiredLiterals("(a[)]b)cdef\\u0041xyz");
+    assert(required.size() == 2);
+    assert(required[0] == "cdef" and required[1] == "xyz");
+
+    //Assert that searching only the lines with every required literal 
+    //finds the same lines as searching all of them 
+    const char *patterns[] = {
+        "\\x41bcdef", "\\u0041bcd", "\\cJabc", "\\0abc", "(a)\\1bcd",
+        "[]a]bcd", "[^]]abc", "(a[)]b)cdef", "[(]abc", "ab\\.cd?ef", 
+        "abc{2}def", "abc+def", "a*?bcde", "x\\d+yzw", "\\bthe\\b end" 
+    };
+    const char *subjects[] = {
+        "Abcdef", "Abcd", "\nabc", "a]bcd", "]abc", "xabc", "a)bcdef", 
+        "abcdef", "(abc", "ab.cef", "ab.cdef", "abccdef", "abcdef", 
+        "abcccdef", "aaabcde", "x12yzw", "the end", "bcdef", "cdef" 
+    };
+    for (const char *pattern : patterns) {
+        regex compiled(pattern, regex::ECMAScript);
+        required = trigramIndex::requiredLiterals(pattern);
+        for (const char *subject : subjects) {
+            string text = subject;
+            bool pruned = true;
+            for (size_t i = 0; i < required.size(); i++) {
+                pruned = pruned and text.find(required[i]) != string::npos;
+            }
+            assert((pruned and regex_search(text, compiled)) == 
+                   regex_search(text, compiled));
+        }
+    }
+}
+
+
+//Testing spimiBuilder and diskIndex by building an index with enough words
+//to need several runs and ensuring the merged index finds every location 
+//of a word across the runs, with its case variants under one key
+void spimiBuilderDiskIndexTest() {
+
+    spimiBuilder builder;
+    builder.start(0, "/tmp");
+
+    //each file has "the" twice on line 1 and "The" on line 2, plus enough
+    //other words to go over the smallest budget a few times
+    for (size_t file = 0; file < 2000; file++) {
+        builder.insert("the", file, 1);
+        builder.insert("the", file, 1);
+        builder.insert("The", file, 2);
+        for (size_t word = 0; word < 20; word++) {
+            builder.insert("w" + to_string(file * 20 + word), file, 3);
+        }
+    }
+    string path = builder.finish();
+    assert(builder.numRuns() > 1);
+
+    diskIndex index;
+    index.open(path);
+
+    //Assert that the case sensitive word has one location per file
+    const diskIndex::WordEntry *the = index.findWord("the");
+    assert(the != nullptr and the->numLocations == 2000);
+    assert(the->numFiles == 2000);
+    LocationList list = index.locations(*the);
+    for (size_t i = 0; i < list.size; i++) {
+        assert(list.data[i] == Instance(i, 1));
+    }
+
+    //Assert that the key counts the distinct lines of both variants
+    const diskIndex::KeyEntry *key = index.findKey("THE");
+    assert(key != nullptr and key->numWords == 2);
+    assert(key->numLines == 4000 and key->numFiles == 2000);
+
+    //Assert that missing words and cases are not found
+    assert(index.findWord("THE") == nullptr);
+    assert(index.findKey("missing") == nullptr);
+    assert(index.findWord("w39999") != nullptr);
+}
+
+
+//Testing the key directory of diskIndex by building an index with keys on 
+//both sides of every stride boundary, and ensuring each key is found, 
+//words between and around the keys are not, and the hot keys come first 
+void diskIndexDirectoryTest() {
+
+    spimiBuilder builder;
+    builder.start(0, "/tmp");
+
+    //keys k000 to k999 (in sorted order), with k500 on the most lines 
+    for (size_t i = 0; i < 1000; i++) {
+        string number = to_string(i);
+        string key = "k" + string(3 - number.length(), '0') + number;
+        builder.insert(key, i, 1);
+        if (i == 500) {
+            for (size_t line = 2; line < 100; line++) {
+                builder.insert(key, i, line);
+            }
+        }
+    }
+    string path = builder.finish();
+
+    diskIndex index;
+    index.open(path);
+    assert(index.numKeys() == 1000);
+
+    //Assert that every key is found, in any case 
+    for (size_t i = 0; i < 1000; i++) {
+        string number = to_string(i);
+        string key = "K" + string(3 - number.length(), '0') + number;
+        const diskIndex::KeyEntry *found = index.findKey(key);
+        assert(found == index.keyAt(i));
+    }
+
+    //Assert that words before, between, and after the keys are not 
+    assert(index.findKey("a") == nullptr);
+    assert(index.findKey("k") == nullptr);
+    assert(index.findKey("k0640") == nullptr);
+    assert(index.findKey("k9999") == nullptr);
+    assert(index.findKey("z") == nullptr);
+
+    //Assert that the key on the most lines is the hottest 
+    assert(index.header->numHot == diskIndex::HOT_KEYS);
+    assert(index.hotKeys[0] == 500);
+
+    //Assert that prefetching changes nothing that is read 
+    index.prefetchHot();
+    const diskIndex::WordEntry *word = index.findWord("k500");
+    assert(word != nullptr and word->numLocations == 99);
+    index.prefetch(index.locations(*word));
+    assert(index.locations(*word).data[98] == Instance(500, 99));
+}
+
+
+//Testing indexSegment by freezing a table and merging two segments, and 
+//ensuring words are found with and without case sensitivity
+void indexSegmentTest() {
+
+    hashTable first, second;
+    first.insert("the", 0, 1);
+    first.insert("The", 0, 2);
+    first.insert("cat", 1, 1);
+    second.insert("the", 2, 5);
+    second.insert("dog", 3, 1);
+
+    shared_ptr<const indexSegment> a = 
+        make_shared<const indexSegment>(first, 0, 2);
+    shared_ptr<const indexSegment> b = 
+        make_shared<const indexSegment>(second, 2, 4);
+
+    vector<LocationList> lists;
+    size_t lines = 0, files = 0;
+
+    //Assert that a frozen table finds exact words and all of their cases
+    assert(a->find("the", false, lists, lines, files));
+    assert(lists.size() == 1 and lines == 1 and files == 1);
+    lists.clear();
+    assert(a->find("THE", true, lists, lines, files));
+    assert(lists.size() == 2 and lines == 2 and files == 1);
+    lists.clear();
+    assert(not a->find("dog", true, lists, lines, files));
+
+    //Assert that a merged segment appends locations in file order
+    vector<shared_ptr<const indexSegment>> parts;
+    parts.push_back(b);
+    parts.push_back(a);
+    indexSegment merged(parts);
+    assert(merged.firstFile() == 0 and merged.endFile() == 4);
+    assert(merged.numLocations() == 5);
+    lists.clear();
+    assert(merged.find("the", false, lists, lines, files));
+    assert(lists.size() == 1 and lines == 2 and files == 2);
+    assert(lists[0].data[0] == Instance(0, 1));
+    assert(lists[0].data[1] == Instance(2, 5));
+    lists.clear();
+    assert(merged.find("dog", false, lists, lines, files) and lines == 1);
+}
+
+
+//Testing segmentSet by adding many small segments, ensuring they are 
+//merged into the head, and then many segments in the lowest tier, ensuring
+//the background thread merges them without losing any locations
+void segmentSetCompactionTest() {
+
+    segmentSet set;
+    for (size_t file = 0; file < 16; file++) {
+        hashTable table;
+        table.insert("word", file, 1);
+        set.add(make_shared<const indexSegment>(table, file, file + 1));
+    }
+
+    //Assert that the small segments became one head, without a merge 
+    assert(set.numSegments() == 1 and set.numCompactions() == 0);
+    assert(set.snapshot()[0]->firstFile() == 0 and 
+           set.snapshot()[0]->endFile() == 16);
+
+    //each of these fills the lowest tier, so none is merged into the head 
+    for (size_t file = 16; file < 32; file++) {
+        hashTable table;
+        for (size_t line = 1; line <= segmentSet::BASE_SIZE; line++) {
+            table.insert("word", file, line);
+        }
+        set.add(make_shared<const indexSegment>(table, file, file + 1));
+    }
+    set.waitForCompaction();
+
+    //Assert that 16 segments in the lowest tier were merged
+    assert(set.numCompactions() > 0);
+    assert(set.numSegments() < segmentSet::TIER_FACTOR + 1);
+
+    //Assert that every location is still there, in order
+    vector<shared_ptr<const indexSegment>> current = set.snapshot();
+    size_t total = 0;
+    for (size_t i = 0; i < current.size(); i++) {
+        vector<LocationList> lists;
+        size_t lines = 0, files = 0;
+        assert(current[i]->find("word", false, lists, lines, files));
+        total += lines;
+        if (i > 0) {
+            assert(current[i - 1]->endFile() <= current[i]->firstFile());
+        }
+    }
+    assert(total == 16 + 16 * segmentSet::BASE_SIZE);
+}
+
+
+//Testing PostingCursor's forEach by visiting one list straight through 
+//(limited to a range of files) and a merge of two lists, and ensuring the 
+//results and position match what next would give, also when told to stop 
+void postingCursorForEachTest() {
+
+    vector<Instance> lower, upper;
+    lower.push_back(Instance(1, 2));
+    lower.push_back(Instance(2, 5));
+    lower.push_back(Instance(3, 4));
+    upper.push_back(Instance(1, 2));
+    upper.push_back(Instance(2, 1));
+
+    //Assert that one list gives the results in its range 
+    vector<const vector<Instance> *> lists;
+    lists.push_back(&lower);
+    PostingCursor single(lists);
+    single.restrictFiles(2, 4);
+    vector<Instance> visited;
+    single.forEach([&](Instance location) {
+        visited.push_back(location);
+        return true;
+    });
+    assert(visited.size() == 2);
+    assert(visited[0] == Instance(2, 5) and visited[1] == Instance(3, 4));
+    assert(single.done() and single.position() == 2);
+
+    //Assert that stopping leaves the cursor after the last result visited 
+    PostingCursor stopped(lists);
+    visited.clear();
+    stopped.forEach([&](Instance location) {
+        visited.push_back(location);
+        return visited.size() < 2;
+    });
+    assert(visited.size() == 2 and stopped.position() == 2);
+    Instance after;
+    assert(stopped.next(after) and after == Instance(3, 4));
+
+    //Assert that two lists are merged without the repeated line 
+    lists.push_back(&upper);
+    PostingCursor merged(lists);
+    Instance first;
+    assert(merged.next(first) and first == Instance(1, 2));
+    visited.clear();
+    merged.forEach([&](Instance location) {
+        visited.push_back(location);
+        return true;
+    });
+    assert(visited.size() == 3 and visited[0] == Instance(2, 1));
+    assert(merged.done() and merged.position() == 4);
+}
+
+
+//Testing PostingCursor's skipFiles by marking a file as deleted and 
+//ensuring its locations are skipped by next, nextFile, and skip
+void postingCursorSkipFilesTest() {
+
+    vector<Instance> locations;
+    locations.push_back(Instance(1, 1));
+    locations.push_back(Instance(2, 3));
+    locations.push_back(Instance(2, 8));
+    locations.push_back(Instance(3, 1));
+
+    vector<bool> dead(3, false);
+    dead[2] = true;
+
+    vector<const vector<Instance> *> lists;
+    lists.push_back(&locations);
+    PostingCursor cursor(lists);
+    cursor.skipFiles(&dead);
+
+    Instance location;
+    assert(cursor.next(location) and location == Instance(1, 1));
+    assert(cursor.next(location) and location == Instance(3, 1));
+    assert(cursor.done());
+
+    //Assert that skip steps over the deleted file too
+    cursor.restart();
+    assert(cursor.skip(1) == 1);
+    assert(cursor.next(location) and location == Instance(3, 1));
+
+    //Assert that files are listed without the deleted one
+    cursor.restart();
+    size_t file = 0;
+    assert(cursor.nextFile(file) and file == 1);
+    assert(cursor.nextFile(file) and file == 3);
+    assert(not cursor.nextFile(file));
+}
+
+//Testing corpusWatcher by writing and deleting files in a watched 
+//directory and ensuring each batch reports them
+void corpusWatcherTest() {
+
+    string directory = "/tmp/gerp_watcher_test";
+    mkdir(directory.c_str(), 0755);
+    unlink((directory + "/a.txt").c_str());
+
+    mutex lock;
+    vector<string> changed, deleted;
+    corpusWatcher watcher;
+    watcher.start(vector<string>(1, directory), 
+                  [&](const vector<string> &c, const vector<string> &d) {
+                      lock_guard<mutex> guard(lock);
+                      changed.insert(changed.end(), c.begin(), c.end());
+                      deleted.insert(deleted.end(), d.begin(), d.end());
+                  });
+
+    ofstream file(directory + "/a.txt");
+    file << "hello\n";
+    file.close();
+    usleep(corpusWatcher::BATCH_MILLISECONDS * 4000);
+
+    //Assert that the written file was reported as changed
+    {
+        lock_guard<mutex> guard(lock);
+        assert(changed.size() == 1 and 
+               changed[0] == directory + "/a.txt");
+    }
+
+    unlink((directory + "/a.txt").c_str());
+    usleep(corpusWatcher::BATCH_MILLISECONDS * 4000);
+
+    //Assert that the deleted file was reported as deleted
+    {
+        lock_guard<mutex> guard(lock);
+        assert(deleted.size() == 1 and deleted[0] == directory + "/a.txt");
+        assert(watcher.numBatches() == 2);
+    }
+
+    //move a new directory out of the tree, then write a file in it 
+    string moved = "/tmp/gerp_watcher_moved";
+    mkdir((directory + "/sub").c_str(), 0755);
+    usleep(corpusWatcher::BATCH_MILLISECONDS * 4000);
+    rename((directory + "/sub").c_str(), moved.c_str());
+    usleep(corpusWatcher::BATCH_MILLISECONDS * 4000);
+    ofstream(moved + "/b.txt") << "hello\n";
+    usleep(corpusWatcher::BATCH_MILLISECONDS * 4000);
+    watcher.stop();
+
+    //Assert that the directory was reported as deleted and is no longer 
+    //watched under its old path 
+    assert(deleted.size() == 2 and deleted[1] == directory + "/sub");
+    assert(changed.size() == 1);
+    unlink((moved + "/b.txt").c_str());
+    rmdir(moved.c_str());
+    rmdir(directory.c_str());
+}
+
+//Testing bloomFilter by adding words and keys and ensuring every one is 
+//found while few words that were never added are
+void bloomFilterTest() {
+
+    bloomFilter filter;
+    assert(filter.mayContain("anything", false));
+
+    filter.reset(2000);
+    for (int i = 0; i < 500; i++) {
+        string word = "Word" + to_string(i);
+        string key = "key" + to_string(i);
+        filter.add(word.data(), word.length(), false);
+        filter.add(key.data(), key.length(), true);
+    }
+
+    //Assert that every word and key is found, keys regardless of case
+    for (int i = 0; i < 500; i++) {
+        assert(filter.mayContain("Word" + to_string(i), false));
+        assert(filter.mayContain("KEY" + to_string(i), true));
+    }
+
+    //Assert that few other words are found
+    size_t found = 0;
+    for (int i = 0; i < 10000; i++) {
+        if (filter.mayContain("Missing" + to_string(i), false) or 
+            filter.mayContain("missing" + to_string(i), true)) {
+            found++;
+        }
+    }
+    assert(found < 500);
+}
+
+//Testing roaringBitmap by adding sparse and dense numbers, unioning two 
+//bitmaps, and ensuring the numbers come back once each in order
+void roaringBitmapTest() {
+
+    roaringBitmap sparse, dense;
+    sparse.add(3);
+    sparse.add(70000);
+    sparse.add(3);
+    for (uint32_t i = 0; i < 10000; i++) {
+        dense.add(i * 2);
+    }
+
+    //Assert that repeated numbers are only stored once
+    assert(sparse.cardinality() == 2);
+    assert(sparse.contains(70000) and not sparse.contains(4));
+
+    //Assert that a full container holds the same numbers as an array
+    assert(dense.cardinality() == 10000);
+    assert(dense.contains(19998) and not dense.contains(19999));
+
+    sparse.unionWith(dense);
+    assert(sparse.cardinality() == 10002);
+
+    //Assert that the numbers are visited in ascending order
+    vector<uint32_t> values;
+    sparse.forEach([&](uint32_t value) {
+        values.push_back(value);
+    });
+    assert(values.size() == 10002);
+    assert(is_sorted(values.begin(), values.end()));
+    assert(values[1] == 2 and values[2] == 3 and values.back() == 70000);
+}
+
+//Testing contentHash by hashing the same contents in different chunks and
+//ensuring only the contents (and not the chunks) change the hash
+void contentHashTest() {
+
+    string text = "the quick brown fox jumps over the lazy dog\n";
+    contentHash whole, pieces, other, longer;
+    whole.update(text.data(), text.length());
+    for (size_t i = 0; i < text.length(); i += 3) {
+        pieces.update(text.data() + i, min((size_t) 3, text.length() - i));
+    }
+
+    //Assert that the chunks do not change the hash
+    assert(whole.finish() == pieces.finish());
+
+    //Assert that different contents and lengths change the hash
+    string changed = text;
+    changed[5] = 'Q';
+    other.update(changed.data(), changed.length());
+    longer.update(text.data(), text.length());
+    longer.update("", 0);
+    longer.update("\0", 1);
+    assert(whole.finish() != other.finish());
+    assert(whole.finish() != longer.finish());
+    assert(whole.finish() == pieces.finish());
+}
+
+//Tests that fileFilter tells text from binary contents and applies the glob
+//patterns to names and paths
+void fileFilterTest() {
+
+    //Assert that text, UTF-8, and a little Latin-1 are not binary
+    string text = "the quick brown fox jumps over the lazy dog\n";
+    string utf8 = "na\xc3\xafve caf\xc3\xa9 \xe2\x82\xac" + text;
+    string latin1 = text + text + "caf\xe9\n";
+    assert(not fileFilter::looksBinary(text.data(), text.length()));
+    assert(not fileFilter::looksBinary(utf8.data(), utf8.length()));
+    assert(not fileFilter::looksBinary(latin1.data(), latin1.length()));
+
+    //Assert that a NUL byte or mostly invalid bytes are binary
+    string nul = text + '\0' + text;
+    string noise(64, '\xff');
+    assert(fileFilter::looksBinary(nul.data(), nul.length()));
+    assert(fileFilter::looksBinary(noise.data(), noise.length()));
+
+    //Assert that includes and excludes match names and whole paths
+    fileFilter filter;
+    filter.include("*.cpp");
+    filter.include("*.h");
+    filter.exclude("build/*");
+    filter.exclude(".git");
+    assert(filter.wantsFile("src/gerp.cpp", "gerp.cpp"));
+    assert(not filter.wantsFile("src/gerp.o", "gerp.o"));
+    assert(not filter.wantsFile("build/gerp.h", "gerp.h"));
+    assert(not filter.wantsDirectory("src/.git", ".git"));
+    assert(filter.wantsDirectory("src/lib", "lib"));
+    assert(not filter.checkName("src/gerp.o", "gerp.o"));
+    assert(filter.skippedByName() == 2);
+    assert(filter.skippedDirectories() == 1);
+}
+
+//Tests that fileReader hands back whole files in the order they were 
+//submitted, with the filter's verdicts, both with io_uring and with the 
+//pool of threads, and with room for only one file's contents at a time
+void fileReaderTest() {
+
+    string directory = "/tmp/gerp_reader_test";
+    mkdir(directory.c_str(), 0755);
+    string big(fileReader::FIRST_READ * 3 + 17, 'x');
+    for (size_t i = 0; i < big.length(); i += 100) {
+        big[i] = '\n';
+    }
+    ofstream(directory + "/big.txt") << big;
+    ofstream(directory + "/empty.txt").close();
+    ofstream(directory + "/small.txt") << "hello\n";
+    ofstream(directory + "/binary.o") << string("ELF\0\0\0", 6) << big;
+    unlink((directory + "/missing.txt").c_str());
+
+    fileFilter rules;
+    rules.setMaxBytes(fileReader::FIRST_READ * 4);
+    string names[] = {"big.txt", "empty.txt", "missing.txt", "binary.o", 
+                      "small.txt"};
+
+    for (int run = 0; run < 4; run++) {
+        //a depth of two makes the reader hand files back as it goes, and 
+        //one byte makes every file but the next wait for room 
+        size_t limit = (run < 2) ? fileReader::DEFAULT_BYTES : 1;
+        fileReader reader(2 + run, &rules, limit, run % 2 == 1);
+        vector<fileReader::File> files;
+        fileReader::File file;
+        size_t submitted = 0;
+        while (true) {
+            while (submitted < 5 and not reader.full()) {
+                reader.submit(directory + "/" + names[submitted++]);
+            }
+            if (not reader.next(file)) {
+                break;
+            }
+            files.push_back(file);
+
+            //Assert that no more than one file's room is held (the binary
+            //file's size is the largest) 
+            assert(limit > 1 or reader.heldBytes <= big.length() + 6);
+        }
+
+        //Assert that the files came back in order with their contents 
+        assert(files.size() == 5);
+        for (size_t i = 0; i < files.size(); i++) {
+            assert(files[i].path == directory + "/" + names[i]);
+        }
+        assert(files[0].contents == big and files[0].size == big.length());
+        assert(files[1].contents.empty() and files[1].opened);
+        assert(not files[2].opened);
+        assert(files[3].verdict == fileFilter::BINARY and 
+               files[3].contents.empty());
+        assert(files[4].contents == "hello\n");
+
+        //Assert that the device and inode came back with the file 
+        struct stat info;
+        assert(stat(files[4].path.c_str(), &info) == 0);
+        assert(files[4].device == info.st_dev and 
+               files[4].inode == info.st_ino);
+    }
+
+    //Assert that a file over the size limit is not read 
+    rules.setMaxBytes(100);
+    fileReader reader(4, &rules);
+    fileReader::File file;
+    reader.submit(directory + "/big.txt");
+    assert(reader.next(file) and file.verdict == fileFilter::TOO_BIG and 
+           file.contents.empty() and file.size == big.length());
+    assert(not reader.next(file));
+
+    //Assert that a file is read relative to its directory's descriptor 
+    int dirFd = open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    for (int ring = 0; ring < 2; ring++) {
+        fileReader byName(4, &rules, fileReader::DEFAULT_BYTES, ring == 1);
+        byName.submit(dirFd, "small.txt", "small");
+        assert(byName.next(file) and file.path == "small" and 
+               file.contents == "hello\n");
+    }
+    close(dirFd);
+
+    for (size_t i = 0; i < 5; i++) {
+        unlink((directory + "/" + names[i]).c_str());
+    }
+    rmdir(directory.c_str());
+}
+
+
+//Testing sharedIndex by saving a small index, mapping it again, and 
+//ensuring the words, paths, aliases and filter read from the mapping match 
+//what was saved, and that adding to a mapped path table copies it first 
+void sharedIndexTest() {
+
+    spimiBuilder builder;
+    builder.start(0, "/tmp");
+    builder.insert("the", 0, 1);
+    builder.insert("The", 1, 2);
+    builder.insert("cat", 1, 3);
+    string wordsFile = builder.finish();
+
+    pathTable table;
+    size_t root = table.addDirectory(pathTable::NO_PARENT, "/comp/15");
+    table.addFile(root, "a.txt");
+    size_t inner = table.addDirectory(root, "inner");
+    table.addFile(inner, "b.txt");
+    table.addFile(inner, "c.txt");
+    table.finishDirectory(inner);
+    table.finishDirectory(root);
+
+    bloomFilter filter;
+    filter.reset(100);
+    filter.add("cat", 3, false);
+
+    vector<uint64_t> pairs = {1, 2};
+    string path = "/tmp/gerp_shared_test." + to_string(getpid());
+    sharedIndex::save(path, wordsFile, table, pairs, filter);
+    unlink(wordsFile.c_str());
+
+    sharedIndex shared;
+    shared.open(path);
+    unlink(path.c_str());
+
+    //Assert that the words are found in the mapped index 
+    diskIndex disk;
+    disk.attach(shared.words().data, shared.words().length);
+    const diskIndex::WordEntry *the = disk.findWord("the");
+    assert(the != nullptr and the->numLocations == 1);
+    assert(disk.locations(*the).data[0] == Instance(0, 1));
+    const diskIndex::KeyEntry *key = disk.findKey("THE");
+    assert(key != nullptr and key->numWords == 2);
+    assert(disk.findWord("dog") == nullptr);
+
+    //Assert that an image whose counts run past its end is rejected 
+    size_t length = shared.words().length;
+    vector<uint64_t> damaged(length / sizeof(uint64_t) + 1);
+    memcpy(damaged.data(), shared.words().data, length);
+    ((diskIndex::Header *) damaged.data())->numWords = UINT64_MAX / 2;
+    bool thrown = false;
+    try {
+        diskIndex broken;
+        broken.attach((const char *) damaged.data(), length);
+    } catch (const runtime_error &e) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    //Assert that the paths, ranges and aliases are the same 
+    pathTable mapped;
+    mapped.attach(shared.paths().data, shared.paths().length);
+    assert(mapped.size() == 3 and mapped.bytes() == 0);
+    assert(mapped.path(2) == "/comp/15/inner/c.txt");
+    size_t found = 0, first = 0, end = 0;
+    assert(mapped.findDirectory("inner", found) and found == inner);
+    mapped.fileRange(inner, first, end);
+    assert(first == 1 and end == 3);
+    size_t numPairs = 0;
+    const uint64_t *aliases = shared.aliases(numPairs);
+    assert(numPairs == 1 and aliases[0] == 1 and aliases[1] == 2);
+
+    //Assert that the filter still finds its word 
+    bloomFilter mappedFilter;
+    mappedFilter.attach(shared.filter().data, shared.filter().length);
+    assert(mappedFilter.isBuilt() and mappedFilter.mayContain("cat", false));
+
+    //Assert that adding to the mapped table copies it and keeps the rest 
+    size_t added = mapped.addFile(inner, "d.txt");
+    assert(added == 3 and mapped.size() == 4 and mapped.bytes() > 0);
+    assert(mapped.path(0) == "/comp/15/a.txt");
+    assert(mapped.path(3) == "/comp/15/inner/d.txt");
+}
+
+
+//Testing resultWriter by writing the same line in each format and ensuring
+//the text format is unchanged, JSON strings are escaped (with bad UTF-8 
+//replaced), and binary records hold variable length integers 
+void resultWriterTest() {
+
+    string path = "/comp/15/a.txt";
+    string line = "say \"hi\"\t\xc3\xa9 \xff";
+    string buffer;
+
+    //Assert that the text format is what gerp has always printed 
+    resultWriter text;
+    text.line(buffer, path, 3, 12, 40, line.data(), 2, false);
+    text.line(buffer, path, 3, 13, 46, line.data(), 2, true);
+    text.gap(buffer);
+    text.count(buffer, "cat", 5, 2);
+    text.count(buffer, "dog", 1, 1);
+    text.term(buffer, "Cat", 7, 5, 2, true);
+    text.term(buffer, "CAT", 1, 1, 1, true);
+    assert(buffer == "/comp/15/a.txt:12: sa\n/comp/15/a.txt-13- sa\n--\n"
+                     "cat: 5 lines in 2 files\n"
+                     "dog: 1 line in 1 file\n"
+                     "    Cat: 7 occurrences on 5 lines in 2 files\n"
+                     "    CAT: 1 occurrence on 1 line in 1 file\n");
+
+    //Assert that JSON objects are escaped and have every field 
+    resultWriter json(resultWriter::JSON);
+    buffer.clear();
+    json.line(buffer, path, 3, 12, 40, line.data(), line.length(), false);
+    assert(buffer == "{\"type\":\"match\",\"path\":\"/comp/15/a.txt\","
+                     "\"file\":3,\"line\":12,\"offset\":40,\"text\":"
+                     "\"say \\\"hi\\\"\\t\xc3\xa9 \\ufffd\"}\n");
+    buffer.clear();
+    json.message(buffer, "cat Not Found.\n");
+    json.gap(buffer);
+    assert(buffer == "{\"type\":\"message\",\"text\":\"cat Not Found.\"}\n");
+
+    //Assert that binary records start with their path and use varints 
+    resultWriter binary(resultWriter::BINARY);
+    resultWriter::Format format = resultWriter::TEXT;
+    assert(resultWriter::parseFormat("binary", format) and 
+           format == resultWriter::BINARY);
+    assert(not resultWriter::parseFormat("xml", format));
+    buffer.clear();
+    binary.fileStart(buffer, "a", 3);
+    binary.line(buffer, "a", 3, 300, 5, "hi", 2, true);
+    assert(buffer == string("P\x03\x01" "aC\x03\xac\x02\x05\x02hi", 12));
+}
+
+
+//Testing queryGuard by ensuring a query stops at its result limit, at its 
+//deadline, and when cancelled, and not otherwise 
+void queryGuardTest() {
+
+    //Assert that a query with no limits never stops 
+    queryGuard budget;
+    budget.start(0, 0);
+    assert(queryGuard::running());
+    for (size_t i = 0; i < 4 * queryGuard::CHECK_INTERVAL; i++) {
+        assert(not budget.expired());
+    }
+    assert(not budget.full(1000000) and not budget.late());
+    assert(budget.reason() == queryGuard::NONE);
+    budget.finish();
+    assert(not queryGuard::running());
+
+    //Assert that the result limit stops the query at the limit 
+    budget.start(0, 3);
+    assert(not budget.full(2) and budget.full(3));
+    assert(budget.reason() == queryGuard::RESULT_LIMIT);
+    assert(budget.expired());
+
+    //Assert that the deadline is seen by late at once and by expired 
+    //within CHECK_INTERVAL calls 
+    budget.start(1, 0);
+    usleep(5000);
+    assert(budget.late());
+    size_t calls = 1;
+    while (not budget.expired()) {
+        calls++;
+    }
+    assert(calls <= queryGuard::CHECK_INTERVAL);
+    assert(budget.reason() == queryGuard::TIME_LIMIT);
+
+    //Assert that cancelling stops the query, and a new query forgets it 
+    budget.start(0, 0);
+    queryGuard::cancel();
+    assert(budget.late() and budget.check());
+    assert(budget.reason() == queryGuard::CANCELLED);
+    assert(string(queryGuard::describe(budget.reason())) == "cancelled");
+    budget.start(0, 0);
+    assert(not budget.check());
+    budget.finish();
+}